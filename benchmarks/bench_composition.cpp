@@ -0,0 +1,652 @@
+/// Microbenchmarks of the Composition API
+///
+/// Usage: bench_composition [--min-time seconds] [--json file] [--csv file]
+///
+/// Runs each benchmark for compositions from binary Fe-C up to a 30-element
+/// superalloy and reports the time and the number of heap allocations per
+/// operation. The batch conversion is also run in float, double and long
+/// double (see ScalarCompositionBatch), reporting the largest relative error
+/// with respect to long double. A range query of a catalog of grades (see
+/// CompositionCatalog) is compared with a linear scan of the compositions,
+/// and the blending of charge mixes (see CompositionBlender) with mixes
+/// computed one Composition at a time, and the solver of alloy additions
+/// (see CompositionAdditionSolver). The site fractions of a sublattice model
+/// (see CompositionSublattices) written by a CompositionField are compared
+/// with an external conversion of the mole fractions of each cell.
+/// The results can be written as JSON or CSV to compare releases.
+
+#include "composition.hpp"
+#include "composition_additions.hpp"
+#include "composition_batch.hpp"
+#include "composition_blend.hpp"
+#include "composition_catalog.hpp"
+#include "composition_field.hpp"
+#include "composition_sublattice.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define FOR_FE_C_ELEMENTS(DO)  \
+    DO(Fe, false, false, true) \
+    DO(C, true, true)
+
+MAKE_COMPOSITION_CLASS(CompositionFeC, FOR_FE_C_ELEMENTS)
+
+#define FOR_STEEL_ELEMENTS(DO) \
+    DO(Fe, false, false, true) \
+    DO(C, true, true)          \
+    DO(N, false, true)         \
+    DO(Mn, true)               \
+    DO(Si)                     \
+    DO(Cr)
+
+MAKE_COMPOSITION_CLASS(CompositionSteel, FOR_STEEL_ELEMENTS)
+
+#define FOR_ALLOY_STEEL_ELEMENTS(DO) \
+    DO(Fe, false, false, true)       \
+    DO(C, true, true)                \
+    DO(N, false, true)               \
+    DO(Mn, true)                     \
+    DO(Al)                           \
+    DO(Si)                           \
+    DO(P)                            \
+    DO(S)                            \
+    DO(Ti)                           \
+    DO(Cr)                           \
+    DO(Ni)                           \
+    DO(Nb)                           \
+    DO(Mo)
+
+MAKE_COMPOSITION_CLASS(CompositionAlloySteel, FOR_ALLOY_STEEL_ELEMENTS)
+
+#define FOR_SUPERALLOY_ELEMENTS(DO) \
+    DO(Ni, false, false, true)      \
+    DO(C, true, true)               \
+    DO(B, false, true)              \
+    DO(N, false, true)              \
+    DO(O, false, true)              \
+    DO(H, false, true)              \
+    DO(Co)                          \
+    DO(Cr, true)                    \
+    DO(Mo)                          \
+    DO(W)                           \
+    DO(Ta)                          \
+    DO(Re)                          \
+    DO(Ru)                          \
+    DO(Al, true)                    \
+    DO(Ti)                          \
+    DO(Nb)                          \
+    DO(Hf)                          \
+    DO(Fe)                          \
+    DO(Mn)                          \
+    DO(Si)                          \
+    DO(V)                           \
+    DO(Zr)                          \
+    DO(Y)                           \
+    DO(La)                          \
+    DO(Ce)                          \
+    DO(Cu)                          \
+    DO(Mg)                          \
+    DO(Pt)                          \
+    DO(Pd)                          \
+    DO(Ir)
+
+MAKE_COMPOSITION_CLASS(CompositionSuperalloy, FOR_SUPERALLOY_ELEMENTS)
+
+/// Number of heap allocations since the start of the program
+static std::atomic<unsigned long long> gNumberOfAllocations { 0 };
+
+void* operator new(size_t size)
+{
+    gNumberOfAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size > 0 ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+/// Prevents the compiler from optimizing away a value
+template <typename T>
+static void doNotOptimize(const T& value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+/// Result of a benchmark
+struct Result {
+    std::string Composition; ///< Name of the composition class
+    size_t NumberOfElements; ///< Number of elements of the composition
+    std::string Benchmark; ///< Name of the benchmark
+    unsigned long long Iterations; ///< Number of operations timed
+    double NsPerOp; ///< Time per operation (ns)
+    double AllocationsPerOp; ///< Heap allocations per operation
+    double MaxRelativeError = -1.0; ///< Largest relative error of the results (negative if not measured)
+};
+
+/// Options of the command line
+struct Options {
+    double MinTime = 0.1; ///< Minimum time of each benchmark (s)
+    const char* JsonFile = nullptr; ///< JSON output file (optional)
+    const char* CsvFile = nullptr; ///< CSV output file (optional)
+};
+
+/** @brief Times an operation
+ *
+ * The number of iterations is doubled until the run takes at least the
+ * minimum time.
+ *
+ * @param op The operation, called with the iteration index
+ * @param itemsPerOp Number of items (e.g., rows of a batch) processed by each
+ * operation. The results are per item
+ * @param maxRelativeError Largest relative error of the results, reported
+ * with them (negative if not measured)
+ */
+template <typename Op>
+static Result run(const Options& options, const char* composition, size_t numberOfElements, const char* benchmark, Op op,
+    size_t itemsPerOp = 1, double maxRelativeError = -1.0)
+{
+    typedef std::chrono::steady_clock Clock;
+    for (unsigned long long n = 1;; n *= 2) {
+        unsigned long long allocations = gNumberOfAllocations.load(std::memory_order_relaxed);
+        Clock::time_point start = Clock::now();
+        for (unsigned long long i = 0; i < n; i++) {
+            op(i);
+        }
+        double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        allocations = gNumberOfAllocations.load(std::memory_order_relaxed) - allocations;
+
+        if (elapsed >= options.MinTime || n >= (1ull << 40)) {
+            double items = double(n) * itemsPerOp;
+            Result result { composition, numberOfElements, benchmark, n, 1e9 * elapsed / items, double(allocations) / items, maxRelativeError };
+            printf("%-24s %3zu  %-38s %12.2f %10.3f", composition, numberOfElements, benchmark,
+                result.NsPerOp, result.AllocationsPerOp);
+            if (maxRelativeError >= 0.0)
+                printf(" %12.3g", maxRelativeError);
+            printf("\n");
+            return result;
+        }
+    }
+}
+
+/// Sets the mass fractions of all alloying elements of a composition
+static void setAlloyingElements(Composition& comp)
+{
+    size_t i = 0;
+    for (ElementData& el : comp.GetElements()) {
+        if (!el.IsMajor())
+            el.SetW(1e-3 * (1 + i % 5));
+        i++;
+    }
+}
+
+/// Runs all benchmarks of a composition class
+template <typename T>
+static void runSuite(const Options& options, const char* name, std::vector<Result>& results)
+{
+    T comp;
+    setAlloyingElements(comp);
+    comp.UpdateFractions();
+
+    std::vector<std::string> symbols;
+    std::vector<ElementData*> alloying;
+    ElementData* pVariable = nullptr;
+    for (ElementData& el : comp.GetElements()) {
+        symbols.push_back(el.GetSymbol());
+        if (el.IsMajor())
+            continue;
+        alloying.push_back(&el);
+        if (el.IsVariable() && pVariable == nullptr)
+            pVariable = &el;
+    }
+    size_t n = comp.GetNumberOfElements();
+    size_t nAlloying = alloying.size();
+    auto add = [&](const char* benchmark, auto op) { results.push_back(run(options, name, n, benchmark, op)); };
+
+    add("SetX", [&](unsigned long long i) {
+        alloying[i % nAlloying]->SetX(1e-3 * (1 + i % 7));
+    });
+    add("SetW", [&](unsigned long long i) {
+        alloying[i % nAlloying]->SetW(1e-3 * (1 + i % 7));
+    });
+    setAlloyingElements(comp);
+
+    add("UpdateFractions (unlocked)", [&](unsigned long long) {
+        comp.UpdateFractions();
+        doNotOptimize(comp);
+    });
+    add("SetX+UpdateFractions (unlocked)", [&](unsigned long long i) {
+        alloying[i % nAlloying]->SetX(1e-3 * (1 + i % 7));
+        comp.UpdateFractions();
+        doNotOptimize(comp);
+    });
+    setAlloyingElements(comp);
+
+    add("LockComposition+UnlockComposition", [&](unsigned long long) {
+        comp.LockComposition();
+        comp.UnlockComposition();
+        doNotOptimize(comp);
+    });
+
+    comp.LockComposition();
+    add("UpdateFractions (locked)", [&](unsigned long long) {
+        comp.UpdateFractions();
+        doNotOptimize(comp);
+    });
+    add("SetX+UpdateFractions (locked)", [&](unsigned long long i) {
+        pVariable->SetX(1e-3 * (1 + i % 7));
+        comp.UpdateFractions();
+        doNotOptimize(comp);
+    });
+    comp.UnlockComposition();
+    comp.UpdateFractions();
+
+    add("Copy", [&](unsigned long long) {
+        T copy = comp;
+        doNotOptimize(copy);
+    });
+    add("Copy+Move", [&](unsigned long long) {
+        T copy = comp;
+        T moved = std::move(copy);
+        doNotOptimize(moved);
+    });
+    add("operator[]", [&](unsigned long long i) {
+        const ElementData& el = comp[symbols[i % n]];
+        doNotOptimize(el);
+    });
+    add("GetElements() iteration", [&](unsigned long long) {
+        double xSum = 0.0;
+        for (const ElementData& el : comp.GetElements()) {
+            xSum += el.GetX();
+        }
+        doNotOptimize(xSum);
+    });
+
+#ifdef _WIN32
+    FILE* stream = fopen("NUL", "w");
+#else
+    FILE* stream = fopen("/dev/null", "w");
+#endif
+    if (stream != nullptr) {
+        add("Print", [&](unsigned long long) {
+            comp.Print(stream);
+        });
+        fclose(stream);
+    }
+}
+
+/// Number of rows of the batches of runScalarSuite
+static const size_t BATCH_SIZE = 4096;
+
+/// Fills a batch with the same float inputs for all scalar types: mole
+/// fractions of the odd elements and mass fractions of the even ones
+template <typename Scalar>
+static void setBatch(ScalarCompositionBatch<Scalar>& batch)
+{
+    std::vector<Scalar> values(batch.Size());
+    for (size_t e = 1; e < batch.NumberOfElements(); e++) {
+        for (size_t r = 0; r < batch.Size(); r++) {
+            values[r] = static_cast<float>(1e-3 * (1 + (r + e) % 7));
+        }
+        if (e % 2)
+            batch.TrySetX(e, values.data());
+        else
+            batch.TrySetW(e, values.data());
+    }
+}
+
+/// Largest relative error of the fractions of a batch with respect to a reference batch
+template <typename Scalar>
+static double maxRelativeError(const ScalarCompositionBatch<Scalar>& batch, const ScalarCompositionBatch<long double>& reference)
+{
+    long double maxError = 0;
+    auto update = [&maxError](Scalar value, long double exact) {
+        if (exact != 0)
+            maxError = std::max(maxError, std::fabs((value - exact) / exact));
+    };
+    for (size_t r = 0; r < batch.Size(); r++) {
+        update(batch.GetMolarMassAvg(r), reference.GetMolarMassAvg(r));
+        for (size_t e = 0; e < batch.NumberOfElements(); e++) {
+            update(batch.GetX(e, r), reference.GetX(e, r));
+            update(batch.GetW(e, r), reference.GetW(e, r));
+            update(batch.GetU(e, r), reference.GetU(e, r));
+        }
+    }
+    return static_cast<double>(maxError);
+}
+
+/// Runs the batch conversion of a composition class in one scalar type. The
+/// time is per composition (row)
+template <typename Scalar>
+static void runScalarBatch(const Options& options, const char* name, const char* benchmark, const Composition& prototype,
+    const ScalarCompositionBatch<long double>& reference, std::vector<Result>& results)
+{
+    ScalarCompositionBatch<Scalar> batch(prototype, BATCH_SIZE);
+    setBatch(batch);
+    batch.UpdateFractions();
+    double maxError = maxRelativeError(batch, reference);
+
+    // Blocks of rows that fit in cache, as CompositionField tiles
+    const size_t blockSize = 256;
+    results.push_back(run(options, name, batch.NumberOfElements(), benchmark, [&](unsigned long long i) {
+        size_t row = (i * blockSize) % BATCH_SIZE;
+        batch.UpdateFractions(row, row + blockSize);
+        doNotOptimize(batch);
+    }, blockSize, maxError));
+}
+
+/// Runs the batch conversion of a composition class in float, double and
+/// long double, on the same inputs
+template <typename T>
+static void runScalarSuite(const Options& options, const char* name, std::vector<Result>& results)
+{
+    T prototype;
+    ScalarCompositionBatch<long double> reference(prototype, BATCH_SIZE);
+    setBatch(reference);
+    reference.UpdateFractions();
+
+    runScalarBatch<float>(options, name, "Batch UpdateFractions (float)", prototype, reference, results);
+    runScalarBatch<double>(options, name, "Batch UpdateFractions (double)", prototype, reference, results);
+    runScalarBatch<long double>(options, name, "Batch UpdateFractions (long double)", prototype, reference, results);
+}
+
+/// Number of grades of the catalog of runCatalogSuite
+static const size_t CATALOG_SIZE = 50000;
+
+/// Sets the fractions of grade i of the catalog of runCatalogSuite
+static void setGrade(CompositionSteel& comp, size_t i)
+{
+    comp.C.SetW(1e-4 * (1 + i % 60));
+    comp.N.SetX(1e-5 * (1 + (i * 7) % 300));
+    comp.Mn.SetW(1e-3 * (1 + (i * 13) % 250));
+    comp.Si.SetX(1e-3 * (1 + (i * 3) % 20));
+    comp.Cr.SetW(1e-3 * (i % 180));
+}
+
+/// Runs a range query (C 0.1-0.3 wt%, Mn < 2 at%, N site fraction < 1e-3)
+/// of a catalog of grades, and the same query as a linear scan that converts
+/// each grade
+static void runCatalogSuite(const Options& options, std::vector<Result>& results)
+{
+    CompositionSteel comp;
+    CompositionCatalog catalog(comp);
+    for (size_t i = 0; i < CATALOG_SIZE; i++) {
+        setGrade(comp, i);
+        catalog.Add(comp);
+    }
+    catalog.Build();
+
+    std::vector<CompositionCatalog::Range> ranges = {
+        { catalog.GetElementIndex("C"), FieldFraction::W, 1e-3, 3e-3 },
+        { catalog.GetElementIndex("Mn"), FieldFraction::X, 0.0, std::nextafter(2e-2, 0.0) },
+        { catalog.GetElementIndex("N"), FieldFraction::U, 0.0, std::nextafter(1e-3, 0.0) }
+    };
+    results.push_back(run(options, "CompositionSteel", comp.GetNumberOfElements(), "Catalog Find (50000 grades)", [&](unsigned long long) {
+        doNotOptimize(catalog.Find(ranges));
+    }));
+    results.push_back(run(options, "CompositionSteel", comp.GetNumberOfElements(), "Linear scan (50000 grades)", [&](unsigned long long) {
+        std::vector<size_t> found;
+        for (size_t i = 0; i < CATALOG_SIZE; i++) {
+            setGrade(comp, i);
+            comp.UpdateFractions();
+            if (comp.C.GetW() >= 1e-3 && comp.C.GetW() <= 3e-3 && comp.Mn.GetX() < 2e-2 && comp.N.GetU() < 1e-3)
+                found.push_back(i);
+        }
+        doNotOptimize(found);
+    }));
+}
+
+/// Number of sources and mixes of runBlendSuite
+static const size_t BLEND_SOURCES = 200;
+static const size_t BLEND_MIXES = 4096;
+
+/// Blends mixes of 8 out of 200 sources with CompositionBlender, and one
+/// Composition at a time. The time is per mix
+static void runBlendSuite(const Options& options, std::vector<Result>& results)
+{
+    std::vector<CompositionAlloySteel> sources(BLEND_SOURCES);
+    CompositionBatch sourceBatch(sources[0], BLEND_SOURCES);
+    for (size_t s = 0; s < BLEND_SOURCES; s++) {
+        size_t i = 0;
+        for (ElementData& el : sources[s].GetElements()) {
+            if (!el.IsMajor())
+                el.SetW(1e-3 * (1 + (s + i) % 9));
+            i++;
+        }
+        sources[s].UpdateFractions();
+        sourceBatch.Load(s, sources[s]);
+    }
+    std::vector<double> masses(BLEND_MIXES * BLEND_SOURCES, 0.0);
+    for (size_t m = 0; m < BLEND_MIXES; m++) {
+        for (size_t k = 0; k < 8; k++) {
+            masses[m * BLEND_SOURCES + (m * 7 + k * 23) % BLEND_SOURCES] += 1.0 + k;
+        }
+    }
+
+    CompositionBlender blender(sourceBatch);
+    CompositionBatch mixes(sources[0]);
+    size_t nElements = sources[0].GetNumberOfElements();
+    results.push_back(run(options, "CompositionAlloySteel", nElements, "Blend (8 of 200 sources)", [&](unsigned long long) {
+        blender.Blend(masses.data(), BLEND_MIXES, mixes);
+        doNotOptimize(mixes);
+    }, BLEND_MIXES));
+
+    CompositionAlloySteel mix;
+    results.push_back(run(options, "CompositionAlloySteel", nElements, "Composition blend (8 of 200 sources)", [&](unsigned long long i) {
+        const double* row = masses.data() + (i % BLEND_MIXES) * BLEND_SOURCES;
+        for (ElementData& el : mix.GetElements()) {
+            if (el.IsMajor())
+                continue;
+            double sum = 0.0, total = 0.0;
+            for (size_t s = 0; s < BLEND_SOURCES; s++) {
+                if (row[s] == 0.0)
+                    continue;
+                sum += row[s] * sources[s][el.GetSymbol()].GetW();
+                total += row[s];
+            }
+            el.SetW(sum / total);
+        }
+        mix.UpdateFractions();
+        doNotOptimize(mix);
+    }));
+}
+
+/// Solves the additions of FeMn, FeSi, carburizer and FeCr to heats of an
+/// alloy steel, with target ranges of 6 elements. The time is per heat
+static void runAdditionSuite(const Options& options, std::vector<Result>& results)
+{
+    CompositionAlloySteel prototype;
+    CompositionBatch additions(prototype, 4);
+    const char* additionElements[][2] = { { "Mn", "C" }, { "Si", nullptr }, { "C", nullptr }, { "Cr", "C" } };
+    const double additionW[][2] = { { 0.75, 0.07 }, { 0.75, 0 }, { 0.9, 0 }, { 0.6, 0.05 } };
+    for (size_t k = 0; k < 4; k++) {
+        CompositionAlloySteel comp;
+        for (size_t i = 0; i < 2 && additionElements[k][i] != nullptr; i++) {
+            comp[additionElements[k][i]].SetW(additionW[k][i]);
+        }
+        comp.UpdateFractions();
+        additions.Load(k, comp);
+    }
+
+    const size_t nHeats = 1024;
+    CompositionBatch heats(prototype, nHeats);
+    for (size_t h = 0; h < nHeats; h++) {
+        CompositionAlloySteel comp;
+        comp.C.SetW(4e-4 * (1 + h % 4));
+        comp.Mn.SetW(1e-3 * (1 + h % 7));
+        comp.Si.SetW(5e-4 * (h % 5));
+        comp.Cr.SetW(1e-3 * (h % 11));
+        comp.Ni.SetW(1e-3);
+        comp.UpdateFractions();
+        heats.Load(h, comp);
+    }
+
+    CompositionAdditionSolver solver(additions);
+    solver.SetTargets({ { heats.GetElementIndex("C"), 2e-3, 3e-3 }, { heats.GetElementIndex("Mn"), 1.0e-2, 1.4e-2 },
+        { heats.GetElementIndex("Si"), 2e-3, 4e-3 }, { heats.GetElementIndex("Cr"), 5e-3, 1.5e-2 },
+        { heats.GetElementIndex("N"), 0.0, 2e-4 }, { heats.GetElementIndex("Ni"), 0.0, 2e-3 } });
+    std::vector<double> heatMasses(nHeats, 1e5), masses(nHeats * 4);
+    CompositionBatch mixes(prototype);
+    results.push_back(run(options, "CompositionAlloySteel", prototype.GetNumberOfElements(), "Solve additions (4 additions)", [&](unsigned long long) {
+        solver.Solve(heats, heatMasses.data(), masses.data(), nullptr, mixes);
+        doNotOptimize(mixes);
+    }, nHeats));
+}
+
+/// Writes the site fractions of (Fe,Mn,Al,Si,P,S,Ti,Cr,Ni,Nb,Mo)_1(C,N,Va)_3
+/// from a field of C mole fractions, with a sublattice model, and with the
+/// mole fractions converted cell by cell. The time is per cell
+static void runSublatticeSuite(const Options& options, std::vector<Result>& results)
+{
+    CompositionAlloySteel prototype;
+    prototype.Mn.SetW(1.5e-2);
+    prototype.Cr.SetW(1e-2);
+    prototype.Ni.SetW(5e-3);
+    prototype.UpdateFractions();
+    prototype.LockComposition();
+    CompositionSublattices ferrite = CompositionSublattices::TwoSublattices(prototype, 1.0, 3.0);
+
+    const size_t nCells = 1 << 16;
+    size_t nElements = prototype.GetNumberOfElements();
+    std::vector<double> xC(nCells), x(nElements * nCells), y(nElements * nCells), va(nCells);
+    for (size_t i = 0; i < nCells; i++) {
+        xC[i] = 1e-3 * (1 + i % 13);
+    }
+
+    CompositionField field(prototype);
+    size_t iC = field.GetElementIndex("C");
+    field.SetInput(iC, FieldFraction::X, xC.data());
+    field.SetSublattices(&ferrite);
+    for (size_t e = 0; e < nElements; e++) {
+        field.SetOutput(e, FieldFraction::U, y.data() + e * nCells);
+    }
+    field.SetVacancyOutput(1, va.data());
+    results.push_back(run(options, "CompositionAlloySteel", nElements, "Field site fractions (1:3 model)", [&](unsigned long long) {
+        field.Convert(0, nCells);
+        doNotOptimize(y);
+    }, nCells));
+
+    CompositionField moleFractions(prototype);
+    moleFractions.SetInput(iC, FieldFraction::X, xC.data());
+    for (size_t e = 0; e < nElements; e++) {
+        moleFractions.SetOutput(e, FieldFraction::X, x.data() + e * nCells);
+    }
+    results.push_back(run(options, "CompositionAlloySteel", nElements, "External site fractions (1:3 model)", [&](unsigned long long) {
+        moleFractions.Convert(0, nCells);
+        for (size_t i = 0; i < nCells; i++) {
+            double xSubstitutional = 0.0, yInterstitial = 0.0;
+            for (size_t e = 0; e < nElements; e++) {
+                if (ferrite.GetSublattice(e) == 0)
+                    xSubstitutional += x[e * nCells + i];
+            }
+            for (size_t e = 0; e < nElements; e++) {
+                double sites = ferrite.GetSites(ferrite.GetSublattice(e));
+                y[e * nCells + i] = x[e * nCells + i] / (sites * xSubstitutional);
+                if (ferrite.GetSublattice(e) == 1)
+                    yInterstitial += y[e * nCells + i];
+            }
+            va[i] = 1.0 - yInterstitial;
+        }
+        doNotOptimize(y);
+    }, nCells));
+}
+
+/// Writes the results as JSON
+static bool writeJson(const char* filename, const std::vector<Result>& results)
+{
+    FILE* file = fopen(filename, "w");
+    if (file == nullptr)
+        return false;
+
+    fprintf(file, "{\n  \"compiler\": \"%s\",\n  \"results\": [\n",
+#if defined(__VERSION__)
+        __VERSION__
+#else
+        "unknown"
+#endif
+    );
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        fprintf(file, "    { \"composition\": \"%s\", \"elements\": %zu, \"benchmark\": \"%s\", "
+                      "\"iterations\": %llu, \"ns_per_op\": %.4f, \"allocations_per_op\": %.4f",
+            r.Composition.c_str(), r.NumberOfElements, r.Benchmark.c_str(), r.Iterations,
+            r.NsPerOp, r.AllocationsPerOp);
+        if (r.MaxRelativeError >= 0.0)
+            fprintf(file, ", \"max_relative_error\": %.4g", r.MaxRelativeError);
+        fprintf(file, " }%s\n", i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    return fclose(file) == 0;
+}
+
+/// Writes the results as CSV
+static bool writeCsv(const char* filename, const std::vector<Result>& results)
+{
+    FILE* file = fopen(filename, "w");
+    if (file == nullptr)
+        return false;
+
+    fprintf(file, "composition,elements,benchmark,iterations,ns_per_op,allocations_per_op,max_relative_error\n");
+    for (const Result& r : results) {
+        fprintf(file, "%s,%zu,%s,%llu,%.4f,%.4f,", r.Composition.c_str(), r.NumberOfElements,
+            r.Benchmark.c_str(), r.Iterations, r.NsPerOp, r.AllocationsPerOp);
+        if (r.MaxRelativeError >= 0.0)
+            fprintf(file, "%.4g", r.MaxRelativeError);
+        fprintf(file, "\n");
+    }
+    return fclose(file) == 0;
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "--min-time") == 0) {
+            options.MinTime = atof(argv[++i]);
+        } else if (i + 1 < argc && strcmp(argv[i], "--json") == 0) {
+            options.JsonFile = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--csv") == 0) {
+            options.CsvFile = argv[++i];
+        } else {
+            fprintf(stderr, "Usage: %s [--min-time seconds] [--json file] [--csv file]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    printf("%-24s %3s  %-38s %12s %10s %12s\n", "Composition", "N", "Benchmark", "ns/op", "allocs/op", "rel. error");
+    std::vector<Result> results;
+    runSuite<CompositionFeC>(options, "CompositionFeC", results);
+    runSuite<CompositionSteel>(options, "CompositionSteel", results);
+    runSuite<CompositionAlloySteel>(options, "CompositionAlloySteel", results);
+    runSuite<CompositionSuperalloy>(options, "CompositionSuperalloy", results);
+    runScalarSuite<CompositionSteel>(options, "CompositionSteel", results);
+    runScalarSuite<CompositionSuperalloy>(options, "CompositionSuperalloy", results);
+    runCatalogSuite(options, results);
+    runBlendSuite(options, results);
+    runAdditionSuite(options, results);
+    runSublatticeSuite(options, results);
+
+    if (options.JsonFile != nullptr && !writeJson(options.JsonFile, results)) {
+        fprintf(stderr, "Error! Could not write %s\n", options.JsonFile);
+        return 1;
+    }
+    if (options.CsvFile != nullptr && !writeCsv(options.CsvFile, results)) {
+        fprintf(stderr, "Error! Could not write %s\n", options.CsvFile);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,463 @@
+/// Command-line tool converting delimited (CSV/TSV) files of compositions.
+///
+/// Each line of the input is a composition. The header names the columns:
+/// element columns are named after the element symbol, optionally followed by
+/// the unit, e.g., `C[wt%]` or `Mn[at%]` (the default unit is set with -u).
+/// The major element is the balance and its column, if present, is ignored.
+/// The other columns (e.g., sample ids) are copied to the output unchanged.
+/// Quoted fields are not supported.
+///
+/// For each line, the output has the copied columns followed by the mole
+/// fractions X(el), the weight fractions W(el) and the site fractions U(el)
+/// of all elements, and the average molar mass.
+///
+/// The input is streamed in chunks, which are converted in parallel and
+/// written in the input order.
+
+#include "dynamic_composition.hpp"
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/// Command line options
+struct Options {
+    const char* Input = "-"; ///< Input file ("-" for stdin)
+    const char* Output = "-"; ///< Output file ("-" for stdout)
+    char Delimiter = 0; ///< Field delimiter (0: guessed from the input file name)
+    bool IsAtomicDefault = false; ///< Unit of the element columns without unit (at% if true, wt% otherwise)
+    std::string Major = "Fe"; ///< Symbol of the major element
+    std::string Interstitials = "C,N,B,O,H"; ///< Symbols of the interstitial elements
+    unsigned int Threads = 0; ///< Number of worker threads (0: number of cores)
+    size_t ChunkSize = 4 << 20; ///< Size of the chunks of the input, in bytes
+};
+
+/// Maximum size of the chunks of the input, in MiB
+static const size_t MAX_CHUNK_SIZE_MIB = 1024;
+
+/// Column of the input
+struct Column {
+    static constexpr size_t PassThrough = static_cast<size_t>(-1); ///< Column copied to the output
+
+    size_t Element = PassThrough; ///< Index of the element in the composition
+    bool IsAtomic = false; ///< If the values are in at% (wt% otherwise)
+};
+
+/// Definition of the input and output columns, parsed from the header
+struct Table {
+    std::vector<Column> Columns; ///< Input columns
+    std::vector<ElementDefinition> Elements; ///< Elements of the composition
+    size_t NumberOfPassThrough = 0; ///< Number of columns copied to the output
+    std::string Header; ///< Header of the output
+};
+
+/// Chunk of the input, made of whole lines
+struct Chunk {
+    std::string Input; ///< Input lines
+    size_t FirstLine = 0; ///< Line number of the first line in the input file
+    std::string Output; ///< Converted lines
+    bool IsDone = false; ///< If the chunk has been converted
+};
+
+static void printUsage(const char* program)
+{
+    fprintf(stderr,
+        "Usage: %s [options] [input] [output]\n"
+        "Converts delimited files of compositions into X, W and U fractions.\n"
+        "Input and output default to stdin and stdout (\"-\").\n\n"
+        "Options:\n"
+        "  -d <char>      Field delimiter (default: tab for *.tsv, comma otherwise)\n"
+        "  -u <wt|at>     Unit of the element columns without unit (default: wt)\n"
+        "  -m <symbol>    Major element (default: Fe)\n"
+        "  -i <symbols>   Comma separated interstitial elements (default: C,N,B,O,H)\n"
+        "  -j <threads>   Number of worker threads (default: number of cores)\n"
+        "  -c <MiB>       Size of the input chunks, 1 to 1024 (default: 4)\n"
+        "  -h             Shows this message\n",
+        program);
+}
+
+/// Parses the command line. Returns false if it is invalid
+static bool parseOptions(int argc, char** argv, Options& options)
+{
+    std::vector<const char*> positional;
+    for (int i = 1; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (arg.size() == 2 && arg[0] == '-' && std::strchr("dumijc", arg[1]) != nullptr) {
+            if (++i >= argc)
+                return false;
+            std::string_view value = argv[i];
+            switch (arg[1]) {
+            case 'd':
+                options.Delimiter = value == "\\t" ? '\t' : value[0];
+                break;
+            case 'u':
+                if (value != "wt" && value != "at")
+                    return false;
+                options.IsAtomicDefault = value == "at";
+                break;
+            case 'm':
+                options.Major = value;
+                break;
+            case 'i':
+                options.Interstitials = value;
+                break;
+            case 'j':
+                options.Threads = std::atoi(argv[i]);
+                break;
+            case 'c': {
+                size_t mib = 0;
+                auto result = std::from_chars(value.data(), value.data() + value.size(), mib);
+                if (result.ec != std::errc() || result.ptr != value.data() + value.size()
+                    || mib < 1 || mib > MAX_CHUNK_SIZE_MIB)
+                    return false;
+                options.ChunkSize = mib << 20;
+                break;
+            }
+            }
+        } else if (arg == "-h" || (arg.size() > 1 && arg[0] == '-')) {
+            return false;
+        } else {
+            positional.push_back(argv[i]);
+        }
+    }
+
+    if (positional.size() > 2)
+        return false;
+    if (positional.size() > 0)
+        options.Input = positional[0];
+    if (positional.size() > 1)
+        options.Output = positional[1];
+
+    if (options.Delimiter == 0) {
+        std::string_view input = options.Input;
+        bool isTsv = input.size() >= 4 && input.substr(input.size() - 4) == ".tsv";
+        options.Delimiter = isTsv ? '\t' : ',';
+    }
+    if (options.Threads == 0)
+        options.Threads = std::max(1u, std::thread::hardware_concurrency());
+    return true;
+}
+
+/// Removes surrounding spaces and carriage returns
+static std::string_view trim(std::string_view s)
+{
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\r'))
+        s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\r'))
+        s.remove_suffix(1);
+    return s;
+}
+
+/// Calls f(index, field) for each field of a line
+template <typename F>
+static void forEachField(std::string_view line, char delimiter, F&& f)
+{
+    size_t index = 0;
+    while (true) {
+        size_t end = line.find(delimiter);
+        f(index++, trim(line.substr(0, end)));
+        if (end == std::string_view::npos)
+            break;
+        line.remove_prefix(end + 1);
+    }
+}
+
+/// Whether a symbol is in a comma separated list of symbols
+static bool isInList(std::string_view symbol, std::string_view list)
+{
+    bool found = false;
+    forEachField(list, ',', [&](size_t, std::string_view s) {
+        found = found || PeriodicTable::SymbolKey(s) == PeriodicTable::SymbolKey(symbol);
+    });
+    return found;
+}
+
+/// Parses the header. Returns false if it is invalid
+static bool parseHeader(std::string_view header, const Options& options, Table& table)
+{
+    const PeriodicTable::Element* pMajor = PeriodicTable::FindBySymbol(options.Major);
+    if (pMajor == nullptr) {
+        fprintf(stderr, "Error! Unknown major element %s\n", options.Major.c_str());
+        return false;
+    }
+    table.Elements.push_back({ std::string(pMajor->Symbol), false, false, true });
+
+    std::string passThrough;
+    bool isValid = true;
+    forEachField(header, options.Delimiter, [&](size_t, std::string_view name) {
+        Column column;
+        column.IsAtomic = options.IsAtomicDefault;
+
+        std::string_view symbol = name;
+        size_t bracket = name.find('[');
+        if (bracket != std::string_view::npos) {
+            std::string_view unit = name.substr(bracket);
+            symbol = trim(name.substr(0, bracket));
+            column.IsAtomic = unit == "[at%]";
+            if (!column.IsAtomic && unit != "[wt%]") {
+                fprintf(stderr, "Error! Unknown unit in column %.*s\n", static_cast<int>(name.size()), name.data());
+                isValid = false;
+            }
+        }
+
+        // Element columns are named after the exact (case sensitive) symbol
+        const PeriodicTable::Element* pElement = PeriodicTable::FindBySymbol(symbol);
+        if (pElement != nullptr && pElement->Symbol == symbol) {
+            auto it = std::find_if(table.Elements.begin(), table.Elements.end(),
+                [&](const ElementDefinition& def) { return def.Symbol == symbol; });
+            if (it != table.Elements.begin() && it != table.Elements.end()) {
+                fprintf(stderr, "Error! Element %.*s defined in more than one column\n", static_cast<int>(symbol.size()), symbol.data());
+                isValid = false;
+            }
+            column.Element = it - table.Elements.begin();
+            if (it == table.Elements.end())
+                table.Elements.push_back({ std::string(symbol), true, isInList(symbol, options.Interstitials), false });
+        } else {
+            passThrough.append(name).push_back(options.Delimiter);
+            table.NumberOfPassThrough++;
+        }
+        table.Columns.push_back(column);
+    });
+
+    table.Header = passThrough;
+    for (const char* prefix : { "X(", "W(", "U(" }) {
+        for (const ElementDefinition& def : table.Elements) {
+            table.Header.append(prefix).append(def.Symbol).append(")").push_back(options.Delimiter);
+        }
+    }
+    table.Header.append("MolarMass\n");
+    return isValid;
+}
+
+/// Appends a number to a string in the shortest representation that is read back exactly
+static void appendNumber(std::string& s, double value)
+{
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    s.append(buffer, result.ptr);
+}
+
+/// Converts the lines of a chunk
+static void convertChunk(Chunk& chunk, const Table& table, const DynamicComposition& prototype, char delimiter)
+{
+    DynamicComposition comp = prototype;
+    size_t nElements = comp.GetNumberOfElements();
+    std::vector<double> values(nElements);
+    std::vector<bool> isAtomic(nElements);
+
+    chunk.Output.reserve(chunk.Input.size() * 4);
+    std::string_view input = chunk.Input;
+    size_t lineNumber = chunk.FirstLine;
+    while (!input.empty()) {
+        size_t end = input.find('\n');
+        std::string_view line = input.substr(0, end);
+        input.remove_prefix(end == std::string_view::npos ? input.size() : end + 1);
+        if (trim(line).empty()) {
+            lineNumber++;
+            continue;
+        }
+
+        std::fill(values.begin(), values.end(), 0.0);
+        bool isValid = true;
+        size_t nPassThrough = 0;
+        forEachField(line, delimiter, [&](size_t i, std::string_view field) {
+            if (i >= table.Columns.size()) {
+                return;
+            }
+            const Column& column = table.Columns[i];
+            if (column.Element == Column::PassThrough) {
+                chunk.Output.append(field).push_back(delimiter);
+                nPassThrough++;
+                return;
+            }
+            if (field.empty() || column.Element == prototype.GetMajorElementIndex())
+                return;
+
+            // std::from_chars is locale independent
+            double value = 0.0;
+            auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+            if (result.ec != std::errc() || result.ptr != field.data() + field.size()) {
+                fprintf(stderr, "Line %zu: invalid value '%.*s'\n", lineNumber, static_cast<int>(field.size()), field.data());
+                isValid = false;
+            }
+            values[column.Element] = value / 100.0;
+            isAtomic[column.Element] = column.IsAtomic;
+        });
+        lineNumber++;
+        // Lines with missing fields keep the columns aligned
+        chunk.Output.append(table.NumberOfPassThrough - nPassThrough, delimiter);
+
+        if (!isValid) {
+            chunk.Output.append(3 * nElements, delimiter).push_back('\n');
+            continue;
+        }
+
+        for (size_t e = 0; e < nElements; e++) {
+            if (e == comp.GetMajorElementIndex())
+                continue;
+            if (isAtomic[e])
+                comp.SetX(e, values[e]);
+            else
+                comp.SetW(e, values[e]);
+        }
+        comp.UpdateFractions();
+
+        for (double (DynamicComposition::*get)(size_t) const : { &DynamicComposition::GetX, &DynamicComposition::GetW, &DynamicComposition::GetU }) {
+            for (size_t e = 0; e < nElements; e++) {
+                appendNumber(chunk.Output, (comp.*get)(e));
+                chunk.Output.push_back(delimiter);
+            }
+        }
+        appendNumber(chunk.Output, comp.GetMolarMassAvg());
+        chunk.Output.push_back('\n');
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    FILE* in = std::strcmp(options.Input, "-") == 0 ? stdin : fopen(options.Input, "rb");
+    if (in == nullptr) {
+        fprintf(stderr, "Error! Cannot open %s\n", options.Input);
+        return 1;
+    }
+    FILE* out = std::strcmp(options.Output, "-") == 0 ? stdout : fopen(options.Output, "wb");
+    if (out == nullptr) {
+        fprintf(stderr, "Error! Cannot open %s\n", options.Output);
+        return 1;
+    }
+
+    // Reads the input in chunks of whole lines. Lines longer than a chunk are
+    // read until their end, and the incomplete last line of a chunk is
+    // carried over to the next one
+    std::string carry;
+    size_t lineNumber = 1;
+    auto readChunk = [&](Chunk& chunk) {
+        chunk.Input.swap(carry);
+        size_t lastNewline = std::string::npos;
+        while (lastNewline == std::string::npos && !feof(in) && !ferror(in)) {
+            size_t size = chunk.Input.size();
+            chunk.Input.resize(size + options.ChunkSize);
+            size_t count = fread(&chunk.Input[size], 1, options.ChunkSize, in);
+            chunk.Input.resize(size + count);
+
+            // Only the new bytes are searched: the carried over line has no newline
+            size_t found = std::string_view(chunk.Input).substr(size).rfind('\n');
+            if (found != std::string::npos)
+                lastNewline = size + found;
+        }
+
+        if (!feof(in) && lastNewline != std::string::npos) {
+            carry.assign(chunk.Input, lastNewline + 1, std::string::npos);
+            chunk.Input.resize(lastNewline + 1);
+        } else {
+            carry.clear();
+        }
+        chunk.FirstLine = lineNumber;
+        lineNumber += std::count(chunk.Input.begin(), chunk.Input.end(), '\n');
+        return !chunk.Input.empty();
+    };
+
+    // The header is the first line of the first chunk
+    auto first = std::make_shared<Chunk>();
+    if (!readChunk(*first)) {
+        fprintf(stderr, "Error! Empty input\n");
+        return 1;
+    }
+    size_t headerEnd = std::min(first->Input.find('\n'), first->Input.size());
+    Table table;
+    if (!parseHeader(std::string_view(first->Input).substr(0, headerEnd), options, table)) {
+        return 1;
+    }
+    first->Input.erase(0, headerEnd + 1);
+    first->FirstLine++;
+    fputs(table.Header.c_str(), out);
+
+    DynamicComposition prototype(table.Elements);
+
+    // Chunks are converted by the workers and written in order by the main thread
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<std::shared_ptr<Chunk>> pending; // Chunks waiting for a worker
+    std::deque<std::shared_ptr<Chunk>> ordered; // Chunks waiting to be written, in order
+    bool isClosed = false;
+    const size_t maxChunksInFlight = 2 * options.Threads;
+
+    std::vector<std::thread> workers;
+    for (unsigned int t = 0; t < options.Threads; t++) {
+        workers.emplace_back([&] {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (true) {
+                condition.wait(lock, [&] { return isClosed || !pending.empty(); });
+                if (pending.empty())
+                    return;
+                std::shared_ptr<Chunk> chunk = pending.front();
+                pending.pop_front();
+                lock.unlock();
+                convertChunk(*chunk, table, prototype, options.Delimiter);
+                lock.lock();
+                chunk->IsDone = true;
+                condition.notify_all();
+            }
+        });
+    }
+
+    // Writes the converted chunks at the front. If wait is true, waits until
+    // all chunks are written, otherwise only while too many chunks are in flight
+    auto writeChunks = [&](bool wait) {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!ordered.empty()) {
+            if (!ordered.front()->IsDone) {
+                if (!wait && ordered.size() < maxChunksInFlight)
+                    return;
+                condition.wait(lock, [&] { return ordered.front()->IsDone; });
+            }
+            std::shared_ptr<Chunk> chunk = ordered.front();
+            ordered.pop_front();
+            lock.unlock();
+            fwrite(chunk->Output.data(), 1, chunk->Output.size(), out);
+            lock.lock();
+        }
+    };
+
+    std::shared_ptr<Chunk> chunk = first;
+    do {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.push_back(chunk);
+            ordered.push_back(chunk);
+        }
+        condition.notify_all();
+        writeChunks(false);
+        chunk = std::make_shared<Chunk>();
+    } while (readChunk(*chunk));
+
+    writeChunks(true);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isClosed = true;
+    }
+    condition.notify_all();
+    for (std::thread& worker : workers)
+        worker.join();
+
+    if (in != stdin)
+        fclose(in);
+    if (out != stdout)
+        fclose(out);
+    return 0;
+}
@@ -3,15 +3,23 @@
 #ifndef COMPOSITION_H
 #define COMPOSITION_H
 
+#include "composition_instrumentation.hpp"
+#include "composition_kernels.hpp"
+#include "composition_status.hpp"
 #include "periodic_table.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdio>
 #include <map>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 /// @brief Class with properties of a single element in the alloy (molar mass, fractions, etc)
 class ElementData {
 private:
-    std::string mvSymbol = "undefined"; ///< %Element symbol
+    const char* mvSymbol = "undefined"; ///< %Element symbol
     bool mvIsMajor = false; ///< If it is major element in Composition
     bool mvIsVariable = true; ///< If composition of element is allowed to be changed in Composition even when composition is locked
     bool mvIsInterstitial = false; ///< True if it is interstitial element, false if it is substitutional
@@ -25,6 +33,9 @@ private:
     double mvW = 0.0; ///< Calculated mass fraction
     double mvU = 0.0; ///< Calculated site fraction
 
+    CompositionStatus checkSetX() const noexcept;
+    CompositionStatus checkSetW() const noexcept;
+
 public:
     /// Default constructor
     ElementData() { }
@@ -38,12 +49,21 @@ public:
 
     /// Set weight fraction
     void SetW(double w);
+
+    /// Set mole fraction without printing. Returns CompositionStatus::Ok,
+    /// MajorElement, or LockedElement for a fixed element of a locked
+    /// composition
+    CompositionStatus TrySetX(double x) noexcept;
+    /// Set weight fraction without printing. Returns CompositionStatus::Ok,
+    /// MajorElement, LockedElement for a fixed element of a locked
+    /// composition, or LockedMassFraction for a variable one
+    CompositionStatus TrySetW(double w) noexcept;
     /// @}
 
     /// @name Getters
     /// @{
     /// Get element symbol
-    std::string GetSymbol() const { return mvSymbol; }
+    std::string GetSymbol() const { return std::string(mvSymbol); }
     /// Get molar mass of element
     double GetMolarMass() const { return mvMolarMass; }
 
@@ -64,6 +84,47 @@ public:
 
     friend class CompositionBase;
     friend class Composition;
+    friend class CompositionSnapshot;
+    friend class CompositionWriter;
+    friend class CompositionFileView;
+    template <typename Scalar>
+    friend class ScalarCompositionBatch;
+    template <typename GetElement>
+    friend struct ElementDataAccessor;
+};
+
+/** @brief Accessor to the members of the ElementData of a composition used by
+ * the templates in CompositionKernels
+ *
+ * Elements are identified by their index in the layout, GetElement being a
+ * function object that maps the index to the respective ElementData. The
+ * members are const references if it maps to const ElementData.
+ */
+template <typename GetElement>
+struct ElementDataAccessor {
+    GetElement Element; ///< Maps the index of an element to its ElementData
+
+    double MolarMass(size_t i) const { return Element(i).mvMolarMass; }
+    decltype(auto) UserX(size_t i) const { return (Element(i).mvUserX); }
+    decltype(auto) UserW(size_t i) const { return (Element(i).mvUserW); }
+    decltype(auto) X(size_t i) const { return (Element(i).mvX); }
+    decltype(auto) W(size_t i) const { return (Element(i).mvW); }
+    decltype(auto) U(size_t i) const { return (Element(i).mvU); }
+    decltype(auto) IsUpdated(size_t i) const { return (Element(i).mvIsUpdated); }
+};
+
+/// Deduces the template argument of ElementDataAccessor from the function object
+template <typename GetElement>
+ElementDataAccessor(GetElement) -> ElementDataAccessor<GetElement>;
+
+/// ElementDataAccessor of a composition class whose molar masses are known at
+/// compile time. Reading them from a constexpr table lets the compiler fold
+/// them into constants
+template <typename GetElement, size_t N>
+struct StaticElementDataAccessor : ElementDataAccessor<GetElement> {
+    const std::array<double, N>& MolarMasses; ///< Molar masses of the elements
+
+    double MolarMass(size_t i) const { return MolarMasses[i]; }
 };
 
 /// const ElementData
@@ -77,14 +138,29 @@ typedef const ElementData* ConstElementPointer;
 /// Vector of const pointers to defined elements
 typedef std::vector<ConstElementPointer> VectorConstElementPointers;
 
-/// Iterable container of elements. It can be used with the range-based for syntax
+class CompositionBase;
+
+/// Pointer to an ElementData member of a composition class, as a member of CompositionBase
+typedef ElementData CompositionBase::*ElementMember;
+
+/** @brief Iterable container of elements. It can be used with the range-based for syntax
+ *
+ * Iterates through the static table of member pointers of a composition
+ * class (see MAKE_DEFINITIONS), so it neither allocates memory nor makes
+ * virtual calls.
+ */
 template <typename T>
 class PointersContainer {
 private:
-    std::vector<T*> mvElements; ///< Elements
+    /// CompositionBase with the same constness as T
+    typedef typename std::conditional<std::is_const<T>::value, const CompositionBase, CompositionBase>::type Base;
+
+    Base* mvpComposition; ///< The composition
+    const ElementMember* mvpBegin; ///< First member pointer
+    const ElementMember* mvpEnd; ///< One past the last member pointer
 
 public:
-    /// Iterator for a container of pointers
+    /// Iterator for a container of member pointers
     class PointersIterator {
     public:
         using iterator_category = std::forward_iterator_tag;
@@ -93,16 +169,17 @@ public:
         using pointer = T*;
         using reference = T&;
 
-        PointersIterator(pointer* ptrPtr)
-            : mvpPtrPtr(ptrPtr)
+        PointersIterator(Base* comp, const ElementMember* pMember)
+            : mvpComposition(comp)
+            , mvpMember(pMember)
         {
         }
 
-        reference operator*() const { return **mvpPtrPtr; }
-        pointer operator->() { return *mvpPtrPtr; }
+        reference operator*() const { return mvpComposition->*(*mvpMember); }
+        pointer operator->() { return &(mvpComposition->*(*mvpMember)); }
         PointersIterator& operator++()
         {
-            ++mvpPtrPtr;
+            ++mvpMember;
             return *this;
         }
         PointersIterator operator++(int)
@@ -111,120 +188,420 @@ public:
             ++(*this);
             return tmp;
         }
-        friend bool operator==(const PointersIterator& a, const PointersIterator& b) { return a.mvpPtrPtr == b.mvpPtrPtr; };
-        friend bool operator!=(const PointersIterator& a, const PointersIterator& b) { return a.mvpPtrPtr != b.mvpPtrPtr; };
+        friend bool operator==(const PointersIterator& a, const PointersIterator& b) { return a.mvpMember == b.mvpMember; };
+        friend bool operator!=(const PointersIterator& a, const PointersIterator& b) { return a.mvpMember != b.mvpMember; };
 
     private:
-        pointer* mvpPtrPtr; ///< Pointer to element of the container (which is also a pointer!)
+        Base* mvpComposition; ///< The composition
+        const ElementMember* mvpMember; ///< Pointer to element of the member pointers table
     };
 
     /// Constructor
-    PointersContainer(const std::vector<T*>& elements)
-        : mvElements(elements)
+    PointersContainer(Base* comp, const ElementMember* begin, const ElementMember* end)
+        : mvpComposition(comp)
+        , mvpBegin(begin)
+        , mvpEnd(end)
     {
     }
 
     /// Begin of the container
-    PointersIterator begin() { return &*mvElements.begin(); }
+    PointersIterator begin() const { return PointersIterator(mvpComposition, mvpBegin); }
     /// End of the container
-    PointersIterator end() { return &*mvElements.end(); }
+    PointersIterator end() const { return PointersIterator(mvpComposition, mvpEnd); }
+    /// Number of elements
+    size_t size() const { return mvpEnd - mvpBegin; }
 };
 
-/// Container of pointers to ElementData
+/// Container of ElementData
 typedef PointersContainer<ElementData> ContainerElements;
-/// Container of pointers to const ElementData
+/// Container of const ElementData
 typedef PointersContainer<const ElementData> ContainerConstElements;
 
-/** @brief Base class to Composition with pointers to the the elements
+/** @brief Partition of the elements of a composition
  *
- * The pointers are used here to be able to dynamically loop through
- * all defined elements (ElementData), without having to make use of
- * maps or copies of the elements. The pointers are non-copyable or
- * moveable because they should refer exclusively to the element data
- * instantiated with an instance of the Composition class. Otherwise,
- * we could have pointers to elements from other instances.
+ * The elements are identified by their index, i.e., the order in which they
+ * are defined. The alloying elements are all elements except the major one.
  */
-class CompositionBase {
+struct ElementPartition {
+    size_t Major = 0; ///< Index of the major element (e.g., Fe)
+    std::vector<size_t> Alloying; ///< Indices of all alloying elements
+
+    std::vector<size_t> Interstitial; ///< Indices of interstitial elements
+    std::vector<size_t> FixedInterstitial; ///< Indices of fixed interstitial elements
+    std::vector<size_t> VariableInterstitial; ///< Indices of interstitial elements that can be changed
+
+    std::vector<size_t> Substitutional; ///< Indices of substitutional elements
+    std::vector<size_t> FixedSubstitutional; ///< Indices of fixed substitutional elements
+    std::vector<size_t> VariableSubstitutional; ///< Indices of substitutional elements that can be changed
+
+    std::vector<size_t> Variable; ///< Indices of all elements that can be changed
+    std::vector<size_t> Fixed; ///< Indices of all fixed elements
+};
+
+/** @brief Jacobians of the fractions of a composition with respect to the
+ * fractions of its independent elements (see Composition::GetJacobian)
+ *
+ * The rows are all elements, in order of definition, and the columns are the
+ * independent elements: the alloying elements if the composition is
+ * unlocked, or the variable elements if it is locked. Each derivative is
+ * taken with the fractions of the other independent elements held constant,
+ * i.e., as if they were all set when updating the fractions (a locked update
+ * otherwise keeps the site fractions of the variable elements that were not
+ * set). The matrices are stored in row-major order (see Index). Instances can
+ * be reused, so that memory is only allocated when the sizes change.
+ */
+struct CompositionJacobian {
+    size_t NumberOfElements = 0; ///< Number of rows
+    std::vector<size_t> Columns; ///< Indices of the independent elements, in order of definition
+    std::vector<double> dWdX; ///< dW_j/dX_i
+    std::vector<double> dXdW; ///< dX_j/dW_i, where the mass fractions of the independent elements are given
+    std::vector<double> dUdX; ///< dU_j/dX_i
+    std::vector<double> dMolarMassAvgdX; ///< Derivatives of the average molar mass, one per column
+    std::vector<double> dXSumSubstitutionaldX; ///< Derivatives of the fraction of substitutional elements, one per column
+
+    /// Index of the derivative of element j with respect to column i
+    size_t Index(size_t j, size_t i) const { return j * Columns.size() + i; }
+
+    /// Sets the number of rows and columns. The columns must be set
+    void Resize(size_t numberOfElements)
+    {
+        NumberOfElements = numberOfElements;
+        dWdX.resize(numberOfElements * Columns.size());
+        dXdW.resize(numberOfElements * Columns.size());
+        dUdX.resize(numberOfElements * Columns.size());
+        dMolarMassAvgdX.resize(Columns.size());
+        dXSumSubstitutionaldX.resize(Columns.size());
+    }
+};
+
+/// Flags of an element of a composition class known at compile time. They
+/// follow the constructor of ElementData
+struct ElementFlags {
+    bool IsVariable = false; ///< If composition of element can be changed when the composition is locked
+    bool IsInterstitial = false; ///< True if it is interstitial element, false if it is substitutional
+    bool IsMajor = false; ///< If it is the major element
+};
+
+/** @brief Partition of the elements of a composition class computed at compile time
+ *
+ * Same as ElementPartition, but the lists of indices are constexpr arrays
+ * whose sizes are known at compile time. Used with the templates in
+ * CompositionKernels, the loops over the elements have constant trip counts
+ * and indices, so that the compiler can fully unroll and inline them.
+ *
+ * The flags of the elements are taken from T::elementFlags(), which must be
+ * a constexpr function returning a std::array of ElementFlags, in order of
+ * definition of the elements (see MAKE_DEFINITIONS and CompositionOf).
+ * Sets of elements without exactly one major element are rejected at
+ * compile time.
+ */
+template <typename T>
+struct StaticPartition {
+private:
+    /// Category of an element. The lists of the partition are made by
+    /// concatenating the categories in this order
+    enum Category {
+        VariableInterstitialCategory,
+        FixedInterstitialCategory,
+        VariableSubstitutionalCategory,
+        FixedSubstitutionalCategory,
+        MajorCategory
+    };
+
+    static constexpr auto Flags = T::elementFlags();
+
+    static constexpr Category category(const ElementFlags& flags)
+    {
+        if (flags.IsMajor)
+            return MajorCategory;
+        if (flags.IsInterstitial)
+            return flags.IsVariable ? VariableInterstitialCategory : FixedInterstitialCategory;
+        return flags.IsVariable ? VariableSubstitutionalCategory : FixedSubstitutionalCategory;
+    }
+
+    /// Number of elements in the given categories
+    template <Category... C>
+    static constexpr size_t count()
+    {
+        size_t n = 0;
+        for (Category c : { C... }) {
+            for (const ElementFlags& flags : Flags) {
+                n += category(flags) == c ? 1 : 0;
+            }
+        }
+        return n;
+    }
+
+    /// Indices of the elements in the given categories
+    template <Category... C>
+    static constexpr std::array<size_t, count<C...>()> list()
+    {
+        std::array<size_t, count<C...>()> indices {};
+        size_t n = 0;
+        for (Category c : { C... }) {
+            for (size_t i = 0; i < Flags.size(); i++) {
+                if (category(Flags[i]) == c)
+                    indices[n++] = i;
+            }
+        }
+        return indices;
+    }
+
+    static_assert(count<MajorCategory>() > 0, "No major element defined");
+    static_assert(count<MajorCategory>() < 2, "More than one major elements defined");
+
 public:
-protected:
-    ElementPointer mvpMajorElement = nullptr; ///< Pointer to major element (e.g., Fe)
+    static constexpr size_t NumberOfElements = Flags.size(); ///< Number of elements
+    static constexpr size_t Major = list<MajorCategory>()[0]; ///< Index of the major element
+    /// Indices of all alloying elements
+    static constexpr auto Alloying = list<VariableInterstitialCategory, FixedInterstitialCategory, VariableSubstitutionalCategory, FixedSubstitutionalCategory>();
 
-    VectorElementPointers mvAlloyingElements; ///< Vector of pointers to all alloying elements
+    static constexpr auto Interstitial = list<VariableInterstitialCategory, FixedInterstitialCategory>(); ///< Indices of interstitial elements
+    static constexpr auto FixedInterstitial = list<FixedInterstitialCategory>(); ///< Indices of fixed interstitial elements
+    static constexpr auto VariableInterstitial = list<VariableInterstitialCategory>(); ///< Indices of interstitial elements that can be changed
 
-    VectorElementPointers mvInterstitialElements; ///< Vector of pointers to interstitial elements
-    VectorElementPointers mvFixedInterstitialElements; ///< Vector of pointers to fixed interstitial elements
-    VectorElementPointers mvVariableInterstitialElements; ///< Vector of pointers to interstitial elements that can be changed
+    static constexpr auto Substitutional = list<VariableSubstitutionalCategory, FixedSubstitutionalCategory>(); ///< Indices of substitutional elements
+    static constexpr auto FixedSubstitutional = list<FixedSubstitutionalCategory>(); ///< Indices of fixed substitutional elements
+    static constexpr auto VariableSubstitutional = list<VariableSubstitutionalCategory>(); ///< Indices of substitutional elements that can be changed
 
-    VectorElementPointers mvSubstitutionalElements; ///< Vector of pointers to substitutional elements
-    VectorElementPointers mvFixedSubstitutionalElements; ///< Vector of pointers to fixed substitutional elements
-    VectorElementPointers mvVariableSubstitutionalElements; ///< Vector of pointers to substitutional elements that can be changed
+    static constexpr auto Variable = list<VariableInterstitialCategory, VariableSubstitutionalCategory>(); ///< Indices of all elements that can be changed
+    static constexpr auto Fixed = list<FixedInterstitialCategory, FixedSubstitutionalCategory>(); ///< Indices of all fixed elements
+};
 
-    VectorElementPointers mvVariableElements; ///< Vector of pointers to all elements that can be changed
-    VectorElementPointers mvFixedElements; ///< Vector of pointers to all fixed elements
+/** @brief Perfect hash table of the elements of a composition class
+ *
+ * Maps the symbol keys (see PeriodicTable::SymbolKey) to the indices of the
+ * elements plus one. Zero means that the element is not defined.
+ */
+typedef std::array<unsigned char, PeriodicTable::SymbolKeyCount> ElementSymbolTable;
 
-    bool mvArePointersUpdated = false; ///< If true, element definitions are not updated
+/** @brief Builds the ElementSymbolTable of a list of element symbols at compile time
+ *
+ * @param symbols Symbols of the elements, in order of definition
+ *
+ * @return The table
+ */
+template <size_t N>
+constexpr ElementSymbolTable MakeElementSymbolTable(const char* const (&symbols)[N])
+{
+    static_assert(N < 256, "Too many elements");
+    ElementSymbolTable table {};
+    for (size_t i = 0; i < N; i++) {
+        table[PeriodicTable::SymbolKey(symbols[i])] = static_cast<unsigned char>(i + 1);
+    }
+    return table;
+}
 
-protected:
-    void updatePointers();
-    /// Returns a vector with pointers to all defined elements
-    virtual VectorElementPointers getElementPointers() = 0;
-    /// Returns a vector with const pointers to all defined elements
-    virtual VectorConstElementPointers getElementPointers() const = 0;
+/// Handle to an element of a composition class, resolved once from its
+/// symbol (see CompositionBase::GetElementHandle). It is valid for all
+/// instances of the class
+class ElementHandle {
+private:
+    size_t mvIndex = 0; ///< Index of the element in the layout
 
 public:
     /// Default constructor
-    CompositionBase() { }
+    ElementHandle() = default;
+    /// Constructor
+    explicit ElementHandle(size_t index)
+        : mvIndex(index)
+    {
+    }
+
+    /// Index of the element in the layout
+    size_t GetIndex() const { return mvIndex; }
+};
+
+/** @brief Layout of the elements of a composition class
+ *
+ * Refers to the static table of member pointers to the elements (ElementData)
+ * and stores their partition. Since they are the same for all instances of a
+ * class, a single layout is built per class and shared by all its instances
+ * (see MAKE_DEFINITIONS).
+ */
+struct CompositionLayout {
+    const ElementMember* Members; ///< Member pointers to the elements
+    size_t NumberOfElements; ///< Number of elements
+    ElementPartition Partition; ///< Partition of the elements
+    const ElementSymbolTable* SymbolTable; ///< Perfect hash table of the element symbols
+
+    /** @brief Builds the layout from a partition computed at compile time,
+     * which is always valid
+     *
+     * @param partition The partition (see StaticPartition)
+     * @param members Member pointers to the elements of the class
+     * @param symbolTable Perfect hash table of the element symbols (see MakeElementSymbolTable)
+     */
+    template <typename T, size_t N>
+    CompositionLayout(StaticPartition<T> partition, const std::array<ElementMember, N>& members, const ElementSymbolTable& symbolTable)
+        : Members(members.data())
+        , NumberOfElements(N)
+        , SymbolTable(&symbolTable)
+    {
+        static_assert(StaticPartition<T>::NumberOfElements == N, "Inconsistent number of elements");
+        Partition.Major = partition.Major;
+        Partition.Alloying.assign(partition.Alloying.begin(), partition.Alloying.end());
+        Partition.Interstitial.assign(partition.Interstitial.begin(), partition.Interstitial.end());
+        Partition.FixedInterstitial.assign(partition.FixedInterstitial.begin(), partition.FixedInterstitial.end());
+        Partition.VariableInterstitial.assign(partition.VariableInterstitial.begin(), partition.VariableInterstitial.end());
+        Partition.Substitutional.assign(partition.Substitutional.begin(), partition.Substitutional.end());
+        Partition.FixedSubstitutional.assign(partition.FixedSubstitutional.begin(), partition.FixedSubstitutional.end());
+        Partition.VariableSubstitutional.assign(partition.VariableSubstitutional.begin(), partition.VariableSubstitutional.end());
+        Partition.Variable.assign(partition.Variable.begin(), partition.Variable.end());
+        Partition.Fixed.assign(partition.Fixed.begin(), partition.Fixed.end());
+    }
+};
+
+/** @brief Base class to Composition with the layout of the elements
+ *
+ * The layout (CompositionLayout) is used to dynamically loop through all
+ * defined elements (ElementData), without having to make use of maps or
+ * copies of the elements. The elements are addressed by member pointers
+ * instead of pointers, so the layout remains valid for copies of the
+ * instance. Compositions are trivially copyable: copying or moving them is a
+ * plain copy of their members, without any memory allocation.
+ */
+class CompositionBase {
+protected:
+    const CompositionLayout* mvpLayout = nullptr; ///< Layout of the elements, shared by all instances of the class
+
+    template <typename Scalar>
+    friend class ScalarCompositionBatch;
+    friend struct CompositionLayout;
+
+protected:
+    /// Element with index i in the layout
+    ElementData& element(size_t i) { return this->*mvpLayout->Members[i]; }
+    /// Const element with index i in the layout
+    const ElementData& element(size_t i) const { return this->*mvpLayout->Members[i]; }
+
+    /// Default constructor
+    CompositionBase() = default;
+    /// Copy constructor. The layout is shared by all instances of the same class
+    CompositionBase(const CompositionBase&) = default;
+    /// Copy assignment operator. The layout is shared by all instances of the same class
+    CompositionBase& operator=(const CompositionBase&) = default;
     /// Destructor
-    virtual ~CompositionBase() { }
-    /// Copy constructor. Does nothing! We don't want to copy the pointers to
-    /// the elements. Always call updatePointers after instantiating/copying/moving
-    /// Composition
-    CompositionBase(const CompositionBase&) { }
-    /// Copy assignment operator. Does nothing! We don't want to copy the pointers to
-    /// the elements. Always call updatePointers after instantiating/copying/moving
-    /// Composition
-    CompositionBase& operator=(const CompositionBase&) { return *this; }
-    /// Move constructor. Does nothing! We don't want to copy the pointers to
-    /// the elements. Always call updatePointers after instantiating/copying/moving
-    /// Composition
-    CompositionBase(const CompositionBase&&) { }
-    /// Move assignment operator. Does nothing! We don't want to copy the pointers to
-    /// the elements. Always call updatePointers after instantiating/copying/moving
-    /// Composition
-    CompositionBase& operator=(const CompositionBase&&) { return *this; }
-
-    ElementData& operator[](const std::string& elementSymbol);
-    const ElementData& operator[](const std::string& elementSymbol) const;
+    ~CompositionBase() = default;
+
+public:
+    /** @brief Finds an element by its symbol (case insensitive). Does not allocate memory
+     *
+     * @param elementSymbol The element symbol
+     *
+     * @return Pointer to the element, or nullptr if it is not defined
+     */
+    ElementData* FindElement(std::string_view elementSymbol) noexcept
+    {
+        return const_cast<ElementData*>(static_cast<const CompositionBase*>(this)->FindElement(elementSymbol));
+    }
+    /// Const version of FindElement
+    const ElementData* FindElement(std::string_view elementSymbol) const noexcept
+    {
+        size_t key = PeriodicTable::SymbolKey(elementSymbol);
+        if (key >= PeriodicTable::SymbolKeyCount)
+            return nullptr;
+        unsigned char i = (*mvpLayout->SymbolTable)[key];
+        return i > 0 ? &element(i - 1) : nullptr;
+    }
+
+    ElementHandle GetElementHandle(std::string_view elementSymbol) const;
+
+    ElementData& operator[](std::string_view elementSymbol);
+    const ElementData& operator[](std::string_view elementSymbol) const;
+
+    /// Accesses an element by its handle (see GetElementHandle)
+    ElementData& operator[](ElementHandle handle) { return element(handle.GetIndex()); }
+    /// Accesses a const element by its handle (see GetElementHandle)
+    const ElementData& operator[](ElementHandle handle) const { return element(handle.GetIndex()); }
 
     /// Gets the symbol of the major element
-    const std::string GetMajorElementSymbol() const { return mvpMajorElement->mvSymbol; }
+    const std::string GetMajorElementSymbol() const { return element(mvpLayout->Partition.Major).GetSymbol(); }
 
     /// Returns an iterable container with all defined elements. One can can loop through
     /// all elements using the range-based for syntax:
-    ContainerElements GetElements() { return ContainerElements(getElementPointers()); }
-    ContainerConstElements GetElements() const { return ContainerConstElements(getElementPointers()); }
+    ContainerElements GetElements() { return ContainerElements(this, mvpLayout->Members, mvpLayout->Members + mvpLayout->NumberOfElements); }
+    ContainerConstElements GetElements() const { return ContainerConstElements(this, mvpLayout->Members, mvpLayout->Members + mvpLayout->NumberOfElements); }
+    /// Number of defined elements
+    size_t GetNumberOfElements() const { return mvpLayout->NumberOfElements; }
 };
 
 /** @brief Class used for composition base conversions: atomic <-> mass
  * fractions
  *
- * Note: while the performance of the composition conversion in this class
- * is quite reasonable, copying its instances is relatively slow.
+ * Copying and moving instances is cheap: the element layout is shared by
+ * all instances of a class, so no memory is allocated.
+ *
+ * The fractions are updated by UpdateFractions, whose results are identical
+ * in all code paths (e.g., CompositionBatch). The getters only read the
+ * stored fractions, so an updated composition can be read from several
+ * threads at once.
  */
 class Composition : public CompositionBase {
 private:
-    bool mvIsCompositionLocked = false; ///< If true, only the fractions of the variable elements (mvVariableElements) can be changed
+    bool mvIsCompositionLocked = false; ///< If true, only the fractions of the variable elements (ElementPartition::Variable) can be changed
     double mvMolarMassAvg = 0.0; ///< Average molar mass
     double mvMolarMassAvgFixedPartial = 0.0; ///< Fixed partial component of the molar mass
     double mvXSumSubstitutionalFixedPartial = 0.0; ///< Fixed partial component of the fraction of substitutional elements
 
     void updateFractions();
     void updateFractionsUFixed();
+    void setCompositionLocked(bool isLocked);
+
+    friend class CompositionSnapshot;
+    friend class CompositionWriter;
+    friend class CompositionFileView;
+    template <typename Scalar>
+    friend class ScalarCompositionBatch;
+
+protected:
+    /** @brief Updates the fractions using the algorithms in CompositionKernels
+     *
+     * @param el Accessor to the element data (see ElementDataAccessor)
+     * @param p Partition of the elements (ElementPartition or StaticPartition)
+     */
+    template <typename Accessor, typename Partition>
+    void updateFractions(Accessor& el, const Partition& p)
+    {
+        if (!mvIsCompositionLocked) {
+            COMPOSITION_COUNT(UpdateUnlocked);
+            CompositionKernels::UpdateFractions(el, p, mvMolarMassAvg,
+                mvMolarMassAvgFixedPartial, mvXSumSubstitutionalFixedPartial);
+        } else {
+            COMPOSITION_COUNT(UpdateLocked);
+            CompositionKernels::UpdateFractionsUFixed(el, p, mvMolarMassAvg,
+                mvMolarMassAvgFixedPartial, mvXSumSubstitutionalFixedPartial);
+        }
+    }
+
+    /** @brief Updates the fractions of a composition class T whose partition
+     * is known at compile time (see StaticPartition). The elements are
+     * accessed through the static table of member pointers of T, so all loops
+     * run over constant indices, and the molar masses are taken from the
+     * constexpr table T::elementMolarMasses()
+     */
+    template <typename T>
+    void updateFractionsStatic()
+    {
+        COMPOSITION_SCOPED_TIMER(UpdateFractions);
+
+        static constexpr std::array<double, T::NumberOfElements> molarMasses = T::elementMolarMasses();
+        T& comp = static_cast<T&>(*this);
+        auto getElement = [&comp](size_t i) -> ElementData& { return comp.*T::elementMembers()[i]; };
+        StaticElementDataAccessor<decltype(getElement), T::NumberOfElements> el { { getElement }, molarMasses };
+        updateFractions(el, StaticPartition<T>());
+    }
+
+    void setLayout(const CompositionLayout& layout);
 
-public:
     /// Default constructor
-    Composition() { }
+    Composition() = default;
+    /// Copy constructor
+    Composition(const Composition&) = default;
+    /// Copy assignment operator. Protected so that compositions of different classes cannot be assigned to each other
+    Composition& operator=(const Composition&) = default;
 
+public:
     /// Returns if composition is locked
     bool IsCompositionLocked() const { return mvIsCompositionLocked; }
 
@@ -233,25 +610,84 @@ public:
     void UpdateFractions();
     void Print(FILE* stream = stdout);
     void Print(FILE* stream = stdout) const;
+
+    CompositionStatus TryLockComposition() noexcept;
+    CompositionStatus TryUpdateFractions() noexcept;
+
+    void GetJacobian(CompositionJacobian& jacobian) const;
+    CompositionStatus ConvertLockedInterstitial(const ElementData& interstitial, const double* x, size_t count,
+        double* w, double* u = nullptr, double* molarMassAvg = nullptr) const noexcept;
 };
 
 /// Used together with FOR_ELEMENTS in MAKE_DEFINITIONS. Takes the element
 /// symbol and defines and initializes ElementData using the PeriodicTable
 #define DEFINE_ELEMENT(element, ...) ElementData element = ElementData(PeriodicTable::element, ##__VA_ARGS__);
 
-/// Used together with FOR_ELEMENTS in MAKE_DEFINITIONS. Append the pointer
-/// of each element to concatenate them together
-#define APPEND_ELEMENT_POINTER(element, ...) &element,
+/// Used together with FOR_ELEMENTS in MAKE_DEFINITIONS. Takes the element
+/// symbol and turns it into a string
+#define ELEMENT_SYMBOL(element, ...) #element,
+
+/// Used together with FOR_ELEMENTS in MAKE_DEFINITIONS. Counts the elements
+#define COUNT_ELEMENT(element, ...) +1
+
+/// Used together with FOR_ELEMENTS in MAKE_DEFINITIONS. Takes the element
+/// symbol and casts the pointer to its member to ElementMember
+#define ELEMENT_MEMBER(element, ...) static_cast<ElementMember>(&CompositionClass::element),
 
-/// Defines all elements and necessary virtual functions from Composition and CompositionBase
-#define MAKE_DEFINITIONS(FOR_ELEMENTS)                                                              \
-public:                                                                                             \
-    /* Define elements (ElementData) as public members */                                           \
-    FOR_ELEMENTS(DEFINE_ELEMENT)                                                                    \
-private:                                                                                            \
-    /* Override virtual functions */                                                                \
-    VectorElementPointers getElementPointers() { return { FOR_ELEMENTS(APPEND_ELEMENT_POINTER) }; } \
-    VectorConstElementPointers getElementPointers() const { return { FOR_ELEMENTS(APPEND_ELEMENT_POINTER) }; }
+/// Used together with FOR_ELEMENTS in MAKE_DEFINITIONS. Takes the element
+/// flags (isVariable, isInterstitial, isMajor) and turns them into ElementFlags
+#define ELEMENT_FLAGS(element, ...) ElementFlags { __VA_ARGS__ },
+
+/// Used together with FOR_ELEMENTS in MAKE_DEFINITIONS. Takes the element
+/// symbol and gets its molar mass from the PeriodicTable
+#define ELEMENT_MOLAR_MASS(element, ...) PeriodicTable::element.MolarMass,
+
+/// Defines all elements and the static tables used by CompositionBase
+#define MAKE_DEFINITIONS(ClassName, FOR_ELEMENTS)                                                                    \
+public:                                                                                                              \
+    /* Define elements (ElementData) as public members */                                                            \
+    FOR_ELEMENTS(DEFINE_ELEMENT)                                                                                     \
+    /* Number of elements */                                                                                         \
+    static constexpr size_t NumberOfElements = 0 FOR_ELEMENTS(COUNT_ELEMENT);                                        \
+                                                                                                                     \
+private:                                                                                                             \
+    typedef ClassName CompositionClass;                                                                              \
+    friend class Composition;                                                                                        \
+    template <typename T>                                                                                            \
+    friend struct StaticPartition;                                                                                   \
+    /* Flags of the elements, from which StaticPartition is computed at compile time */                              \
+    static constexpr std::array<ElementFlags, NumberOfElements> elementFlags()                                       \
+    {                                                                                                                \
+        return { { FOR_ELEMENTS(ELEMENT_FLAGS) } };                                                                  \
+    }                                                                                                                \
+    /* Molar masses of the elements, folded into constants by updateFractionsStatic */                               \
+    static constexpr std::array<double, NumberOfElements> elementMolarMasses()                                       \
+    {                                                                                                                \
+        return { { FOR_ELEMENTS(ELEMENT_MOLAR_MASS) } };                                                             \
+    }                                                                                                                \
+    /* Member pointers to the elements, built at compile time */                                                     \
+    static const std::array<ElementMember, NumberOfElements>& elementMembers()                                       \
+    {                                                                                                                \
+        static constexpr std::array<ElementMember, NumberOfElements> members = { { FOR_ELEMENTS(ELEMENT_MEMBER) } }; \
+        return members;                                                                                              \
+    }                                                                                                                \
+    /* Perfect hash table of the element symbols, built at compile time */                                           \
+    static const ElementSymbolTable& symbolTable()                                                                   \
+    {                                                                                                                \
+        static constexpr const char* symbols[] = { FOR_ELEMENTS(ELEMENT_SYMBOL) };                                   \
+        static constexpr ElementSymbolTable table = MakeElementSymbolTable(symbols);                                 \
+        return table;                                                                                                \
+    }                                                                                                                \
+    /* Layout of the elements, built once and shared by all instances of the class */                                \
+    void updateLayout()                                                                                              \
+    {                                                                                                                \
+        static const CompositionLayout layout(StaticPartition<CompositionClass>(), elementMembers(), symbolTable());  \
+        setLayout(layout);                                                                                           \
+    }                                                                                                                \
+                                                                                                                     \
+public:                                                                                                              \
+    /* Updates fractions, unrolled over the partition computed at compile time */                                    \
+    void UpdateFractions() { updateFractionsStatic<CompositionClass>(); }
 
 /** @brief Make a composition class for a given set of elements
  *
@@ -274,17 +710,22 @@ private:
  * The arguments in the DO macro call follow the Constructor of ElementData,
  * i.e., are respectively the element symbol, isVariable, isInterstitial, and
  * isMajor.
+ *
+ * The partition of the elements is computed at compile time (see
+ * StaticPartition), so a set of elements without exactly one major element
+ * does not compile. The same machinery is used by the template alternative
+ * CompositionOf (see composition_of.hpp).
  */
 #define MAKE_COMPOSITION_CLASS(ClassName, FOR_ELEMENTS) \
     class ClassName : public Composition {              \
-        /* Define elements and virtual functions */     \
-        MAKE_DEFINITIONS(FOR_ELEMENTS)                  \
+        /* Define elements and static tables */         \
+        MAKE_DEFINITIONS(ClassName, FOR_ELEMENTS)       \
     public:                                             \
         /* Constructor */                               \
         ClassName()                                     \
             : Composition()                             \
         {                                               \
-            updatePointers();                           \
+            updateLayout();                             \
         }                                               \
     };
 
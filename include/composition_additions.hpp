@@ -0,0 +1,102 @@
+/// @file composition_additions.hpp
+
+#ifndef COMPOSITION_ADDITIONS_H
+#define COMPOSITION_ADDITIONS_H
+
+#include "composition_batch.hpp"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class Executor;
+
+/** @brief Computes the masses of alloy additions (e.g., ferroalloys) that
+ * bring heats into target ranges of mass fractions
+ *
+ * Adding masses \f$a_k\f$ of additions with mass fractions \f$w_{k,e}\f$ to
+ * a heat of mass \f$H\f$ and mass fractions \f$w_{h,e}\f$ gives the mass
+ * fractions (see CompositionBlender)
+ *
+ * \f[ w_e = \frac{H w_{h,e} + \sum_k a_k w_{k,e}}{H + \sum_k a_k} \f]
+ *
+ * so each bound of a target range, \f$w_e \ge w_e^{min}\f$ or
+ * \f$w_e \le w_e^{max}\f$, is a linear constraint on the masses:
+ *
+ * \f[ \sum_k a_k (w_{k,e} - w_e^{min}) \ge -H (w_{h,e} - w_e^{min}) \f]
+ *
+ * The masses are found by a linear program minimizing the cost of the
+ * additions (by default, their total mass) subject to these constraints and
+ * to the available mass of each addition. Additions can only be added, so
+ * some targets may be out of reach (e.g., an element already above its
+ * maximum). The bounds are then relaxed, and the linear program is solved
+ * in two phases: the first one minimizes the mass of the elements outside
+ * their ranges, and the second one the cost, without increasing that mass.
+ * The deviations from the ranges are reported for each heat.
+ *
+ * The constraint matrix depends only on the additions and the targets, so
+ * it is built once and each heat only changes the right hand sides. The
+ * heats are solved independently (in parallel with an Executor), and the
+ * resulting compositions are converted together with the vectorized kernels
+ * of CompositionBatch.
+ *
+ * @code{.cpp}
+ * CompositionBatch additions(prototype, nAdditions); // e.g., FeMn, FeSi, FeCr (see Load)
+ * CompositionAdditionSolver solver(additions);
+ * solver.SetTargets({ { iC, 1e-3, 3e-3 }, { iMn, 1.0e-2, 1.4e-2 } });
+ *
+ * // heats: current composition of each heat, heatMasses: their masses
+ * std::vector<double> masses(nHeats * nAdditions), deviations(nHeats);
+ * CompositionBatch results(prototype);
+ * solver.Solve(heats, heatMasses, masses.data(), deviations.data(), results);
+ * @endcode
+ */
+class CompositionAdditionSolver {
+public:
+    /// Target range of the mass fraction of an element
+    struct Target {
+        size_t Element; ///< Index of the element
+        double MinW = 0.0; ///< Minimum mass fraction
+        double MaxW = 1.0; ///< Maximum mass fraction
+    };
+
+private:
+    struct Tableau;
+
+    /// Bound of a target range, as a row of the linear program
+    struct TargetRow {
+        size_t Element; ///< Index of the element
+        double Bound; ///< Minimum or maximum mass fraction
+        double Sign; ///< 1 for minimum, -1 for maximum
+    };
+
+    size_t mvNumberOfAdditions; ///< Number of additions
+    CompositionBatch mvElements; ///< Element definitions of the additions, without rows
+    std::vector<size_t> mvAlloying; ///< Indexes of the alloying elements
+    std::vector<double> mvAdditionW; ///< Mass fractions of the elements of each addition (one row per addition)
+    std::vector<double> mvCosts; ///< Cost per unit mass of each addition
+    std::vector<double> mvMaxMasses; ///< Available mass of each addition
+    std::vector<Target> mvTargets; ///< Target ranges
+    std::vector<TargetRow> mvTargetRows; ///< Bounds of the target ranges that constrain the masses
+
+    void checkHeats(const CompositionBatch& heats) const;
+    bool solveHeat(Tableau& tableau, const double* heatW, double heatMass, double* masses) const;
+
+public:
+    explicit CompositionAdditionSolver(const CompositionBatch& additions);
+
+    /// Number of additions
+    size_t NumberOfAdditions() const { return mvNumberOfAdditions; }
+    /// Number of elements
+    size_t NumberOfElements() const { return mvElements.NumberOfElements(); }
+
+    CompositionStatus SetCosts(const double* costs) noexcept;
+    CompositionStatus SetMaxMasses(const double* maxMasses) noexcept;
+    CompositionStatus SetTargets(const std::vector<Target>& targets);
+    /// Target ranges
+    const std::vector<Target>& GetTargets() const { return mvTargets; }
+
+    CompositionStatus Solve(const CompositionBatch& heats, const double* heatMasses, double* masses, double* deviations,
+        CompositionBatch& results, Executor* pExecutor = nullptr) const;
+};
+
+#endif
@@ -0,0 +1,183 @@
+/// @file composition_batch.hpp
+
+#ifndef COMPOSITION_BATCH_H
+#define COMPOSITION_BATCH_H
+
+#include "composition.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// Instruction sets of the vectorized kernels of CompositionBatch
+enum class InstructionSet {
+    Scalar, ///< No vectorization
+    SSE2, ///< 128-bit vectors: 2 compositions per instruction in double, 4 in float
+    AVX2, ///< 256-bit vectors: 4 compositions per instruction in double, 8 in float
+    AVX512 ///< 512-bit vectors: 8 compositions per instruction in double, 16 in float
+};
+
+/** @brief Batch of compositions sharing the same set of elements, stored as
+ * structure of arrays, whose fractions are stored and converted in a given
+ * scalar type
+ *
+ * The user defined (UserX, UserW) and calculated (X, W, U) fractions are
+ * stored as contiguous columns, one per element, with one row per
+ * composition. The element definitions and their partition (major,
+ * interstitial/substitutional, fixed/variable elements) are taken from a
+ * prototype Composition, and the conversions run the same algorithms as
+ * Composition (see CompositionKernels), in the precision of Scalar:
+ * - `double` (CompositionBatch) gives identical results to Composition
+ * - `float` halves the memory traffic of very large batches, and its
+ *   vectorized kernels convert twice as many compositions per instruction
+ * - `long double` (not vectorized) gives reference values to check the
+ *   accuracy of the other types
+ *
+ * The conversions are vectorized over the compositions, using the best
+ * instruction set supported by the CPU (detected at runtime).
+ *
+ * The fractions of a composition follow from a few sums over the elements,
+ * so the rounding errors of float grow with the number of elements n. When
+ * the mole fraction of the major element is at least 1/2 (e.g., steels), the
+ * mole, mass and site fractions and the average molar mass computed in float
+ * have relative errors below (n + 4) u, where u = 2^-24 (about 6e-8) is the
+ * unit roundoff of float, with respect to the exact conversion of the float
+ * inputs. This is checked against long double in
+ * test_composition_scalar_batch. Inputs given as doubles are rounded to float
+ * when they are set (relative error u).
+ *
+ * @code{.cpp}
+ * CompositionSteel prototype;
+ * CompositionBatch batch(prototype, nRows);
+ * size_t iC = batch.GetElementIndex("C");
+ * batch.SetW(iC, wC); // wC is an array with nRows values
+ * batch.UpdateFractions();
+ * const double* xC = batch.X(iC);
+ * @endcode
+ */
+template <typename Scalar>
+class ScalarCompositionBatch {
+public:
+    /// Partition of the elements of the batch. Same as the one of the
+    /// prototype composition (see CompositionLayout), the indices of the
+    /// elements being their columns
+    typedef ElementPartition Partition;
+
+private:
+    struct RowAccessor;
+
+    size_t mvSize = 0; ///< Number of compositions (rows)
+    InstructionSet mvInstructionSet = InstructionSet::Scalar; ///< Instruction set of the vectorized kernels
+    bool mvIsCompositionLocked = false; ///< If true, only the fractions of the variable elements can be changed
+
+    std::vector<std::string> mvSymbols; ///< Symbols of the elements
+    const ElementSymbolTable* mvpSymbolTable = nullptr; ///< Perfect hash table of the element symbols
+    std::vector<Scalar> mvMolarMasses; ///< Molar masses of the elements
+    std::vector<bool> mvIsInterstitial; ///< If the elements are interstitial
+    std::vector<bool> mvIsVariable; ///< If the elements are variable
+    Partition mvPartition; ///< Partition of the elements
+
+    std::vector<Scalar> mvUserX; ///< User defined mole fractions (one column per element)
+    std::vector<Scalar> mvUserW; ///< User defined mass fractions (one column per element)
+    std::vector<Scalar> mvX; ///< Calculated mole fractions (one column per element)
+    std::vector<Scalar> mvW; ///< Calculated mass fractions (one column per element)
+    std::vector<Scalar> mvU; ///< Calculated site fractions (one column per element)
+    std::vector<unsigned char> mvIsUpdated; ///< If the fractions are updated (one column per element)
+
+    std::vector<Scalar> mvMolarMassAvg; ///< Average molar mass of each row
+    std::vector<Scalar> mvMolarMassAvgFixedPartial; ///< Fixed partial component of the molar mass of each row
+    std::vector<Scalar> mvXSumSubstitutionalFixedPartial; ///< Fixed partial component of the fraction of substitutional elements of each row
+
+    CompositionStatus checkSetX(size_t element) const noexcept;
+    CompositionStatus checkSetW(size_t element) const noexcept;
+    void printSetError(CompositionStatus status, char fraction, size_t element) const;
+    void checkPrototype(const Composition& comp) const;
+    void updateFractions(bool isLocked, size_t begin, size_t end);
+
+    friend class CompositionField;
+
+public:
+    /// Constructor
+    explicit ScalarCompositionBatch(const Composition& prototype, size_t size = 0);
+
+    void Resize(size_t size);
+
+    static InstructionSet GetSupportedInstructionSet();
+    /// Instruction set used by the vectorized kernels
+    InstructionSet GetInstructionSet() const { return mvInstructionSet; }
+    void SetInstructionSet(InstructionSet instructionSet);
+    size_t GetVectorWidth() const;
+
+    /// @name Element definitions
+    /// @{
+    /// Number of compositions (rows) in the batch
+    size_t Size() const { return mvSize; }
+    /// Number of elements (columns) in the batch
+    size_t NumberOfElements() const { return mvSymbols.size(); }
+    /// Partition of the elements
+    const Partition& GetPartition() const { return mvPartition; }
+    /// Index of the major element
+    size_t GetMajorElementIndex() const { return mvPartition.Major; }
+    size_t GetElementIndex(std::string_view elementSymbol) const;
+    /// Symbol of an element
+    const std::string& GetSymbol(size_t element) const { return mvSymbols[element]; }
+    /// Molar mass of an element
+    Scalar GetMolarMass(size_t element) const { return mvMolarMasses[element]; }
+    bool HasSameLayout(const ScalarCompositionBatch& batch) const;
+    bool HasSameLayout(const Composition& comp) const;
+    /// @}
+
+    /// @name Setters
+    /// @{
+    void SetX(size_t element, size_t row, Scalar x);
+    void SetW(size_t element, size_t row, Scalar w);
+    void SetX(size_t element, const Scalar* x);
+    void SetW(size_t element, const Scalar* w);
+    CompositionStatus TrySetX(size_t element, size_t row, Scalar x) noexcept;
+    CompositionStatus TrySetW(size_t element, size_t row, Scalar w) noexcept;
+    CompositionStatus TrySetX(size_t element, const Scalar* x) noexcept;
+    CompositionStatus TrySetW(size_t element, const Scalar* w) noexcept;
+    /// @}
+
+    /// @name Getters
+    /// @{
+    /// Get mole fraction
+    Scalar GetX(size_t element, size_t row) const { return mvX[element * mvSize + row]; }
+    /// Get weight fraction
+    Scalar GetW(size_t element, size_t row) const { return mvW[element * mvSize + row]; }
+    /// Get U-fraction (site fraction)
+    Scalar GetU(size_t element, size_t row) const { return mvU[element * mvSize + row]; }
+    /// Get average molar mass
+    Scalar GetMolarMassAvg(size_t row) const { return mvMolarMassAvg[row]; }
+
+    /// Column with the mole fractions of an element
+    const Scalar* X(size_t element) const { return mvX.data() + element * mvSize; }
+    /// Column with the weight fractions of an element
+    const Scalar* W(size_t element) const { return mvW.data() + element * mvSize; }
+    /// Column with the U-fractions (site fractions) of an element
+    const Scalar* U(size_t element) const { return mvU.data() + element * mvSize; }
+    /// Column with the average molar masses
+    const Scalar* MolarMassAvg() const { return mvMolarMassAvg.data(); }
+    /// @}
+
+    void Load(size_t row, const Composition& comp);
+    void Store(size_t row, Composition& comp) const;
+
+    /// Returns if the batch is locked
+    bool IsCompositionLocked() const { return mvIsCompositionLocked; }
+
+    void LockComposition();
+    void UnlockComposition();
+    void UpdateFractions();
+    void UpdateFractions(size_t beginRow, size_t endRow);
+    void GetJacobian(size_t row, CompositionJacobian& jacobian) const;
+};
+
+extern template class ScalarCompositionBatch<float>;
+extern template class ScalarCompositionBatch<double>;
+extern template class ScalarCompositionBatch<long double>;
+
+/// Batch of compositions in double precision, with identical results to
+/// Composition
+typedef ScalarCompositionBatch<double> CompositionBatch;
+
+#endif
@@ -0,0 +1,60 @@
+/// @file composition_blend.hpp
+
+#ifndef COMPOSITION_BLEND_H
+#define COMPOSITION_BLEND_H
+
+#include "composition_batch.hpp"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/** @brief Blends source compositions (e.g., the scrap and ferroalloys of a
+ * charge) into mixes, given the mass of each source in each mix
+ *
+ * Mixing conserves mass, so the mass fraction of each element in a mix is
+ * the average of its mass fractions in the sources, weighted by their
+ * masses:
+ *
+ * \f[ w_{m,e} = \frac{\sum_s M_{m,s} w_{s,e}}{\sum_s M_{m,s}} \f]
+ *
+ * where \f$M_{m,s}\f$ is the mass of source s in mix m. The mass fractions
+ * of all mixes are computed as a single product of the weight matrix by the
+ * matrix of the mass fractions of the sources, skipping the sources absent
+ * from a mix, and the mixes are then converted together with the vectorized
+ * kernels of CompositionBatch (see CompositionKernels::UpdateFractions).
+ * Each mix gives identical results to a Composition whose alloying elements
+ * are set to the blended mass fractions (see ElementData::SetW) before
+ * calling UpdateFractions.
+ *
+ * @code{.cpp}
+ * CompositionBatch sources(prototype, nSources);
+ * for (size_t s = 0; s < nSources; s++)
+ *     sources.Load(s, scrap[s]); // or set their fractions and UpdateFractions
+ * CompositionBlender blender(sources);
+ *
+ * CompositionBatch mixes(prototype);
+ * blender.Blend(masses, nMixes, mixes); // masses: nMixes x nSources, row-major
+ * const double* xC = mixes.X(mixes.GetElementIndex("C"));
+ * @endcode
+ */
+class CompositionBlender {
+private:
+    size_t mvNumberOfSources; ///< Number of sources
+    CompositionBatch mvElements; ///< Element definitions of the sources, without rows
+    std::vector<size_t> mvAlloying; ///< Indexes of the alloying elements
+    std::vector<double> mvSourceW; ///< Mass fractions of the alloying elements of each source (one row per source)
+
+    void checkMixes(const CompositionBatch& mixes) const;
+
+public:
+    explicit CompositionBlender(const CompositionBatch& sources);
+
+    /// Number of sources
+    size_t NumberOfSources() const { return mvNumberOfSources; }
+    /// Number of elements
+    size_t NumberOfElements() const { return mvElements.NumberOfElements(); }
+
+    CompositionStatus Blend(const double* masses, size_t numberOfMixes, CompositionBatch& mixes) const;
+};
+
+#endif
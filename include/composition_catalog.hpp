@@ -0,0 +1,114 @@
+/// @file composition_catalog.hpp
+
+#ifndef COMPOSITION_CATALOG_H
+#define COMPOSITION_CATALOG_H
+
+#include "composition_batch.hpp"
+#include "composition_field.hpp"
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/** @brief Catalog of compositions (e.g., the specifications of steel
+ * grades) sharing the same set of elements, queried by ranges of their
+ * fractions
+ *
+ * The grades are added once, then Build converts them all with the
+ * vectorized kernels of CompositionBatch, keeping the mole, mass and site
+ * fractions of each element as columns, and sorts each column into an index.
+ * A query is a list of ranges of the fractions of some elements, in any
+ * basis (e.g., mass fraction of C, mole fraction of Mn and site fraction of
+ * N). Find looks up each range in its index with binary searches, takes the
+ * rows of the most selective one and checks the other ranges against the
+ * columns, so its cost is proportional to the number of grades in the
+ * narrowest range rather than to the size of the catalog.
+ *
+ * Each grade is converted from its user defined fractions (see
+ * ElementData::SetX and SetW), as an unlocked composition, giving identical
+ * fractions to Composition::UpdateFractions.
+ *
+ * @code{.cpp}
+ * CompositionCatalog catalog(prototype);
+ * for (const Grade& grade : grades)
+ *     catalog.Add(grade.Composition, grade.Name);
+ * catalog.Build();
+ *
+ * // C 0.1-0.3 wt%, Mn < 2 at%, N site fraction < 1e-3
+ * std::vector<size_t> found = catalog.Find({
+ *     { catalog.GetElementIndex("C"), FieldFraction::W, 1e-3, 3e-3 },
+ *     { catalog.GetElementIndex("Mn"), FieldFraction::X, 0.0, std::nextafter(2e-2, 0.0) },
+ *     { catalog.GetElementIndex("N"), FieldFraction::U, 0.0, std::nextafter(1e-3, 0.0) } });
+ * @endcode
+ *
+ * After Build, any number of threads can query the catalog concurrently.
+ */
+class CompositionCatalog {
+public:
+    /// Range of a fraction of an element. The bounds are included; strict
+    /// bounds can be given with std::nextafter
+    struct Range {
+        size_t Element; ///< Index of the element
+        FieldFraction Fraction; ///< Fraction (basis) of the bounds
+        double Min = -HUGE_VAL; ///< Lower bound
+        double Max = HUGE_VAL; ///< Upper bound
+    };
+
+private:
+    /// Fractions of an element sorted in increasing order, with their rows
+    struct SortedColumn {
+        std::vector<double> Values; ///< Sorted fractions
+        std::vector<uint32_t> Rows; ///< Row of each value
+    };
+
+    size_t mvSize = 0; ///< Number of grades
+    bool mvIsBuilt = false; ///< If the fractions and indexes are up to date with the added grades
+    CompositionBatch mvBatch; ///< Fractions of the grades (its size is the capacity of the catalog)
+    std::vector<std::string> mvNames; ///< Names of the grades
+    std::vector<SortedColumn> mvIndexes; ///< Index of each fraction of each element (3 per element)
+
+    const double* column(size_t element, FieldFraction fraction) const;
+    const SortedColumn& index(const Range& range) const;
+    void checkQuery(const std::vector<Range>& ranges) const;
+    template <typename F>
+    void forEachMatch(const std::vector<Range>& ranges, F f) const;
+
+public:
+    explicit CompositionCatalog(const Composition& prototype);
+
+    /// Number of grades
+    size_t Size() const { return mvSize; }
+    /// Number of elements
+    size_t NumberOfElements() const { return mvBatch.NumberOfElements(); }
+    /// Index of an element (see CompositionBatch::GetElementIndex)
+    size_t GetElementIndex(std::string_view elementSymbol) const { return mvBatch.GetElementIndex(elementSymbol); }
+    /// Name of a grade
+    const std::string& GetName(size_t grade) const { return mvNames[grade]; }
+    /// Returns if the fractions and indexes are up to date with the added grades
+    bool IsBuilt() const { return mvIsBuilt; }
+
+    size_t Add(const Composition& grade, std::string name = std::string());
+    void Build();
+
+    /// @name Getters (after Build)
+    /// @{
+    /// Get mole fraction
+    double GetX(size_t element, size_t grade) const { return mvBatch.GetX(element, grade); }
+    /// Get weight fraction
+    double GetW(size_t element, size_t grade) const { return mvBatch.GetW(element, grade); }
+    /// Get U-fraction (site fraction)
+    double GetU(size_t element, size_t grade) const { return mvBatch.GetU(element, grade); }
+    /// Get average molar mass
+    double GetMolarMassAvg(size_t grade) const { return mvBatch.GetMolarMassAvg(grade); }
+    void Store(size_t grade, Composition& comp) const;
+    /// @}
+
+    /// @name Queries (after Build)
+    /// @{
+    std::vector<size_t> Find(const std::vector<Range>& ranges) const;
+    size_t Count(const std::vector<Range>& ranges) const;
+    /// @}
+};
+
+#endif
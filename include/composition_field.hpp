@@ -0,0 +1,110 @@
+/// @file composition_field.hpp
+
+#ifndef COMPOSITION_FIELD_H
+#define COMPOSITION_FIELD_H
+
+#include "composition_batch.hpp"
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+class CompositionSublattices;
+
+/// Fractions of the arrays of a CompositionField
+enum class FieldFraction {
+    X, ///< Mole fraction
+    W, ///< Mass fraction
+    U ///< Site fraction (outputs only)
+};
+
+/** @brief Converts composition fields stored in caller-provided arrays
+ *
+ * The fields (e.g., of a phase-field simulation) are given as strided arrays
+ * of doubles, one per element, with one value per cell. They can be
+ * allocated by the caller or memory-mapped from files, and each array can
+ * have its own stride (e.g., 1 for one array per element, or the number of
+ * elements for interleaved arrays). The inputs are mole or mass fractions,
+ * and the outputs, written into the same or separate arrays, are mole, mass
+ * and site fractions and the average molar mass.
+ *
+ * The cells are converted in tiles of a few hundred cells, so the working
+ * set stays in cache regardless of the size of the field: the inputs of a
+ * tile are gathered into a CompositionBatch, converted with its vectorized
+ * kernels and scattered into the outputs. Since the inputs of a tile are
+ * read before its outputs are written, outputs can overwrite inputs in
+ * place.
+ *
+ * Each cell gives identical results to a copy of the prototype composition
+ * whose elements with input arrays are set (see ElementData::SetX and SetW)
+ * before calling UpdateFractions. The elements without input arrays keep the
+ * fractions of the prototype. If the prototype is locked, only the mole
+ * fractions of its variable elements can be inputs, and the site fractions
+ * of the fixed elements are those of the prototype.
+ *
+ * @code{.cpp}
+ * CompositionSteel prototype; // e.g., with the substitutional elements set
+ * prototype.LockComposition();
+ * CompositionField field(prototype);
+ * field.SetInput(iC, FieldFraction::X, xC);  // e.g., memory-mapped array
+ * field.SetOutput(iC, FieldFraction::W, xC); // in place
+ * field.Convert(0, nCells);
+ * @endcode
+ *
+ * With a sublattice model (see SetSublattices), the U outputs receive the
+ * site fractions of the model instead, computed in the same tile pass, and
+ * the site fractions of the vacancies of each sublattice can be written too.
+ *
+ * Convert is not thread safe, but copies of a field can convert disjoint
+ * ranges of cells concurrently.
+ */
+class CompositionField {
+public:
+    /// Default number of cells per tile
+    static constexpr size_t DefaultTileSize = 512;
+
+private:
+    /// Strided input array of a field
+    struct Input {
+        const double* Data = nullptr; ///< Value of the first cell (nullptr if none)
+        std::ptrdiff_t Stride = 1; ///< Distance between the values of consecutive cells, in doubles
+        FieldFraction Fraction = FieldFraction::X; ///< Fraction of the values
+    };
+
+    /// Strided output array of a field
+    struct Output {
+        double* Data = nullptr; ///< Value of the first cell (nullptr if none)
+        std::ptrdiff_t Stride = 1; ///< Distance between the values of consecutive cells, in doubles
+    };
+
+    CompositionBatch mvPrototype; ///< The prototype composition (single row)
+    CompositionBatch mvTile; ///< Fractions of the cells of a tile
+    std::vector<Input> mvInputs; ///< Input of each element
+    std::vector<Output> mvOutputs[3]; ///< Outputs X, W and U of each element
+    Output mvMolarMassAvgOutput; ///< Output of the average molar mass
+    const CompositionSublattices* mvpSublattices = nullptr; ///< Sublattice model of the U outputs (nullptr if none)
+    std::vector<Output> mvVacancyOutputs; ///< Output of the vacancies of each sublattice
+    std::vector<double> mvSiteFractions; ///< Site fractions of the sublattice model of a tile
+    std::vector<double> mvVacancies; ///< Site fractions of the vacancies of a tile
+
+    void convertTile(size_t begin, size_t count);
+
+public:
+    explicit CompositionField(const Composition& prototype, size_t tileSize = DefaultTileSize);
+
+    /// Number of elements
+    size_t NumberOfElements() const { return mvPrototype.NumberOfElements(); }
+    /// Index of an element (see CompositionBatch::GetElementIndex)
+    size_t GetElementIndex(std::string_view elementSymbol) const { return mvPrototype.GetElementIndex(elementSymbol); }
+    /// Number of cells per tile
+    size_t GetTileSize() const { return mvTile.Size(); }
+
+    CompositionStatus SetInput(size_t element, FieldFraction fraction, const double* data, std::ptrdiff_t stride = 1) noexcept;
+    void SetOutput(size_t element, FieldFraction fraction, double* data, std::ptrdiff_t stride = 1) noexcept;
+    void SetMolarMassAvgOutput(double* data, std::ptrdiff_t stride = 1) noexcept;
+    CompositionStatus SetSublattices(const CompositionSublattices* pSublattices);
+    CompositionStatus SetVacancyOutput(size_t sublattice, double* data, std::ptrdiff_t stride = 1) noexcept;
+
+    void Convert(size_t beginCell, size_t endCell);
+};
+
+#endif
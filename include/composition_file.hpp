@@ -0,0 +1,186 @@
+/// @file composition_file.hpp
+
+#ifndef COMPOSITION_FILE_H
+#define COMPOSITION_FILE_H
+
+#include "composition.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/** @brief Binary format of files of compositions (e.g., checkpoints)
+ *
+ * A file is a header, followed by the definitions of the elements and by
+ * fixed size records, one per composition. All values are in the byte order
+ * of the writer (checked by the reader) and aligned to their size, so the
+ * records can be read in place, e.g., from a memory-mapped file (see
+ * CompositionFileView).
+ *
+ * | Section  | Content                                                     |
+ * |----------|-------------------------------------------------------------|
+ * | Header   | CompositionFile::Header                                     |
+ * | Elements | CompositionFile::Element for each element                   |
+ * | Records  | NumberOfRecords records of RecordSize bytes                 |
+ *
+ * Each record has the average molar mass and the fixed partial components
+ * of the composition (3 doubles). If Contents has UserFractions, they are
+ * followed by the user defined fractions UserX and UserW (2 x
+ * NumberOfElements doubles). If Contents has Fractions, they are followed by
+ * the fractions X, W and U (3 x NumberOfElements doubles). The record ends
+ * with the lock state (1 byte), the update flags of the elements
+ * (NumberOfElements bytes) and padding to 8 bytes.
+ */
+namespace CompositionFile {
+/// Version of the format written by CompositionWriter
+constexpr uint32_t Version = 1;
+
+/// Value of Header::ByteOrder, read as another value if the byte order differs
+constexpr uint32_t ByteOrder = 0x01020304;
+
+/// Contents of the records (bit flags)
+enum Contents : uint32_t {
+    UserFractions = 1, ///< User defined fractions (inputs), enough for unlocked compositions
+    Fractions = 2, ///< Calculated fractions X, W and U
+    AllContents = UserFractions | Fractions, ///< Both
+};
+
+/// Header of a file
+struct Header {
+    char Magic[8]; ///< "COMPOSB" followed by a null character
+    uint32_t Version; ///< Version of the format
+    uint32_t ByteOrder; ///< ByteOrder in the byte order of the writer
+    uint32_t NumberOfElements; ///< Number of elements
+    uint32_t Contents; ///< Contents of the records (see Contents)
+    uint32_t RecordSize; ///< Size of each record, in bytes
+    uint32_t RecordsOffset; ///< Offset of the first record, in bytes
+    uint64_t NumberOfRecords; ///< Number of records
+};
+
+/// Definition of an element
+struct Element {
+    char Symbol[4]; ///< Symbol, padded with null characters
+    uint8_t IsMajor; ///< If it is the major element
+    uint8_t IsVariable; ///< If it is a variable element
+    uint8_t IsInterstitial; ///< If it is an interstitial element
+    uint8_t Reserved; ///< Zero
+    double MolarMass; ///< Molar mass
+};
+
+static_assert(sizeof(Header) == 40, "Unexpected padding of CompositionFile::Header");
+static_assert(sizeof(Element) == 16, "Unexpected padding of CompositionFile::Element");
+
+size_t GetRecordSize(size_t numberOfElements, uint32_t contents);
+bool HasSameLayout(const Element* elements, size_t numberOfElements, const Composition& comp);
+}
+
+/** @brief Writes compositions into a file (see CompositionFile)
+ *
+ * @code{.cpp}
+ * FILE* stream = fopen("checkpoint.bin", "wb");
+ * CompositionWriter writer(stream, comps[0]);
+ * for (const CompositionSteel& comp : comps)
+ *     writer.Write(comp);
+ * writer.Close();
+ * fclose(stream);
+ * @endcode
+ */
+class CompositionWriter {
+private:
+    FILE* mvpStream; ///< The file stream
+    long mvHeaderPosition; ///< Position of the header in the stream
+    CompositionFile::Header mvHeader; ///< The header
+    std::vector<CompositionFile::Element> mvElements; ///< Definitions of the elements
+    const CompositionLayout* mvpLayout; ///< Layout of the prototype, which needs no check
+    std::vector<unsigned char> mvRecord; ///< Buffer of a record
+
+    void write(const void* data, size_t size);
+
+public:
+    CompositionWriter(FILE* stream, const Composition& prototype, uint32_t contents = CompositionFile::AllContents);
+
+    CompositionWriter(const CompositionWriter&) = delete;
+    CompositionWriter& operator=(const CompositionWriter&) = delete;
+
+    /// Number of compositions written
+    size_t NumberOfRecords() const { return mvHeader.NumberOfRecords; }
+
+    void Write(const Composition& comp);
+    void Close();
+};
+
+/** @brief Reads compositions from the contents of a file (see
+ * CompositionFile) in place, without copying them
+ *
+ * The contents can be read into memory or memory-mapped, and must stay
+ * valid, unchanged, while the view is used. They must be aligned to 8 bytes
+ * (as memory-mapped files and allocated memory are). The elements of the
+ * compositions are checked against the file once per layout, so loading
+ * many records into compositions of the same class costs no more than
+ * copying them.
+ */
+class CompositionFileView {
+private:
+    const unsigned char* mvpData; ///< Contents of the file
+    const CompositionFile::Header* mvpHeader; ///< The header
+    const CompositionFile::Element* mvpElements; ///< Definitions of the elements
+    mutable std::atomic<const CompositionLayout*> mvpCheckedLayout { nullptr }; ///< Last layout found to match the elements
+
+    /// Start of a record
+    const unsigned char* record(size_t i) const { return mvpData + mvpHeader->RecordsOffset + i * mvpHeader->RecordSize; }
+    /// Doubles of a record, starting at an offset in number of doubles
+    const double* doubles(size_t i, size_t offset) const { return reinterpret_cast<const double*>(record(i)) + offset; }
+    /// Offset of the user defined fractions UserX, in number of doubles
+    size_t userFractionsOffset() const { return 3; }
+    /// Offset of the fractions X, in number of doubles
+    size_t fractionsOffset() const { return 3 + (HasUserFractions() ? 2 * NumberOfElements() : 0); }
+    /// Lock state and update flags of a record
+    const unsigned char* flags(size_t i) const { return record(i) + sizeof(double) * (fractionsOffset() + (HasFractions() ? 3 * NumberOfElements() : 0)); }
+
+    void checkLayout(const Composition& comp) const;
+
+public:
+    CompositionFileView(const void* data, size_t size);
+    CompositionFileView(const CompositionFileView& other);
+    CompositionFileView& operator=(const CompositionFileView& other);
+
+    /// @name Header
+    /// @{
+    /// Version of the format
+    uint32_t GetVersion() const { return mvpHeader->Version; }
+    /// Number of elements
+    size_t NumberOfElements() const { return mvpHeader->NumberOfElements; }
+    /// Number of compositions
+    size_t NumberOfRecords() const { return mvpHeader->NumberOfRecords; }
+    /// If the records have the user defined fractions
+    bool HasUserFractions() const { return (mvpHeader->Contents & CompositionFile::UserFractions) != 0; }
+    /// If the records have the calculated fractions
+    bool HasFractions() const { return (mvpHeader->Contents & CompositionFile::Fractions) != 0; }
+    /// Definition of an element
+    const CompositionFile::Element& GetElement(size_t element) const { return mvpElements[element]; }
+    /// @}
+
+    /// @name Records
+    /// @{
+    /// Average molar mass
+    double GetMolarMassAvg(size_t i) const { return *doubles(i, 0); }
+    /// If the composition is locked
+    bool IsCompositionLocked(size_t i) const { return flags(i)[0] != 0; }
+    /// User defined mole fractions of all elements (nullptr if not in the file)
+    const double* UserX(size_t i) const { return HasUserFractions() ? doubles(i, userFractionsOffset()) : nullptr; }
+    /// User defined mass fractions of all elements (nullptr if not in the file)
+    const double* UserW(size_t i) const { return HasUserFractions() ? doubles(i, userFractionsOffset() + NumberOfElements()) : nullptr; }
+    /// Mole fractions of all elements (nullptr if not in the file)
+    const double* X(size_t i) const { return HasFractions() ? doubles(i, fractionsOffset()) : nullptr; }
+    /// Mass fractions of all elements (nullptr if not in the file)
+    const double* W(size_t i) const { return HasFractions() ? doubles(i, fractionsOffset() + NumberOfElements()) : nullptr; }
+    /// Site fractions of all elements (nullptr if not in the file)
+    const double* U(size_t i) const { return HasFractions() ? doubles(i, fractionsOffset() + 2 * NumberOfElements()) : nullptr; }
+    /// @}
+
+    void Load(size_t i, Composition& comp) const;
+};
+
+#endif
@@ -0,0 +1,123 @@
+/// @file composition_instrumentation.hpp
+
+#ifndef COMPOSITION_INSTRUMENTATION_H
+#define COMPOSITION_INSTRUMENTATION_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+/** @brief Optional instrumentation of the hot paths
+ *
+ * Counts which conversion paths are taken (e.g., locked or unlocked) and,
+ * optionally, times the main operations. The counters are kept per thread,
+ * so counting costs a non-atomic increment, and are summed over all threads
+ * by GetMetrics, which can be called periodically from any thread.
+ *
+ * The instrumentation is compiled out unless the library is built with
+ * -DCOMPOSITION_INSTRUMENTATION=ON, which defines
+ * COMPOSITION_ENABLE_INSTRUMENTATION. Otherwise, COMPOSITION_COUNT and
+ * COMPOSITION_SCOPED_TIMER expand to nothing and GetMetrics returns zeros.
+ */
+namespace CompositionInstrumentation {
+/// Counted events
+enum class Event : unsigned char {
+    UpdateUnlocked, ///< Full update of an unlocked composition (see CompositionKernels::UpdateFractions)
+    UpdateLocked, ///< Full update of a locked composition (see CompositionKernels::UpdateFractionsUFixed)
+    LayoutBinding, ///< Layout bound to a new composition (copies share the layout and are not counted)
+    LockComposition, ///< Calls to LockComposition
+    UnlockComposition, ///< Calls to UnlockComposition
+    BatchUpdate, ///< Calls to CompositionBatch::UpdateFractions
+    BatchRows, ///< Rows updated by CompositionBatch::UpdateFractions
+};
+
+/// Number of values of Event
+constexpr size_t EventCount = 7;
+
+/// Timed operations
+enum class Timer : unsigned char {
+    UpdateFractions, ///< Composition::UpdateFractions
+    LockComposition, ///< Composition::LockComposition
+    BatchUpdateFractions, ///< CompositionBatch::UpdateFractions
+};
+
+/// Number of values of Timer
+constexpr size_t TimerCount = 3;
+
+/// Values of the counters and timers, summed over all threads
+struct Metrics {
+    unsigned long long Events[EventCount] = {}; ///< Number of events
+    unsigned long long TimerCalls[TimerCount] = {}; ///< Number of timed calls
+    unsigned long long TimerNanoseconds[TimerCount] = {}; ///< Total time of the timed calls (ns)
+};
+
+/// Whether the library was built with the instrumentation
+constexpr bool IsEnabled() noexcept
+{
+#ifdef COMPOSITION_ENABLE_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char* GetEventName(Event event) noexcept;
+const char* GetTimerName(Timer timer) noexcept;
+
+void Count(Event event, unsigned long long n = 1) noexcept;
+void AddTime(Timer timer, unsigned long long nanoseconds) noexcept;
+
+void SetTimersEnabled(bool isEnabled) noexcept;
+bool AreTimersEnabled() noexcept;
+
+Metrics GetMetrics();
+void Reset();
+
+bool WriteJson(FILE* stream, const Metrics& metrics);
+bool WriteCsv(FILE* stream, const Metrics& metrics);
+
+/// Adds the time from its construction to its destruction to a timer, if
+/// the timers are enabled (see SetTimersEnabled)
+class ScopedTimer {
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    Timer mvTimer; ///< The timer
+    bool mvIsEnabled; ///< If the timers were enabled at construction
+    Clock::time_point mvStart; ///< Construction time
+
+public:
+    explicit ScopedTimer(Timer timer) noexcept
+        : mvTimer(timer)
+        , mvIsEnabled(AreTimersEnabled())
+    {
+        if (mvIsEnabled)
+            mvStart = Clock::now();
+    }
+
+    ~ScopedTimer()
+    {
+        if (mvIsEnabled)
+            AddTime(mvTimer, std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - mvStart).count());
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
+}
+
+#ifdef COMPOSITION_ENABLE_INSTRUMENTATION
+/// Counts an event (see CompositionInstrumentation::Event)
+#define COMPOSITION_COUNT(event) CompositionInstrumentation::Count(CompositionInstrumentation::Event::event)
+/// Counts an event n times
+#define COMPOSITION_COUNT_N(event, n) CompositionInstrumentation::Count(CompositionInstrumentation::Event::event, n)
+/// Times the rest of the enclosing scope (see CompositionInstrumentation::Timer)
+#define COMPOSITION_SCOPED_TIMER(timer) \
+    CompositionInstrumentation::ScopedTimer compositionScopedTimer(CompositionInstrumentation::Timer::timer)
+#else
+#define COMPOSITION_COUNT(event) ((void)0)
+#define COMPOSITION_COUNT_N(event, n) ((void)0)
+#define COMPOSITION_SCOPED_TIMER(timer) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,288 @@
+/// @file composition_kernels.hpp
+
+#ifndef COMPOSITION_KERNELS_H
+#define COMPOSITION_KERNELS_H
+
+#include <cstddef>
+
+/** @brief Implementation of the composition conversion algorithms
+ *
+ * The algorithms are written as templates so that the same code can be used
+ * regardless of how the element data is stored (e.g., ElementData members of
+ * a Composition or the columns of a CompositionBatch). This guarantees that
+ * all storage layouts give identical results.
+ *
+ * The element data is reached through an accessor object `el`, which for an
+ * element handle `h` must provide:
+ * - `el.MolarMass(h)`: molar mass of the element
+ * - `el.UserX(h)`, `el.UserW(h)`: references to the user defined fractions
+ * - `el.X(h)`, `el.W(h)`, `el.U(h)`: references to the calculated fractions
+ * - `el.IsUpdated(h)`: reference to the flag telling if the element is updated
+ *
+ * The partition `p` of the elements provides the handle of the major element
+ * (`p.Major`) and iterable ranges of handles: `p.Alloying`, `p.Interstitial`,
+ * `p.VariableInterstitial`, `p.VariableSubstitutional`, `p.FixedInterstitial`,
+ * `p.Variable` and `p.Fixed` (see ElementPartition and StaticPartition)
+ *
+ * UpdateFractions and UpdateFractionsUFixed are also templated on the scalar
+ * type of the fractions (`Scalar`, deduced from the molar mass arguments), so
+ * they can run in float or long double (see ScalarCompositionBatch). The
+ * accessor then returns references to that type.
+ */
+namespace CompositionKernels {
+
+/** @brief Updates the fractions of an unlocked composition
+ *
+ * @param el Accessor to the element data
+ * @param p Partition of the elements
+ * @param molarMassAvg Average molar mass (output)
+ * @param molarMassAvgFixedPartial Fixed partial component of the molar mass (output)
+ * @param xSumSubstitutionalFixedPartial Fixed partial component of the fraction of substitutional elements (output)
+ */
+template <typename Accessor, typename Partition, typename Scalar>
+inline void UpdateFractions(Accessor& el, const Partition& p, Scalar& molarMassAvg,
+    Scalar& molarMassAvgFixedPartial, Scalar& xSumSubstitutionalFixedPartial)
+{
+    Scalar MMajor = el.MolarMass(p.Major);
+    // MAvgNum: Average molar mass numerator
+    // MAvgDen: Average molar mass denominator
+    Scalar MAvgNum = MMajor, MAvgDen = 1;
+
+    // xSum: sum of the atomic fractions of all atomic elements (excluding major)
+    // wSum: sum of the weight fractions of all atomic elements (excluding major)
+    Scalar xSum = 0, wSum = 0;
+    // Calculates average molar mass and mole fraction of major element
+    for (auto h : p.Alloying) {
+        xSum += el.UserX(h);
+        MAvgNum -= (MMajor - el.MolarMass(h)) * el.UserX(h);
+
+        wSum += el.UserW(h) / el.MolarMass(h);
+        MAvgDen += (MMajor / el.MolarMass(h) - Scalar(1)) * el.UserW(h);
+    }
+
+    molarMassAvg = MAvgNum / MAvgDen;
+    Scalar xMajor = Scalar(1) - xSum - wSum * molarMassAvg;
+
+    el.X(p.Major) = xMajor;
+    el.W(p.Major) = xMajor * MMajor / molarMassAvg;
+
+    // Calculates mole and mass fractions of remaining elements
+    for (auto h : p.Alloying) {
+        Scalar conversionFactor = molarMassAvg / el.MolarMass(h);
+        if (el.UserX(h) > 0)
+            el.W(h) = el.UserX(h) / conversionFactor;
+        else if (el.UserW(h) > 0)
+            el.X(h) = el.UserW(h) * conversionFactor;
+    }
+
+    Scalar xSumSubstitutional = 1;
+    // Calculates fraction of substitutional elements
+    for (auto h : p.Interstitial) {
+        xSumSubstitutional -= el.X(h);
+    }
+
+    // Calculates site fractions U
+    el.U(p.Major) = el.X(p.Major) / xSumSubstitutional;
+    el.IsUpdated(p.Major) = true;
+
+    for (auto h : p.Variable) {
+        el.U(h) = el.X(h) / xSumSubstitutional;
+        el.IsUpdated(h) = true;
+    }
+
+    molarMassAvgFixedPartial = 0;
+    for (auto h : p.Fixed) {
+        el.U(h) = el.X(h) / xSumSubstitutional;
+        molarMassAvgFixedPartial += el.U(h) * (MMajor - el.MolarMass(h));
+        el.IsUpdated(h) = true;
+    }
+
+    xSumSubstitutionalFixedPartial = 1;
+    for (auto h : p.FixedInterstitial) {
+        xSumSubstitutionalFixedPartial -= el.X(h);
+    }
+}
+
+/** @brief Updates the fractions of a locked composition. It assumes that the
+ * u-fractions (site fractions) of the "fixed" or "non-variable" elements do
+ * not change
+ *
+ * @param el Accessor to the element data
+ * @param p Partition of the elements
+ * @param molarMassAvg Average molar mass (output)
+ * @param molarMassAvgFixedPartial Fixed partial component of the molar mass
+ * @param xSumSubstitutionalFixedPartial Fixed partial component of the fraction of substitutional elements
+ */
+template <typename Accessor, typename Partition, typename Scalar>
+inline void UpdateFractionsUFixed(Accessor& el, const Partition& p, Scalar& molarMassAvg,
+    Scalar molarMassAvgFixedPartial, Scalar xSumSubstitutionalFixedPartial)
+{
+    Scalar MMajor = el.MolarMass(p.Major);
+    Scalar xMSumProduct = 0;
+    Scalar xSumSubstitutional = xSumSubstitutionalFixedPartial;
+    Scalar xSumAlloying = 0;
+    int notUpdatedCounterInterstitial = 0;
+    int notUpdatedCounterSubstitutional = 0;
+
+    // Loop through variable interstitial elements to compute the the partial sum xMSumProduct
+    // used for determining average molar mass
+    for (auto h : p.VariableInterstitial) {
+        if (!el.IsUpdated(h)) {
+            notUpdatedCounterInterstitial++;
+        }
+        xSumSubstitutional -= el.X(h);
+        xMSumProduct += el.X(h) * (MMajor - el.MolarMass(h));
+    }
+
+    // Loop through variable substitutional elements to compute the partial sum xMSumProduct
+    // used for determining average molar mass
+    for (auto h : p.VariableSubstitutional) {
+        if (!el.IsUpdated(h)) {
+            xMSumProduct += el.X(h) * (MMajor - el.MolarMass(h));
+            notUpdatedCounterSubstitutional++;
+        } else {
+            xMSumProduct += xSumSubstitutional * el.U(h) * (MMajor - el.MolarMass(h));
+        }
+    }
+
+    // If the composition has not changed, there is nothing to do
+    if (notUpdatedCounterInterstitial + notUpdatedCounterSubstitutional == 0) {
+        return;
+    }
+
+    // Evaluates average molar mass
+    molarMassAvg = MMajor - xMSumProduct - xSumSubstitutional * molarMassAvgFixedPartial;
+
+    // If interstitial element fraction changed, then updates site fractions of variable interstitial elements
+    if (notUpdatedCounterInterstitial > 0) {
+        for (auto h : p.VariableInterstitial) {
+            if (!el.IsUpdated(h)) {
+                el.U(h) = el.X(h) / xSumSubstitutional;
+            }
+        }
+    }
+
+    // Updates site fractions of variable substitutional elements
+    for (auto h : p.VariableSubstitutional) {
+        if (!el.IsUpdated(h)) {
+            el.U(h) = el.X(h) / xSumSubstitutional;
+        }
+    }
+
+    // Updates mole and mass fractions of all alloying elements
+    for (auto h : p.Alloying) {
+        if (notUpdatedCounterInterstitial > 0) {
+            if (el.IsUpdated(h))
+                el.X(h) = el.U(h) * xSumSubstitutional;
+            else
+                el.IsUpdated(h) = true;
+        }
+        el.W(h) = el.X(h) * el.MolarMass(h) / molarMassAvg;
+        xSumAlloying += el.X(h);
+    }
+
+    el.X(p.Major) = Scalar(1) - xSumAlloying;
+    el.W(p.Major) = el.X(p.Major) * MMajor / molarMassAvg;
+    el.U(p.Major) = el.X(p.Major) / xSumSubstitutional;
+}
+
+/** @brief Computes the Jacobians of the fractions of an updated composition
+ * with respect to the fractions of its independent elements
+ *
+ * The independent elements (the columns of the Jacobians, jac.Columns) are
+ * the alloying elements if the composition is unlocked, and the variable
+ * elements if it is locked, in which case the site fractions of the fixed
+ * elements are constant (see UpdateFractionsUFixed). With M the molar masses,
+ * S the fraction of substitutional elements and F the sum of the site
+ * fractions of the fixed elements (zero if unlocked), the derivatives of the
+ * mole fractions are dX_j/dX_i = 1 if j = i, 0 for the other independent
+ * elements, -1 - F*dS/dX_i for the major element and U_j*dS/dX_i for the
+ * fixed elements, from which:
+ * - dW_j/dX_i = (M_j*dX_j/dX_i - W_j*dMolarMassAvg/dX_i)/molarMassAvg
+ * - dU_j/dX_i = (dX_j/dX_i - U_j*dS/dX_i)/S
+ * - dX_j/dW_i follows from the inverse of dW/dX restricted to the
+ *   independent elements, which is a diagonal matrix plus a rank one matrix
+ *   (Sherman-Morrison formula)
+ *
+ * @param el Accessor to the element data (only MolarMass, X, W and U are used)
+ * @param p Partition of the elements
+ * @param isLocked If the composition is locked
+ * @param molarMassAvg Average molar mass
+ * @param molarMassAvgFixedPartial Fixed partial component of the molar mass (used if locked)
+ * @param xSumSubstitutionalFixedPartial Fixed partial component of the fraction of substitutional elements (used if locked)
+ * @param jac The Jacobians (see CompositionJacobian), whose columns and sizes are already set (output)
+ */
+template <typename Accessor, typename Partition, typename Jacobian>
+inline void Jacobians(Accessor& el, const Partition& p, bool isLocked, double molarMassAvg,
+    double molarMassAvgFixedPartial, double xSumSubstitutionalFixedPartial, Jacobian& jac)
+{
+    const size_t m = jac.Columns.size();
+    double MMajor = el.MolarMass(p.Major);
+
+    // Fraction of substitutional elements, as in UpdateFractions and UpdateFractionsUFixed
+    double xSumSubstitutional = 1.0;
+    double uSumFixed = 0.0;
+    if (!isLocked) {
+        for (auto h : p.Interstitial) {
+            xSumSubstitutional -= el.X(h);
+        }
+    } else {
+        xSumSubstitutional = xSumSubstitutionalFixedPartial;
+        for (auto h : p.VariableInterstitial) {
+            xSumSubstitutional -= el.X(h);
+        }
+        for (auto h : p.Fixed) {
+            uSumFixed += el.U(h);
+        }
+    }
+
+    // Derivatives of xSumSubstitutional and molarMassAvg
+    double c = 1.0;
+    for (size_t i = 0; i < m; i++) {
+        size_t h = jac.Columns[i];
+        bool isInterstitial = false;
+        for (auto k : p.Interstitial) {
+            isInterstitial = isInterstitial || k == h;
+        }
+        double dS = isInterstitial ? -1.0 : 0.0;
+        jac.dXSumSubstitutionaldX[i] = dS;
+        jac.dMolarMassAvgdX[i] = el.MolarMass(h) - MMajor - (isLocked ? dS * molarMassAvgFixedPartial : 0.0);
+        c -= jac.dMolarMassAvgdX[i] * el.X(h) / molarMassAvg;
+    }
+
+    size_t column = 0;
+    for (size_t j = 0; j < jac.NumberOfElements; j++) {
+        bool isIndependent = column < m && jac.Columns[column] == j;
+        bool isMajor = j == p.Major;
+
+        // Sum over the independent elements k of dX_j/dX_k*X_k
+        double xSumProduct = 0.0;
+        for (size_t k = 0; k < m; k++) {
+            double dX = isIndependent ? (k == column ? 1.0 : 0.0)
+                                      : (isMajor ? -1.0 - uSumFixed * jac.dXSumSubstitutionaldX[k] : el.U(j) * jac.dXSumSubstitutionaldX[k]);
+            xSumProduct += dX * el.X(jac.Columns[k]);
+        }
+
+        double* dWdX = &jac.dWdX[j * m];
+        double* dXdW = &jac.dXdW[j * m];
+        double* dUdX = &jac.dUdX[j * m];
+        for (size_t i = 0; i < m; i++) {
+            double dS = jac.dXSumSubstitutionaldX[i];
+            double dM = jac.dMolarMassAvgdX[i];
+            double Mi = el.MolarMass(jac.Columns[i]);
+            double dX = isIndependent ? (i == column ? 1.0 : 0.0)
+                                      : (isMajor ? -1.0 - uSumFixed * dS : el.U(j) * dS);
+
+            dWdX[i] = (el.MolarMass(j) * dX - el.W(j) * dM) / molarMassAvg;
+            dUdX[i] = (dX - el.U(j) * dS) / xSumSubstitutional;
+            dXdW[i] = dX * molarMassAvg / Mi + xSumProduct * dM / (Mi * c);
+        }
+
+        if (isIndependent)
+            column++;
+    }
+}
+
+} // namespace CompositionKernels
+
+#endif
@@ -0,0 +1,209 @@
+/// @file composition_of.hpp
+
+#ifndef COMPOSITION_OF_H
+#define COMPOSITION_OF_H
+
+#include "composition.hpp"
+#include <utility>
+
+/// Specifications of the elements of CompositionOf
+namespace ElementSpecs {
+
+/// Tag for elements whose composition can be changed even when the composition is locked
+struct Variable {
+    static constexpr bool IsVariable = true;
+};
+
+/// Tag for elements whose site fraction is kept fixed when the composition is locked
+struct Fixed {
+    static constexpr bool IsVariable = false;
+};
+
+/** @brief Specification of an element of CompositionOf
+ *
+ * @tparam E The element from the periodic table (see the PeriodicTable namespace)
+ * @tparam isVariable, isInterstitial, isMajor Flags of the element (see ElementData constructor)
+ */
+template <const PeriodicTable::Element& E, bool isVariable, bool isInterstitial, bool isMajor>
+struct Spec {
+    static constexpr const PeriodicTable::Element& Element = E; ///< The element
+    static constexpr ElementFlags Flags { isVariable, isInterstitial, isMajor }; ///< Flags of the element
+};
+
+/// Major element (e.g., Fe)
+template <const PeriodicTable::Element& E>
+using Major = Spec<E, false, false, true>;
+
+/// Interstitial element, fixed by default
+template <const PeriodicTable::Element& E, typename V = Fixed>
+using Interstitial = Spec<E, V::IsVariable, true, false>;
+
+/// Substitutional element, fixed by default
+template <const PeriodicTable::Element& E, typename V = Fixed>
+using Substitutional = Spec<E, V::IsVariable, false, false>;
+
+} // namespace ElementSpecs
+
+template <typename... Specs>
+class CompositionOf;
+
+/** @brief Storage of the elements of CompositionOf
+ *
+ * Each level of the hierarchy holds one element, so that the elements are
+ * members of classes derived from CompositionBase and can be addressed by
+ * ElementMember, as the named members of the classes made with
+ * MAKE_COMPOSITION_CLASS.
+ */
+template <size_t I, typename... Specs>
+class CompositionOfStorage;
+
+/// Last level of CompositionOfStorage
+template <size_t I>
+class CompositionOfStorage<I> : public Composition {
+};
+
+/// Level of CompositionOfStorage holding the element with index I
+template <size_t I, typename S, typename... Rest>
+class CompositionOfStorage<I, S, Rest...> : public CompositionOfStorage<I + 1, Rest...> {
+private:
+    ElementData mvElement = ElementData(S::Element, S::Flags.IsVariable, S::Flags.IsInterstitial, S::Flags.IsMajor); ///< The element
+
+protected:
+    /// Member pointer to the element with index J
+    template <size_t J>
+    static constexpr ElementMember elementMember()
+    {
+        if constexpr (J == I) {
+            return static_cast<ElementMember>(&CompositionOfStorage::mvElement);
+        } else {
+            return CompositionOfStorage<I + 1, Rest...>::template elementMember<J>();
+        }
+    }
+};
+
+/** @brief Composition class for a set of elements given as template arguments
+ *
+ * Template alternative to MAKE_COMPOSITION_CLASS. The elements are given by
+ * their specifications (see the ElementSpecs namespace):
+ *
+ * @code{.cpp}
+ * using namespace ElementSpecs;
+ * typedef CompositionOf<Major<PeriodicTable::Fe>,
+ *     Interstitial<PeriodicTable::C, Variable>,
+ *     Substitutional<PeriodicTable::Mn, Variable>,
+ *     Substitutional<PeriodicTable::Si>>
+ *     CompositionSteel;
+ *
+ * CompositionSteel comp;
+ * comp.Get<PeriodicTable::C>().SetW(1e-3);
+ * comp.UpdateFractions();
+ * @endcode
+ *
+ * The partition of the elements (major, interstitial/substitutional,
+ * fixed/variable elements) is computed at compile time (see StaticPartition).
+ * Sets with no or more than one major element, or with repeated elements, do
+ * not compile. UpdateFractions runs the same algorithms as Composition (see
+ * CompositionKernels) over loops with constant trip counts and indices, so
+ * the compiler can fully unroll and inline them, and the results are
+ * identical to the ones of the equivalent class made with
+ * MAKE_COMPOSITION_CLASS.
+ */
+template <typename... Specs>
+class CompositionOf : public CompositionOfStorage<0, Specs...> {
+public:
+    /// Number of elements
+    static constexpr size_t NumberOfElements = sizeof...(Specs);
+
+private:
+    typedef CompositionOfStorage<0, Specs...> Storage;
+    friend class Composition;
+    template <typename T>
+    friend struct StaticPartition;
+
+    /// Flags of the elements, from which StaticPartition is computed at compile time
+    static constexpr std::array<ElementFlags, NumberOfElements> elementFlags()
+    {
+        return { { Specs::Flags... } };
+    }
+
+    /// Molar masses of the elements, folded into constants by updateFractionsStatic
+    static constexpr std::array<double, NumberOfElements> elementMolarMasses()
+    {
+        return { { Specs::Element.MolarMass... } };
+    }
+
+    template <size_t... I>
+    static constexpr std::array<ElementMember, NumberOfElements> makeElementMembers(std::index_sequence<I...>)
+    {
+        return { { Storage::template elementMember<I>()... } };
+    }
+
+    /// Member pointers to the elements, built at compile time
+    static const std::array<ElementMember, NumberOfElements>& elementMembers()
+    {
+        static constexpr std::array<ElementMember, NumberOfElements> members = makeElementMembers(std::index_sequence_for<Specs...>());
+        return members;
+    }
+
+    /// Perfect hash table of the element symbols, built at compile time
+    static const ElementSymbolTable& symbolTable()
+    {
+        static constexpr const char* symbols[] = { Specs::Element.Symbol.data()... };
+        static constexpr ElementSymbolTable table = MakeElementSymbolTable(symbols);
+        return table;
+    }
+
+    /// Whether an element is repeated in Specs
+    static constexpr bool hasRepeatedElements()
+    {
+        const unsigned int atomicNumbers[] = { Specs::Element.AtomicNumber... };
+        for (size_t i = 0; i < NumberOfElements; i++) {
+            for (size_t j = i + 1; j < NumberOfElements; j++) {
+                if (atomicNumbers[i] == atomicNumbers[j])
+                    return true;
+            }
+        }
+        return false;
+    }
+
+public:
+    /// Constructor
+    CompositionOf()
+    {
+        static_assert(!hasRepeatedElements(), "Repeated elements defined");
+        static const CompositionLayout layout(StaticPartition<CompositionOf>(), elementMembers(), symbolTable());
+        this->setLayout(layout);
+    }
+
+    /// Index of element E, resolved at compile time
+    template <const PeriodicTable::Element& E>
+    static constexpr size_t IndexOf()
+    {
+        const unsigned int atomicNumbers[] = { Specs::Element.AtomicNumber... };
+        for (size_t i = 0; i < NumberOfElements; i++) {
+            if (atomicNumbers[i] == E.AtomicNumber)
+                return i;
+        }
+        return NumberOfElements;
+    }
+
+    /// Accesses element E, resolved at compile time
+    template <const PeriodicTable::Element& E>
+    ElementData& Get()
+    {
+        static_assert(IndexOf<E>() < NumberOfElements, "Element is not defined");
+        return this->*elementMembers()[IndexOf<E>()];
+    }
+    /// Accesses const element E, resolved at compile time
+    template <const PeriodicTable::Element& E>
+    const ElementData& Get() const
+    {
+        static_assert(IndexOf<E>() < NumberOfElements, "Element is not defined");
+        return this->*elementMembers()[IndexOf<E>()];
+    }
+
+    /// Updates fractions, unrolled over the partition computed at compile time
+    void UpdateFractions() { this->template updateFractionsStatic<CompositionOf>(); }
+};
+
+#endif
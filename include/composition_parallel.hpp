@@ -0,0 +1,139 @@
+/// @file composition_parallel.hpp
+
+#ifndef COMPOSITION_PARALLEL_H
+#define COMPOSITION_PARALLEL_H
+
+#include "composition_batch.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** @brief Interface of the executors running the tasks of ConvertParallel
+ *
+ * Callers can pass their own implementation (e.g., wrapping the thread pool
+ * of their application) in ParallelOptions.
+ */
+class Executor {
+public:
+    /// Destructor
+    virtual ~Executor() = default;
+
+    /** @brief Runs task(i) for all i in [0, count) and returns when all of
+     * them are finished. The tasks are independent and can run concurrently
+     *
+     * @param count Number of tasks
+     * @param task The task
+     */
+    virtual void Run(size_t count, const std::function<void(size_t)>& task) = 0;
+};
+
+/// Executor running all tasks in the calling thread
+class SequentialExecutor : public Executor {
+public:
+    void Run(size_t count, const std::function<void(size_t)>& task) override;
+};
+
+/** @brief Thread pool with work stealing
+ *
+ * The tasks of a Run are split into contiguous ranges, one per thread (the
+ * workers and the calling thread). Each thread runs the tasks of its own
+ * range from the front, and when it is exhausted, steals the back half of the
+ * range of another thread. This balances the load when the tasks have
+ * uneven costs, while keeping neighbouring tasks in the same thread.
+ *
+ * Concurrent calls to Run from different threads are serialized. Calls to Run
+ * from inside a task run sequentially in the calling thread. If tasks throw,
+ * the first exception is rethrown by Run once all tasks are finished.
+ */
+class WorkStealingThreadPool : public Executor {
+private:
+    /// Range of tasks owned by a thread
+    struct Slot {
+        std::mutex Mutex; ///< Protects the range
+        size_t Begin = 0; ///< First task of the range
+        size_t End = 0; ///< One past the last task of the range
+    };
+
+    std::vector<std::thread> mvWorkers; ///< Worker threads
+    std::unique_ptr<Slot[]> mvpSlots; ///< Ranges of the workers and of the calling thread (last one)
+    size_t mvNumberOfSlots = 0; ///< Number of slots
+
+    std::mutex mvRunMutex; ///< Serializes the calls to Run
+    std::mutex mvMutex; ///< Protects the members below
+    std::condition_variable mvCondition; ///< Notifies new runs and their completion
+    const std::function<void(size_t)>* mvpTask = nullptr; ///< Task of the current run
+    size_t mvGeneration = 0; ///< Incremented at each run
+    std::atomic<size_t> mvRemaining { 0 }; ///< Number of tasks not finished in the current run
+    size_t mvActiveWorkers = 0; ///< Number of workers working on the current run
+    std::exception_ptr mvException; ///< First exception thrown by a task of the current run
+    bool mvIsStopping = false; ///< If the workers must exit
+
+    bool popTask(size_t slot, size_t& task);
+    bool stealTask(size_t slot, size_t& task);
+    void work(size_t slot);
+    void workerLoop(size_t slot);
+
+public:
+    explicit WorkStealingThreadPool(size_t numberOfThreads = 0);
+    ~WorkStealingThreadPool() override;
+
+    WorkStealingThreadPool(const WorkStealingThreadPool&) = delete;
+    WorkStealingThreadPool& operator=(const WorkStealingThreadPool&) = delete;
+
+    /// Number of threads running the tasks, including the calling thread
+    size_t GetNumberOfThreads() const { return mvNumberOfSlots; }
+
+    void Run(size_t count, const std::function<void(size_t)>& task) override;
+
+    static WorkStealingThreadPool& Default();
+};
+
+/// Options of ConvertParallel
+struct ParallelOptions {
+    Executor* pExecutor = nullptr; ///< Executor running the tasks (WorkStealingThreadPool::Default() if nullptr)
+    size_t GrainSize = 1024; ///< Number of compositions (rows) converted by each task
+};
+
+/** @brief Updates the fractions of a range of compositions in parallel
+ *
+ * Calls UpdateFractions() of every composition of the range, so it works
+ * with any composition class (e.g., the ones made with
+ * MAKE_COMPOSITION_CLASS, CompositionOf and DynamicComposition), locked or
+ * unlocked. Each composition is updated by a single task, so the results are
+ * identical to the sequential loop, regardless of the number of threads.
+ *
+ * @param range Random access range of compositions (e.g., std::vector)
+ * @param options The options
+ */
+template <typename Range>
+void ConvertParallel(Range& range, const ParallelOptions& options = ParallelOptions())
+{
+    auto first = std::begin(range);
+    size_t size = std::end(range) - first;
+    size_t grainSize = std::max<size_t>(options.GrainSize, 1);
+    Executor& executor = options.pExecutor != nullptr ? *options.pExecutor : WorkStealingThreadPool::Default();
+
+    executor.Run((size + grainSize - 1) / grainSize, [&](size_t t) {
+        size_t end = std::min(size, (t + 1) * grainSize);
+        for (size_t i = t * grainSize; i < end; i++) {
+            first[i].UpdateFractions();
+        }
+    });
+}
+
+template <typename Scalar>
+void ConvertParallel(ScalarCompositionBatch<Scalar>& batch, const ParallelOptions& options = ParallelOptions());
+
+extern template void ConvertParallel(ScalarCompositionBatch<float>&, const ParallelOptions&);
+extern template void ConvertParallel(ScalarCompositionBatch<double>&, const ParallelOptions&);
+extern template void ConvertParallel(ScalarCompositionBatch<long double>&, const ParallelOptions&);
+
+#endif
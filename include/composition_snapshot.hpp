@@ -0,0 +1,118 @@
+/// @file composition_snapshot.hpp
+
+#ifndef COMPOSITION_SNAPSHOT_H
+#define COMPOSITION_SNAPSHOT_H
+
+#include "composition.hpp"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+/** @brief Immutable copy of the fractions of a Composition
+ *
+ * Holds the mole, mass and site fractions of all elements and the average
+ * molar mass, in a single allocation. Since a snapshot never changes after
+ * construction, it can be read concurrently from any number of threads
+ * without synchronization, while the composition it was taken from keeps
+ * being changed (see CompositionPublisher).
+ */
+class CompositionSnapshot {
+private:
+    size_t mvNumberOfElements = 0; ///< Number of elements
+    size_t mvMajor = 0; ///< Index of the major element
+    const ElementSymbolTable* mvpSymbolTable = nullptr; ///< Perfect hash table of the element symbols (see CompositionLayout)
+    bool mvIsCompositionLocked = false; ///< If the composition was locked
+    double mvMolarMassAvg = 0.0; ///< Average molar mass
+    unsigned long long mvSequence = 0; ///< Sequence number given by the publisher
+    std::unique_ptr<const char*[]> mvpSymbols; ///< Symbols of the elements
+    std::unique_ptr<double[]> mvpFractions; ///< Mole, mass and site fractions, one block of elements each
+
+public:
+    explicit CompositionSnapshot(const Composition& comp, unsigned long long sequence = 0);
+
+    CompositionSnapshot(const CompositionSnapshot&) = delete;
+    CompositionSnapshot& operator=(const CompositionSnapshot&) = delete;
+
+    /// @name Element definitions
+    /// @{
+    /// Number of elements
+    size_t GetNumberOfElements() const { return mvNumberOfElements; }
+    /// Index of the major element
+    size_t GetMajorElementIndex() const { return mvMajor; }
+    /// Symbol of an element
+    const char* GetSymbol(size_t element) const { return mvpSymbols[element]; }
+    size_t FindElementIndex(std::string_view elementSymbol) const noexcept;
+    size_t GetElementIndex(std::string_view elementSymbol) const;
+    /// @}
+
+    /// @name Getters
+    /// @{
+    /// Get mole fraction
+    double GetX(size_t element) const { return mvpFractions[element]; }
+    /// Get weight fraction
+    double GetW(size_t element) const { return mvpFractions[mvNumberOfElements + element]; }
+    /// Get U-fraction (site fraction)
+    double GetU(size_t element) const { return mvpFractions[2 * mvNumberOfElements + element]; }
+    /// Get average molar mass
+    double GetMolarMassAvg() const { return mvMolarMassAvg; }
+    /// Returns if the composition was locked
+    bool IsCompositionLocked() const { return mvIsCompositionLocked; }
+    /// Sequence number given by the publisher (see CompositionPublisher), 0 otherwise
+    unsigned long long GetSequence() const { return mvSequence; }
+    /// @}
+};
+
+/** @brief Publishes snapshots of a composition to reader threads
+ *
+ * The writer (e.g., a solver thread) calls Publish after updating the
+ * composition, which takes a snapshot and swaps it in atomically. Readers
+ * (e.g., reporting or checkpointing threads) call Load and get the latest
+ * snapshot, whose values are consistent with each other. A reader keeps its
+ * snapshot alive for as long as it holds the returned pointer, regardless of
+ * later publications, and never waits for the writer to finish a conversion.
+ *
+ * @code{.cpp}
+ * // Writer
+ * comp.UpdateFractions();
+ * publisher.Publish(comp);
+ * // Readers
+ * std::shared_ptr<const CompositionSnapshot> pSnapshot = publisher.Load();
+ * double xC = pSnapshot->GetX(iC);
+ * @endcode
+ *
+ * The snapshots are published RCU-style into a few slots, without locks.
+ * Load finds the current slot and copies its pointer; it is lock-free, and
+ * only retries if a publication moved the current slot while it was
+ * copying. Publish writes the new snapshot into a slot that no reader is
+ * copying from and then makes it current, so it only waits if readers are
+ * copying from all the other slots. Publish must be called from one thread
+ * at a time.
+ */
+class CompositionPublisher {
+private:
+    /// Number of slots. Publish reuses a slot once no reader copies from it
+    static constexpr size_t NumberOfSlots = 4;
+
+    /// Slot of a published snapshot, on its own cache line
+    struct alignas(64) Slot {
+        std::shared_ptr<const CompositionSnapshot> Snapshot; ///< Only written by Publish while the slot is not current and has no readers
+        mutable std::atomic<unsigned> Readers { 0 }; ///< Number of readers copying the snapshot
+    };
+
+    Slot mvSlots[NumberOfSlots]; ///< Slots of the latest snapshots
+    std::atomic<size_t> mvCurrent { 0 }; ///< Slot of the latest snapshot
+    unsigned long long mvSequence = 0; ///< Sequence number of the latest snapshot
+
+public:
+    /// Default constructor. Load returns nullptr until the first publication
+    CompositionPublisher() = default;
+
+    CompositionPublisher(const CompositionPublisher&) = delete;
+    CompositionPublisher& operator=(const CompositionPublisher&) = delete;
+
+    std::shared_ptr<const CompositionSnapshot> Publish(const Composition& comp);
+    std::shared_ptr<const CompositionSnapshot> Load() const noexcept;
+};
+
+#endif
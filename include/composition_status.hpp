@@ -0,0 +1,64 @@
+/// @file composition_status.hpp
+
+#ifndef COMPOSITION_STATUS_H
+#define COMPOSITION_STATUS_H
+
+#include <atomic>
+#include <cstddef>
+
+/** @brief Status codes returned by the noexcept variants of the setters
+ * (e.g., ElementData::TrySetX), which never print
+ */
+enum class CompositionStatus : unsigned char {
+    Ok, ///< No error
+    MajorElement, ///< Fractions of the major element cannot be set
+    LockedElement, ///< Fractions of fixed elements cannot be set when the composition is locked
+    LockedMassFraction, ///< Mass fractions cannot be set when the composition is locked
+    InvalidArgument, ///< Argument not supported by the function
+    NotConverged, ///< Iterative solver stopped before reaching its solution
+};
+
+/// Number of values of CompositionStatus
+constexpr size_t CompositionStatusCount = 6;
+
+const char* GetStatusMessage(CompositionStatus status) noexcept;
+
+/** @brief Counters of the errors reported by the setters, one per status
+ *
+ * The counters are incremented with relaxed atomic operations, so the same
+ * counters can be shared by compositions used in different threads.
+ */
+struct CompositionErrorCounters {
+    std::atomic<unsigned long long> Counts[CompositionStatusCount] {}; ///< Number of errors per status
+
+    /// Number of errors with the status
+    unsigned long long Get(CompositionStatus status) const noexcept
+    {
+        return Counts[static_cast<size_t>(status)].load(std::memory_order_relaxed);
+    }
+
+    unsigned long long Total() const noexcept;
+    void Reset() noexcept;
+};
+
+/** @brief Opt-in error reporting shared by all compositions
+ *
+ * By default, errors are only returned as status codes by the noexcept
+ * setters (and printed by the legacy setters). Error counters and a
+ * diagnostic callback can be registered to aggregate them, e.g., after a hot
+ * loop. Both are global; register them before starting the threads using the
+ * compositions. SetCallback must not be called concurrently with the setters,
+ * which could otherwise mix up the old and new callback and user data.
+ */
+namespace CompositionDiagnostics {
+/// Diagnostic callback. Receives the status, the symbol of the element (or
+/// nullptr) and the user data. Must not throw
+typedef void (*Callback)(CompositionStatus status, const char* symbol, void* userData);
+
+void SetErrorCounters(CompositionErrorCounters* pCounters) noexcept;
+void SetCallback(Callback callback, void* userData = nullptr) noexcept;
+CompositionStatus Report(CompositionStatus status, const char* symbol) noexcept;
+void PrintSetError(CompositionStatus status, char fraction, const char* symbol, const char* className);
+}
+
+#endif
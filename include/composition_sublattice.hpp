@@ -0,0 +1,97 @@
+/// @file composition_sublattice.hpp
+
+#ifndef COMPOSITION_SUBLATTICE_H
+#define COMPOSITION_SUBLATTICE_H
+
+#include "composition.hpp"
+#include "composition_batch.hpp"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/** @brief Sublattice model of a phase, which converts the fractions of
+ * compositions into site fractions
+ *
+ * The site fractions U of the compositions assume two sublattices with one
+ * site each, one with the substitutional elements and the other with the
+ * interstitial elements and vacancies. CALPHAD models of phases often have
+ * other sublattices and site ratios, e.g., (Fe,Mn,Cr)_1(C,N,Va)_3 for
+ * ferrite or (Fe,Mn,Cr)_3(C)_1 for cementite. Each element is on one
+ * sublattice \f$s\f$ with \f$a_s\f$ sites per formula unit. The sublattice
+ * of the major element, the reference sublattice \f$r\f$, is fully occupied
+ * by its elements, so the site fraction of an element \f$e\f$ is
+ *
+ * \f[ y_e = \frac{a_r}{a_s} \frac{x_e}{\sum_{j \in r} x_j}
+ *         = \frac{a_r}{a_s} \frac{u_e}{\sum_{j \in r} u_j} \f]
+ *
+ * and the site fraction of the vacancies of a sublattice is
+ * \f$1 - \sum_{e \in s} y_e\f$. The site fractions of sublattices without
+ * vacancies only add up to one if the composition respects the
+ * stoichiometry of the phase.
+ *
+ * The site fractions are computed from the site fractions U of the
+ * compositions, already converted (see Composition::UpdateFractions and
+ * CompositionBatch::UpdateFractions). If the reference sublattice has all
+ * the substitutional elements, as in most models, the denominator is one
+ * and each site fraction is a single product. A CompositionField with a
+ * sublattice model writes these site fractions into its U outputs.
+ *
+ * @code{.cpp}
+ * CompositionSublattices ferrite(prototype, { { 1.0, { "Fe", "Mn", "Si", "Cr" } }, { 3.0, { "C", "N", "Va" } } });
+ * std::vector<double> y(ferrite.NumberOfElements()), va(ferrite.NumberOfSublattices());
+ * ferrite.GetSiteFractions(comp, y.data(), va.data());
+ * @endcode
+ */
+class CompositionSublattices {
+public:
+    /// Symbol of the vacancies in the constituents of a sublattice
+    static constexpr const char* VacancySymbol = "Va";
+
+    /// Sublattice of a model
+    struct Sublattice {
+        double Sites; ///< Number of sites per formula unit
+        std::vector<std::string> Constituents; ///< Symbols of the elements, and VacancySymbol if it has vacancies
+    };
+
+private:
+    CompositionBatch mvElements; ///< Element definitions of the prototype, without rows
+    std::vector<size_t> mvElementSublattice; ///< Sublattice of each element
+    std::vector<double> mvFactors; ///< Ratio of the sites of the reference sublattice to those of the sublattice of each element
+    std::vector<double> mvSites; ///< Sites of each sublattice
+    std::vector<bool> mvHasVacancies; ///< If each sublattice has vacancies
+    std::vector<std::vector<size_t>> mvMembers; ///< Elements of each sublattice
+    size_t mvMajor; ///< Index of the major element
+    size_t mvReference; ///< Index of the reference sublattice
+    bool mvIsReferenceSubstitutional; ///< If the reference sublattice has exactly the substitutional elements
+
+    void checkComposition(const Composition& comp) const;
+
+public:
+    CompositionSublattices(const Composition& prototype, const std::vector<Sublattice>& sublattices);
+
+    static CompositionSublattices TwoSublattices(const Composition& prototype, double substitutionalSites = 1.0,
+        double interstitialSites = 1.0);
+
+    /// Number of elements
+    size_t NumberOfElements() const { return mvElements.NumberOfElements(); }
+    /// Number of sublattices
+    size_t NumberOfSublattices() const { return mvSites.size(); }
+    /// Symbol of an element
+    const std::string& GetSymbol(size_t element) const { return mvElements.GetSymbol(element); }
+    /// Sublattice of an element
+    size_t GetSublattice(size_t element) const { return mvElementSublattice[element]; }
+    /// Number of sites per formula unit of a sublattice
+    double GetSites(size_t sublattice) const { return mvSites[sublattice]; }
+    /// If a sublattice has vacancies
+    bool HasVacancies(size_t sublattice) const { return mvHasVacancies[sublattice]; }
+    /// Index of the reference sublattice, which has the major element
+    size_t GetReferenceSublattice() const { return mvReference; }
+
+    bool HasSameElements(const CompositionBatch& batch) const;
+
+    void GetSiteFractions(const Composition& comp, double* siteFractions, double* vacancies = nullptr) const;
+    void GetSiteFractions(const CompositionBatch& batch, size_t beginRow, size_t endRow, double* siteFractions,
+        double* vacancies = nullptr) const;
+};
+
+#endif
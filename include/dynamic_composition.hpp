@@ -0,0 +1,122 @@
+/// @file dynamic_composition.hpp
+
+#ifndef DYNAMIC_COMPOSITION_H
+#define DYNAMIC_COMPOSITION_H
+
+#include "composition.hpp"
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// Definition of an element of a DynamicComposition. The flags follow the
+/// constructor of ElementData
+struct ElementDefinition {
+    std::string Symbol; ///< The element symbol (case insensitive), looked up in the PeriodicTable
+    bool IsVariable = false; ///< If composition of element can be changed when the composition is locked
+    bool IsInterstitial = false; ///< True if it is interstitial element, false if it is substitutional
+    bool IsMajor = false; ///< If it is the major element
+};
+
+/** @brief Composition whose elements are defined at runtime
+ *
+ * Alternative to the classes made with MAKE_COMPOSITION_CLASS for element
+ * sets that are only known at runtime (e.g., read from configuration files).
+ * The element data is stored in flat contiguous arrays, one per property,
+ * and the elements are addressed by their index, i.e., the order in which
+ * they are defined. The conversions run the same algorithms as Composition
+ * (see CompositionKernels), giving identical results.
+ *
+ * @code{.cpp}
+ * DynamicComposition comp({ { "Fe", false, false, true }, { "C", true, true }, { "Mn", true } });
+ * size_t iC = comp.GetElementIndex("C");
+ * comp.SetW(iC, 1e-3);
+ * comp.UpdateFractions();
+ * double xC = comp.GetX(iC);
+ * @endcode
+ */
+class DynamicComposition {
+private:
+    struct Accessor;
+
+    bool mvIsCompositionLocked = false; ///< If true, only the fractions of the variable elements can be changed
+    double mvMolarMassAvg = 0.0; ///< Average molar mass
+    double mvMolarMassAvgFixedPartial = 0.0; ///< Fixed partial component of the molar mass
+    double mvXSumSubstitutionalFixedPartial = 0.0; ///< Fixed partial component of the fraction of substitutional elements
+
+    std::vector<const char*> mvSymbols; ///< Symbols of the elements
+    std::vector<ElementFlags> mvFlags; ///< Flags of the elements
+    std::vector<double> mvMolarMasses; ///< Molar masses of the elements
+    ElementPartition mvPartition; ///< Partition of the elements
+    ElementSymbolTable mvSymbolTable {}; ///< Perfect hash table of the element symbols
+
+    std::vector<double> mvUserX; ///< User defined mole fractions
+    std::vector<double> mvUserW; ///< User defined mass fractions
+    std::vector<double> mvX; ///< Calculated mole fractions
+    std::vector<double> mvW; ///< Calculated mass fractions
+    std::vector<double> mvU; ///< Calculated site fractions
+    std::vector<unsigned char> mvIsUpdated; ///< If the fractions are updated
+
+    CompositionStatus checkSetX(size_t element) const noexcept;
+    CompositionStatus checkSetW(size_t element) const noexcept;
+    void updateFractions();
+    void updateFractionsUFixed();
+
+public:
+    explicit DynamicComposition(const std::vector<ElementDefinition>& elements);
+
+    /// @name Element definitions
+    /// @{
+    /// Number of defined elements
+    size_t GetNumberOfElements() const { return mvSymbols.size(); }
+    /// Partition of the elements
+    const ElementPartition& GetPartition() const { return mvPartition; }
+    /// Index of the major element
+    size_t GetMajorElementIndex() const { return mvPartition.Major; }
+    /// Symbol of the major element
+    const char* GetMajorElementSymbol() const { return mvSymbols[mvPartition.Major]; }
+    size_t FindElementIndex(std::string_view elementSymbol) const noexcept;
+    size_t GetElementIndex(std::string_view elementSymbol) const;
+    /// Symbol of an element
+    const char* GetSymbol(size_t element) const { return mvSymbols[element]; }
+    /// Molar mass of an element
+    double GetMolarMass(size_t element) const { return mvMolarMasses[element]; }
+    /// Whether an element is the major element
+    bool IsMajor(size_t element) const { return mvFlags[element].IsMajor; }
+    /// Whether an element is interstitial
+    bool IsInterstitial(size_t element) const { return mvFlags[element].IsInterstitial; }
+    /// Whether an element is variable
+    bool IsVariable(size_t element) const { return mvFlags[element].IsVariable; }
+    /// @}
+
+    /// @name Setters
+    /// @{
+    void SetX(size_t element, double x);
+    void SetW(size_t element, double w);
+    CompositionStatus TrySetX(size_t element, double x) noexcept;
+    CompositionStatus TrySetW(size_t element, double w) noexcept;
+    /// @}
+
+    /// @name Getters
+    /// @{
+    /// Get mole fraction
+    double GetX(size_t element) const { return mvX[element]; }
+    /// Get weight fraction
+    double GetW(size_t element) const { return mvW[element]; }
+    /// Get U-fraction (site fraction)
+    double GetU(size_t element) const { return mvU[element]; }
+    /// Get average molar mass
+    double GetMolarMassAvg() const { return mvMolarMassAvg; }
+    /// @}
+
+    /// Returns if composition is locked
+    bool IsCompositionLocked() const { return mvIsCompositionLocked; }
+
+    void LockComposition();
+    void UnlockComposition();
+    void UpdateFractions();
+    void Print(FILE* stream = stdout);
+    void Print(FILE* stream = stdout) const;
+};
+
+#endif
@@ -3,135 +3,221 @@
 #ifndef PERIODIC_TABLE_H
 #define PERIODIC_TABLE_H
 
-#include <string>
+#include <array>
+#include <cstddef>
+#include <string_view>
 
 namespace PeriodicTable {
-/// Simple struct to store an element basic data
+/// Number of possible symbol keys (see SymbolKey)
+constexpr size_t SymbolKeyCount = 26 * 27;
+
+/// Index of a letter in the alphabet (case insensitive), or -1 if it is not a letter
+constexpr int LetterIndex(char c)
+{
+    return (c >= 'a' && c <= 'z') ? c - 'a' : ((c >= 'A' && c <= 'Z') ? c - 'A' : -1);
+}
+
+/** @brief Perfect hash of element symbols
+ *
+ * Maps symbols of one or two letters (case insensitive) to unique keys in
+ * the range [0, SymbolKeyCount). Does not allocate and can be evaluated at
+ * compile time.
+ *
+ * @param symbol The element symbol
+ *
+ * @return The key, or SymbolKeyCount if symbol is not a valid symbol
+ */
+constexpr size_t SymbolKey(std::string_view symbol)
+{
+    if (symbol.empty() || symbol.size() > 2 || LetterIndex(symbol[0]) < 0)
+        return SymbolKeyCount;
+    if (symbol.size() == 1)
+        return LetterIndex(symbol[0]) * 27;
+    if (LetterIndex(symbol[1]) < 0)
+        return SymbolKeyCount;
+    return LetterIndex(symbol[0]) * 27 + LetterIndex(symbol[1]) + 1;
+}
+
+/** @brief Simple struct to store an element basic data
+ *
+ * It is a literal type, so the elements below are constants evaluated at
+ * compile time, shared by all translation units and without any dynamic
+ * initialization. Symbol and Name refer to null-terminated string literals.
+ */
 struct Element {
-    std::string Symbol; ///< The symbol
-    std::string Name; ///< The name
+    std::string_view Symbol; ///< The symbol
+    std::string_view Name; ///< The name
     unsigned int AtomicNumber; ///< The atomic number
     double MolarMass; ///< The molar mass
 };
 
-const Element H { "H", "Hydrogen", 1, 1.00794 };
-const Element He { "He", "Helium", 2, 4.002602 };
-const Element Li { "Li", "Lithium", 3, 6.941 };
-const Element Be { "Be", "Beryllium", 4, 9.012182 };
-const Element B { "B", "Boron", 5, 10.811 };
-const Element C { "C", "Carbon", 6, 12.0107 };
-const Element N { "N", "Nitrogen", 7, 14.0067 };
-const Element O { "O", "Oxygen", 8, 15.9994 };
-const Element F { "F", "Fluorine", 9, 18.9984032 };
-const Element Ne { "Ne", "Neon", 10, 20.1797 };
-const Element Na { "Na", "Sodium", 11, 22.98977 };
-const Element Mg { "Mg", "Magnesium", 12, 24.305 };
-const Element Al { "Al", "Aluminum", 13, 26.981538 };
-const Element Si { "Si", "Silicon", 14, 28.0855 };
-const Element P { "P", "Phosphorus", 15, 30.973761 };
-const Element S { "S", "Sulfur", 16, 32.065 };
-const Element Cl { "Cl", "Chlorine", 17, 35.453 };
-const Element Ar { "Ar", "Argon", 18, 39.948 };
-const Element K { "K", "Potassium", 19, 39.0983 };
-const Element Ca { "Ca", "Calcium", 20, 40.078 };
-const Element Sc { "Sc", "Scandium", 21, 44.95591 };
-const Element Ti { "Ti", "Titanium", 22, 47.867 };
-const Element V { "V", "Vanadium", 23, 50.9415 };
-const Element Cr { "Cr", "Chromium", 24, 51.9961 };
-const Element Mn { "Mn", "Manganese", 25, 54.938049 };
-const Element Fe { "Fe", "Iron", 26, 55.845 };
-const Element Co { "Co", "Cobalt", 27, 58.9332 };
-const Element Ni { "Ni", "Nickel", 28, 58.6934 };
-const Element Cu { "Cu", "Copper", 29, 63.546 };
-const Element Zn { "Zn", "Zinc", 30, 65.409 };
-const Element Ga { "Ga", "Gallium", 31, 69.723 };
-const Element Ge { "Ge", "Germanium", 32, 72.64 };
-const Element As { "As", "Arsenic", 33, 74.9216 };
-const Element Se { "Se", "Selenium", 34, 78.96 };
-const Element Br { "Br", "Bromine", 35, 79.904 };
-const Element Kr { "Kr", "Krypton", 36, 83.798 };
-const Element Rb { "Rb", "Rubidium", 37, 85.4678 };
-const Element Sr { "Sr", "Strontium", 38, 87.62 };
-const Element Y { "Y", "Yttrium", 39, 88.90585 };
-const Element Zr { "Zr", "Zirconium", 40, 91.224 };
-const Element Nb { "Nb", "Niobium", 41, 92.90638 };
-const Element Mo { "Mo", "Molybdenum", 42, 95.94 };
-const Element Tc { "Tc", "Technetium", 43, 98 };
-const Element Ru { "Ru", "Ruthenium", 44, 101.07 };
-const Element Rh { "Rh", "Rhodium", 45, 102.9055 };
-const Element Pd { "Pd", "Palladium", 46, 106.42 };
-const Element Ag { "Ag", "Silver", 47, 107.8682 };
-const Element Cd { "Cd", "Cadmium", 48, 112.411 };
-const Element In { "In", "Indium", 49, 114.818 };
-const Element Sn { "Sn", "Tin", 50, 118.71 };
-const Element Sb { "Sb", "Antimony", 51, 121.76 };
-const Element Te { "Te", "Tellurium", 52, 127.6 };
-const Element I { "I", "Iodine", 53, 126.90447 };
-const Element Xe { "Xe", "Xenon", 54, 131.293 };
-const Element Cs { "Cs", "Cesium", 55, 132.90545 };
-const Element Ba { "Ba", "Barium", 56, 137.327 };
-const Element La { "La", "Lanthanum", 57, 138.9055 };
-const Element Ce { "Ce", "Cerium", 58, 140.116 };
-const Element Pr { "Pr", "Praseodymium", 59, 140.90765 };
-const Element Nd { "Nd", "Neodymium", 60, 144.24 };
-const Element Pm { "Pm", "Promethium", 61, 145 };
-const Element Sm { "Sm", "Samarium", 62, 150.36 };
-const Element Eu { "Eu", "Europium", 63, 151.964 };
-const Element Gd { "Gd", "Gadolinium", 64, 157.25 };
-const Element Tb { "Tb", "Terbium", 65, 158.92534 };
-const Element Dy { "Dy", "Dysprosium", 66, 162.5 };
-const Element Ho { "Ho", "Holmium", 67, 164.93032 };
-const Element Er { "Er", "Erbium", 68, 167.259 };
-const Element Tm { "Tm", "Thulium", 69, 168.93421 };
-const Element Yb { "Yb", "Ytterbium", 70, 173.04 };
-const Element Lu { "Lu", "Lutetium", 71, 174.967 };
-const Element Hf { "Hf", "Hafnium", 72, 178.49 };
-const Element Ta { "Ta", "Tantalum", 73, 180.9479 };
-const Element W { "W", "Tungsten", 74, 183.84 };
-const Element Re { "Re", "Rhenium", 75, 186.207 };
-const Element Os { "Os", "Osmium", 76, 190.23 };
-const Element Ir { "Ir", "Iridium", 77, 192.217 };
-const Element Pt { "Pt", "Platinum", 78, 195.078 };
-const Element Au { "Au", "Gold", 79, 196.96655 };
-const Element Hg { "Hg", "Mercury", 80, 200.59 };
-const Element Tl { "Tl", "Thallium", 81, 204.3833 };
-const Element Pb { "Pb", "Lead", 82, 207.2 };
-const Element Bi { "Bi", "Bismuth", 83, 208.98038 };
-const Element Po { "Po", "Polonium", 84, 209 };
-const Element At { "At", "Astatine", 85, 210 };
-const Element Rn { "Rn", "Radon", 86, 222 };
-const Element Fr { "Fr", "Francium", 87, 223 };
-const Element Ra { "Ra", "Radium", 88, 226 };
-const Element Ac { "Ac", "Actinium", 89, 227 };
-const Element Th { "Th", "Thorium", 90, 232.0381 };
-const Element Pa { "Pa", "Protactinium", 91, 231.03588 };
-const Element U { "U", "Uranium", 92, 238.02891 };
-const Element Np { "Np", "Neptunium", 93, 237 };
-const Element Pu { "Pu", "Plutonium", 94, 244 };
-const Element Am { "Am", "Americium", 95, 243 };
-const Element Cm { "Cm", "Curium", 96, 247 };
-const Element Bk { "Bk", "Berkelium", 97, 247 };
-const Element Cf { "Cf", "Californium", 98, 251 };
-const Element Es { "Es", "Einsteinium", 99, 252 };
-const Element Fm { "Fm", "Fermium", 100, 257 };
-const Element Md { "Md", "Mendelevium", 101, 258 };
-const Element No { "No", "Nobelium", 102, 259 };
-const Element Lr { "Lr", "Lawrencium", 103, 262 };
-const Element Rf { "Rf", "Rutherfordium", 104, 261 };
-const Element Db { "Db", "Dubnium", 105, 262 };
-const Element Sg { "Sg", "Seaborgium", 106, 266 };
-const Element Bh { "Bh", "Bohrium", 107, 264 };
-const Element Hs { "Hs", "Hassium", 108, 277 };
-const Element Mt { "Mt", "Meitnerium", 109, 268 };
-const Element Ds { "Ds", "Darmstadtium", 110, 281 };
-const Element Rg { "Rg", "Roentgenium", 111, 272 };
-const Element Cn { "Cn", "Copernicium", 112, 285 };
-const Element Nh { "Nh", "Nihonium", 113, 286 };
-const Element Fl { "Fl", "Flerovium", 114, 289 };
-const Element Mc { "Mc", "Moscovium", 115, 289 };
-const Element Lv { "Lv", "Livermorium", 116, 293 };
-const Element Ts { "Ts", "Tennessine", 117, 294 };
-const Element Og { "Og", "Oganesson", 118, 294 };
+inline constexpr Element H { "H", "Hydrogen", 1, 1.00794 };
+inline constexpr Element He { "He", "Helium", 2, 4.002602 };
+inline constexpr Element Li { "Li", "Lithium", 3, 6.941 };
+inline constexpr Element Be { "Be", "Beryllium", 4, 9.012182 };
+inline constexpr Element B { "B", "Boron", 5, 10.811 };
+inline constexpr Element C { "C", "Carbon", 6, 12.0107 };
+inline constexpr Element N { "N", "Nitrogen", 7, 14.0067 };
+inline constexpr Element O { "O", "Oxygen", 8, 15.9994 };
+inline constexpr Element F { "F", "Fluorine", 9, 18.9984032 };
+inline constexpr Element Ne { "Ne", "Neon", 10, 20.1797 };
+inline constexpr Element Na { "Na", "Sodium", 11, 22.98977 };
+inline constexpr Element Mg { "Mg", "Magnesium", 12, 24.305 };
+inline constexpr Element Al { "Al", "Aluminum", 13, 26.981538 };
+inline constexpr Element Si { "Si", "Silicon", 14, 28.0855 };
+inline constexpr Element P { "P", "Phosphorus", 15, 30.973761 };
+inline constexpr Element S { "S", "Sulfur", 16, 32.065 };
+inline constexpr Element Cl { "Cl", "Chlorine", 17, 35.453 };
+inline constexpr Element Ar { "Ar", "Argon", 18, 39.948 };
+inline constexpr Element K { "K", "Potassium", 19, 39.0983 };
+inline constexpr Element Ca { "Ca", "Calcium", 20, 40.078 };
+inline constexpr Element Sc { "Sc", "Scandium", 21, 44.95591 };
+inline constexpr Element Ti { "Ti", "Titanium", 22, 47.867 };
+inline constexpr Element V { "V", "Vanadium", 23, 50.9415 };
+inline constexpr Element Cr { "Cr", "Chromium", 24, 51.9961 };
+inline constexpr Element Mn { "Mn", "Manganese", 25, 54.938049 };
+inline constexpr Element Fe { "Fe", "Iron", 26, 55.845 };
+inline constexpr Element Co { "Co", "Cobalt", 27, 58.9332 };
+inline constexpr Element Ni { "Ni", "Nickel", 28, 58.6934 };
+inline constexpr Element Cu { "Cu", "Copper", 29, 63.546 };
+inline constexpr Element Zn { "Zn", "Zinc", 30, 65.409 };
+inline constexpr Element Ga { "Ga", "Gallium", 31, 69.723 };
+inline constexpr Element Ge { "Ge", "Germanium", 32, 72.64 };
+inline constexpr Element As { "As", "Arsenic", 33, 74.9216 };
+inline constexpr Element Se { "Se", "Selenium", 34, 78.96 };
+inline constexpr Element Br { "Br", "Bromine", 35, 79.904 };
+inline constexpr Element Kr { "Kr", "Krypton", 36, 83.798 };
+inline constexpr Element Rb { "Rb", "Rubidium", 37, 85.4678 };
+inline constexpr Element Sr { "Sr", "Strontium", 38, 87.62 };
+inline constexpr Element Y { "Y", "Yttrium", 39, 88.90585 };
+inline constexpr Element Zr { "Zr", "Zirconium", 40, 91.224 };
+inline constexpr Element Nb { "Nb", "Niobium", 41, 92.90638 };
+inline constexpr Element Mo { "Mo", "Molybdenum", 42, 95.94 };
+inline constexpr Element Tc { "Tc", "Technetium", 43, 98 };
+inline constexpr Element Ru { "Ru", "Ruthenium", 44, 101.07 };
+inline constexpr Element Rh { "Rh", "Rhodium", 45, 102.9055 };
+inline constexpr Element Pd { "Pd", "Palladium", 46, 106.42 };
+inline constexpr Element Ag { "Ag", "Silver", 47, 107.8682 };
+inline constexpr Element Cd { "Cd", "Cadmium", 48, 112.411 };
+inline constexpr Element In { "In", "Indium", 49, 114.818 };
+inline constexpr Element Sn { "Sn", "Tin", 50, 118.71 };
+inline constexpr Element Sb { "Sb", "Antimony", 51, 121.76 };
+inline constexpr Element Te { "Te", "Tellurium", 52, 127.6 };
+inline constexpr Element I { "I", "Iodine", 53, 126.90447 };
+inline constexpr Element Xe { "Xe", "Xenon", 54, 131.293 };
+inline constexpr Element Cs { "Cs", "Cesium", 55, 132.90545 };
+inline constexpr Element Ba { "Ba", "Barium", 56, 137.327 };
+inline constexpr Element La { "La", "Lanthanum", 57, 138.9055 };
+inline constexpr Element Ce { "Ce", "Cerium", 58, 140.116 };
+inline constexpr Element Pr { "Pr", "Praseodymium", 59, 140.90765 };
+inline constexpr Element Nd { "Nd", "Neodymium", 60, 144.24 };
+inline constexpr Element Pm { "Pm", "Promethium", 61, 145 };
+inline constexpr Element Sm { "Sm", "Samarium", 62, 150.36 };
+inline constexpr Element Eu { "Eu", "Europium", 63, 151.964 };
+inline constexpr Element Gd { "Gd", "Gadolinium", 64, 157.25 };
+inline constexpr Element Tb { "Tb", "Terbium", 65, 158.92534 };
+inline constexpr Element Dy { "Dy", "Dysprosium", 66, 162.5 };
+inline constexpr Element Ho { "Ho", "Holmium", 67, 164.93032 };
+inline constexpr Element Er { "Er", "Erbium", 68, 167.259 };
+inline constexpr Element Tm { "Tm", "Thulium", 69, 168.93421 };
+inline constexpr Element Yb { "Yb", "Ytterbium", 70, 173.04 };
+inline constexpr Element Lu { "Lu", "Lutetium", 71, 174.967 };
+inline constexpr Element Hf { "Hf", "Hafnium", 72, 178.49 };
+inline constexpr Element Ta { "Ta", "Tantalum", 73, 180.9479 };
+inline constexpr Element W { "W", "Tungsten", 74, 183.84 };
+inline constexpr Element Re { "Re", "Rhenium", 75, 186.207 };
+inline constexpr Element Os { "Os", "Osmium", 76, 190.23 };
+inline constexpr Element Ir { "Ir", "Iridium", 77, 192.217 };
+inline constexpr Element Pt { "Pt", "Platinum", 78, 195.078 };
+inline constexpr Element Au { "Au", "Gold", 79, 196.96655 };
+inline constexpr Element Hg { "Hg", "Mercury", 80, 200.59 };
+inline constexpr Element Tl { "Tl", "Thallium", 81, 204.3833 };
+inline constexpr Element Pb { "Pb", "Lead", 82, 207.2 };
+inline constexpr Element Bi { "Bi", "Bismuth", 83, 208.98038 };
+inline constexpr Element Po { "Po", "Polonium", 84, 209 };
+inline constexpr Element At { "At", "Astatine", 85, 210 };
+inline constexpr Element Rn { "Rn", "Radon", 86, 222 };
+inline constexpr Element Fr { "Fr", "Francium", 87, 223 };
+inline constexpr Element Ra { "Ra", "Radium", 88, 226 };
+inline constexpr Element Ac { "Ac", "Actinium", 89, 227 };
+inline constexpr Element Th { "Th", "Thorium", 90, 232.0381 };
+inline constexpr Element Pa { "Pa", "Protactinium", 91, 231.03588 };
+inline constexpr Element U { "U", "Uranium", 92, 238.02891 };
+inline constexpr Element Np { "Np", "Neptunium", 93, 237 };
+inline constexpr Element Pu { "Pu", "Plutonium", 94, 244 };
+inline constexpr Element Am { "Am", "Americium", 95, 243 };
+inline constexpr Element Cm { "Cm", "Curium", 96, 247 };
+inline constexpr Element Bk { "Bk", "Berkelium", 97, 247 };
+inline constexpr Element Cf { "Cf", "Californium", 98, 251 };
+inline constexpr Element Es { "Es", "Einsteinium", 99, 252 };
+inline constexpr Element Fm { "Fm", "Fermium", 100, 257 };
+inline constexpr Element Md { "Md", "Mendelevium", 101, 258 };
+inline constexpr Element No { "No", "Nobelium", 102, 259 };
+inline constexpr Element Lr { "Lr", "Lawrencium", 103, 262 };
+inline constexpr Element Rf { "Rf", "Rutherfordium", 104, 261 };
+inline constexpr Element Db { "Db", "Dubnium", 105, 262 };
+inline constexpr Element Sg { "Sg", "Seaborgium", 106, 266 };
+inline constexpr Element Bh { "Bh", "Bohrium", 107, 264 };
+inline constexpr Element Hs { "Hs", "Hassium", 108, 277 };
+inline constexpr Element Mt { "Mt", "Meitnerium", 109, 268 };
+inline constexpr Element Ds { "Ds", "Darmstadtium", 110, 281 };
+inline constexpr Element Rg { "Rg", "Roentgenium", 111, 272 };
+inline constexpr Element Cn { "Cn", "Copernicium", 112, 285 };
+inline constexpr Element Nh { "Nh", "Nihonium", 113, 286 };
+inline constexpr Element Fl { "Fl", "Flerovium", 114, 289 };
+inline constexpr Element Mc { "Mc", "Moscovium", 115, 289 };
+inline constexpr Element Lv { "Lv", "Livermorium", 116, 293 };
+inline constexpr Element Ts { "Ts", "Tennessine", 117, 294 };
+inline constexpr Element Og { "Og", "Oganesson", 118, 294 };
+
+/// Number of elements in the periodic table
+constexpr unsigned int NumberOfElements = 118;
+
+/// Elements indexed by their atomic numbers (index 0 is nullptr)
+inline constexpr std::array<const Element*, NumberOfElements + 1> ByAtomicNumber = { {
+    nullptr,
+    &H, &He, &Li, &Be, &B, &C, &N, &O, &F, &Ne, &Na, &Mg, &Al, &Si, &P, &S, &Cl, &Ar, &K, &Ca, &Sc,
+    &Ti, &V, &Cr, &Mn, &Fe, &Co, &Ni, &Cu, &Zn, &Ga, &Ge, &As, &Se, &Br, &Kr, &Rb, &Sr, &Y, &Zr,
+    &Nb, &Mo, &Tc, &Ru, &Rh, &Pd, &Ag, &Cd, &In, &Sn, &Sb, &Te, &I, &Xe, &Cs, &Ba, &La, &Ce, &Pr,
+    &Nd, &Pm, &Sm, &Eu, &Gd, &Tb, &Dy, &Ho, &Er, &Tm, &Yb, &Lu, &Hf, &Ta, &W, &Re, &Os, &Ir, &Pt,
+    &Au, &Hg, &Tl, &Pb, &Bi, &Po, &At, &Rn, &Fr, &Ra, &Ac, &Th, &Pa, &U, &Np, &Pu, &Am, &Cm, &Bk,
+    &Cf, &Es, &Fm, &Md, &No, &Lr, &Rf, &Db, &Sg, &Bh, &Hs, &Mt, &Ds, &Rg, &Cn, &Nh, &Fl, &Mc, &Lv,
+    &Ts, &Og
+} };
+
+/** @brief Finds an element by its atomic number in O(1)
+ *
+ * @param atomicNumber The atomic number
+ *
+ * @return Pointer to the element, or nullptr if atomicNumber is out of range
+ */
+constexpr const Element* FindByAtomicNumber(unsigned int atomicNumber)
+{
+    return atomicNumber <= NumberOfElements ? ByAtomicNumber[atomicNumber] : nullptr;
+}
+
+/// Perfect hash table mapping symbol keys (see SymbolKey) to atomic numbers.
+/// Zero means that there is no element with the symbol
+inline constexpr std::array<unsigned char, SymbolKeyCount> AtomicNumberBySymbolKey = [] {
+    std::array<unsigned char, SymbolKeyCount> table {};
+    for (unsigned int z = 1; z <= NumberOfElements; z++) {
+        table[SymbolKey(ByAtomicNumber[z]->Symbol)] = static_cast<unsigned char>(z);
+    }
+    return table;
+}();
+
+/** @brief Finds an element by its symbol (case insensitive) in O(1). Can be
+ * evaluated at compile time
+ *
+ * @param symbol The element symbol
+ *
+ * @return Pointer to the element, or nullptr if there is no element with the symbol
+ */
+constexpr const Element* FindBySymbol(std::string_view symbol)
+{
+    size_t key = SymbolKey(symbol);
+    return key < SymbolKeyCount ? ByAtomicNumber[AtomicNumberBySymbolKey[key]] : nullptr;
+}
 }
 
 #endif
\ No newline at end of file
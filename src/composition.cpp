@@ -2,16 +2,6 @@
 #include <cstdio>
 #include <stdexcept>
 
-// Converts string to title case
-static std::string toTitleCase(const std::string& str)
-{
-    std::string strNew = str;
-    for (char& c : strNew)
-        c = tolower(c);
-    strNew[0] = toupper(strNew[0]);
-    return strNew;
-}
-
 /** @brief Constructor of ElementData
  *
  * @param element The element from the periodic table (see the PeriodicTable namespace)
@@ -22,217 +12,327 @@ static std::string toTitleCase(const std::string& str)
 ElementData::ElementData(const PeriodicTable::Element& element, bool isVariable, bool isInterstitial, bool isMajor)
     : ElementData()
 {
-    mvSymbol = element.Symbol;
+    mvSymbol = element.Symbol.data();
     mvMolarMass = element.MolarMass;
     mvIsInterstitial = isInterstitial;
     mvIsVariable = isVariable;
     mvIsMajor = isMajor;
 }
 
-/** @brief Set mole fraction of element
+/// Checks if the mole fraction of the element can be set
+CompositionStatus ElementData::checkSetX() const noexcept
+{
+    if (mvIsMajor)
+        return CompositionStatus::MajorElement;
+    if (!mvIsAllowedToVary)
+        return CompositionStatus::LockedElement;
+    return CompositionStatus::Ok;
+}
+
+/// Checks if the mass fraction of the element can be set
+CompositionStatus ElementData::checkSetW() const noexcept
+{
+    if (mvIsMajor)
+        return CompositionStatus::MajorElement;
+    if (!mvIsAllowedToVary)
+        return CompositionStatus::LockedElement;
+    if (mvIsCompositionLocked)
+        return CompositionStatus::LockedMassFraction;
+    return CompositionStatus::Ok;
+}
+
+/** @brief Set mole fraction of element. Prints an error message if it cannot
+ * be set (see TrySetX)
  *
  * @param x Mole fraction
  */
 void ElementData::SetX(double x)
 {
-    if (mvIsMajor) {
-        fprintf(stderr, "Cannot set X(%s) composition of major element\n", mvSymbol.c_str());
-        return;
-    }
-    if (!mvIsAllowedToVary) {
-        fprintf(stderr, "Cannot set locked X(%s) composition\n", mvSymbol.c_str());
-        return;
-    }
+    CompositionStatus status = TrySetX(x);
+    if (status != CompositionStatus::Ok)
+        CompositionDiagnostics::PrintSetError(status, 'X', mvSymbol, "ElementData");
+}
+
+/** @brief Set weight fraction of element. Prints an error message if it
+ * cannot be set (see TrySetW)
+ *
+ * @param w Weight fraction
+ */
+void ElementData::SetW(double w)
+{
+    CompositionStatus status = TrySetW(w);
+    if (status != CompositionStatus::Ok)
+        CompositionDiagnostics::PrintSetError(status, 'W', mvSymbol, "ElementData");
+}
+
+/** @brief Set mole fraction of element. Never prints
+ *
+ * If the fraction cannot be set (major element, or fixed element of a locked
+ * composition), the element is left unchanged and the error is reported to
+ * the counters and callback registered in CompositionDiagnostics.
+ *
+ * @param x Mole fraction
+ *
+ * @return CompositionStatus::Ok, or the error
+ */
+CompositionStatus ElementData::TrySetX(double x) noexcept
+{
+    CompositionStatus status = checkSetX();
+    if (status != CompositionStatus::Ok)
+        return CompositionDiagnostics::Report(status, mvSymbol);
+
     mvUserX = mvX = x;
     mvUserW = mvW = mvU = 0.0;
     mvIsUpdated = false;
+    return CompositionStatus::Ok;
 }
 
-/** @brief Set weight fraction of element
+/** @brief Set weight fraction of element. Never prints (see TrySetX)
  *
  * @param w Weight fraction
+ *
+ * @return CompositionStatus::Ok, or the error (also
+ * CompositionStatus::LockedMassFraction if the composition is locked)
  */
-void ElementData::SetW(double w)
+CompositionStatus ElementData::TrySetW(double w) noexcept
 {
-    if (mvIsMajor) {
-        fprintf(stderr, "Cannot set W(%s) composition of major element\n", mvSymbol.c_str());
-        return;
-    }
-    if (!mvIsAllowedToVary) {
-        fprintf(stderr, "Cannot set locked W(%s) composition\n", mvSymbol.c_str());
-        return;
-    }
-    if (mvIsCompositionLocked) {
-        fprintf(stderr, "Setting mass fraction W(%s) not supported when composition is locked. Try setting in atomic fraction (ElementData::SetX) instead\n", mvSymbol.c_str());
-        return;
-    }
+    CompositionStatus status = checkSetW();
+    if (status != CompositionStatus::Ok)
+        return CompositionDiagnostics::Report(status, mvSymbol);
+
     mvUserW = mvW = w;
     mvUserX = mvX = mvU = 0.0;
     mvIsUpdated = false;
+    return CompositionStatus::Ok;
 }
 
-/// @brief Updates the pointers to the elements (mvpMajorElement, mvAlloyingElements, etc...)
-/// This function needs to be called only once. If it is called a second time, it does nothing
-void CompositionBase::updatePointers()
+/** @brief Resolves an element symbol into a handle, which can be used for
+ * accessing the element in any instance of the same class without looking it
+ * up again (see operator[](ElementHandle))
+ *
+ * @param elementSymbol The element symbol (case insensitive)
+ *
+ * @return Handle to the element
+ */
+ElementHandle CompositionBase::GetElementHandle(std::string_view elementSymbol) const
 {
-    // Do not update composition pointers if they are already updated
-    if (mvArePointersUpdated) {
-        return;
-    }
-
-    mvVariableInterstitialElements.clear();
-    mvFixedInterstitialElements.clear();
-    mvVariableSubstitutionalElements.clear();
-    mvFixedSubstitutionalElements.clear();
-
-    size_t cntMajor = 0;
-    for (ElementPointer pEl : getElementPointers()) {
-        if (pEl->mvIsMajor) {
-            if (cntMajor > 1) {
-                fprintf(stderr, "CompositionBase::updatePointers: Error! More than one major elements defined (%s and %s)\n", (mvpMajorElement->mvSymbol).c_str(), (pEl->mvSymbol).c_str());
-                return;
-            }
-            mvpMajorElement = pEl;
-            cntMajor++;
-        } else {
-            if (pEl->mvIsInterstitial) {
-                if (pEl->mvIsVariable) {
-                    mvVariableInterstitialElements.push_back(pEl);
-                } else {
-                    mvFixedInterstitialElements.push_back(pEl);
-                }
-            } else {
-                if (pEl->mvIsVariable) {
-                    mvVariableSubstitutionalElements.push_back(pEl);
-                } else {
-                    mvFixedSubstitutionalElements.push_back(pEl);
-                }
-            }
-        }
+    const ElementData* pEl = FindElement(elementSymbol);
+    if (pEl == nullptr) {
+        throw std::runtime_error("Element " + std::string(elementSymbol) + " is not defined");
     }
-
-    if (cntMajor == 0) {
-        fprintf(stderr, "CompositionBase::updatePointers: Error! No major element defined!\n");
-        return;
-    }
-
-    mvInterstitialElements = mvVariableInterstitialElements;
-    mvInterstitialElements.insert(mvInterstitialElements.end(), mvFixedInterstitialElements.begin(), mvFixedInterstitialElements.end());
-
-    mvSubstitutionalElements = mvVariableSubstitutionalElements;
-    mvSubstitutionalElements.insert(mvSubstitutionalElements.end(), mvFixedSubstitutionalElements.begin(), mvFixedSubstitutionalElements.end());
-
-    mvVariableElements = mvVariableInterstitialElements;
-    mvVariableElements.insert(mvVariableElements.end(), mvVariableSubstitutionalElements.begin(), mvVariableSubstitutionalElements.end());
-
-    mvFixedElements = mvFixedInterstitialElements;
-    mvFixedElements.insert(mvFixedElements.end(), mvFixedSubstitutionalElements.begin(), mvFixedSubstitutionalElements.end());
-
-    mvAlloyingElements = mvInterstitialElements;
-    mvAlloyingElements.insert(mvAlloyingElements.end(), mvSubstitutionalElements.begin(), mvSubstitutionalElements.end());
-
-    mvArePointersUpdated = true;
+    unsigned char i = (*mvpLayout->SymbolTable)[PeriodicTable::SymbolKey(elementSymbol)];
+    return ElementHandle(i - 1);
 }
 
-/** @brief operator[] for accessing elements by their names
+/** @brief operator[] for accessing elements by their names. Does not
+ * allocate memory, unless the element is not defined
  *
- * @param elementSymbol The element name
+ * @param elementSymbol The element name (case insensitive)
  *
- * @return Pointer to ElementData
+ * @return Reference to ElementData
  */
-ElementData& CompositionBase::operator[](const std::string& elementSymbol)
+ElementData& CompositionBase::operator[](std::string_view elementSymbol)
 {
-    updatePointers();
-
-    std::string elementSymbolTitle = toTitleCase(elementSymbol);
-    for (ElementPointer pEl : getElementPointers()) {
-        if (pEl->mvSymbol == elementSymbolTitle) {
-            return *pEl;
-        }
+    ElementData* pEl = FindElement(elementSymbol);
+    if (pEl == nullptr) {
+        throw std::runtime_error("Element " + std::string(elementSymbol) + " is not defined");
     }
-
-    throw std::runtime_error("Element " + elementSymbolTitle + " is not defined");
+    return *pEl;
 }
 
 /** @brief const version of operator[] for accessing elements by their names
  *
- * @param elementSymbol The element name
+ * @param elementSymbol The element name (case insensitive)
  *
- * @return Const pointer to respective ElementData
+ * @return Const reference to respective ElementData
  */
-const ElementData& CompositionBase::operator[](const std::string& elementSymbol) const
+const ElementData& CompositionBase::operator[](std::string_view elementSymbol) const
 {
-    std::string elementSymbolTitle = toTitleCase(elementSymbol);
-    for (ConstElementPointer pEl : getElementPointers()) {
-        if (pEl->mvSymbol == elementSymbolTitle) {
-            return *pEl;
-        }
+    const ElementData* pEl = FindElement(elementSymbol);
+    if (pEl == nullptr) {
+        throw std::runtime_error("Element " + std::string(elementSymbol) + " is not defined");
     }
+    return *pEl;
+}
 
-    throw std::runtime_error("Element " + elementSymbolTitle + " is not defined");
+/** @brief Sets the layout of the elements
+ *
+ * @param layout The layout, shared by all instances of the class
+ */
+void Composition::setLayout(const CompositionLayout& layout)
+{
+    COMPOSITION_COUNT(LayoutBinding);
+    mvpLayout = &layout;
 }
 
 /// @brief Locks composition, i.e., keeps site fraction of non-variable elements fixed
 void Composition::LockComposition()
 {
-    updatePointers();
+    TryLockComposition();
+}
 
+/** @brief Locks composition (see LockComposition). Never prints
+ *
+ * @return CompositionStatus::Ok, since the layouts of the composition
+ * classes are checked at compile time (see StaticPartition)
+ */
+CompositionStatus Composition::TryLockComposition() noexcept
+{
+    COMPOSITION_SCOPED_TIMER(LockComposition);
+    COMPOSITION_COUNT(LockComposition);
     updateFractions();
-
-    for (ElementPointer pEl : mvFixedElements) {
-        pEl->mvIsAllowedToVary = false;
-    }
-
-    for (ElementPointer pEl : mvAlloyingElements) {
-        pEl->mvIsCompositionLocked = true;
-    }
-
-    mvIsCompositionLocked = true;
+    setCompositionLocked(true);
+    return CompositionStatus::Ok;
 }
 
 /// @brief Unlocks composition (see LockComposition)
 void Composition::UnlockComposition()
 {
-    updatePointers();
+    COMPOSITION_COUNT(UnlockComposition);
+    setCompositionLocked(false);
+}
 
-    for (ElementPointer pEl : mvAlloyingElements) {
-        pEl->mvIsAllowedToVary = true;
-        pEl->mvIsCompositionLocked = false;
+/** @brief Sets the lock state of the composition and of its elements,
+ * without updating the fractions (see LockComposition and UnlockComposition)
+ *
+ * @param isLocked The lock state
+ */
+void Composition::setCompositionLocked(bool isLocked)
+{
+    for (size_t i : mvpLayout->Partition.Alloying) {
+        element(i).mvIsAllowedToVary = !isLocked || element(i).mvIsVariable;
+        element(i).mvIsCompositionLocked = isLocked;
     }
 
-    mvIsCompositionLocked = false;
+    mvIsCompositionLocked = isLocked;
 }
 
 /// @brief Updates fractions
 void Composition::UpdateFractions()
 {
-    updatePointers();
+    TryUpdateFractions();
+}
 
-    if (mvpMajorElement == nullptr) {
-        fprintf(stderr, "Composition::UpdateFractions: Error! No major element defined!\n");
-        return;
-    }
+/** @brief Updates fractions (see UpdateFractions). Never prints
+ *
+ * @return CompositionStatus::Ok, since the layouts of the composition
+ * classes are checked at compile time (see StaticPartition)
+ */
+CompositionStatus Composition::TryUpdateFractions() noexcept
+{
+    COMPOSITION_SCOPED_TIMER(UpdateFractions);
 
     if (!mvIsCompositionLocked) {
         updateFractions();
     } else {
         updateFractionsUFixed();
     }
+    return CompositionStatus::Ok;
 }
 
-/** @brief Updates the fractions and prints composition
+/** @brief Computes the Jacobians of the fractions with respect to the
+ * fractions of the independent elements, i.e., the alloying elements if the
+ * composition is unlocked, or the variable elements if it is locked (see
+ * CompositionKernels::Jacobians)
  *
- * @param stream The file stream (stdout by default)
+ * The derivatives are evaluated at the current fractions, reusing the
+ * average molar mass and the fixed partial components computed by
+ * UpdateFractions and LockComposition.
+ *
+ * @param jacobian The Jacobians (output)
  */
-void Composition::Print(FILE* stream)
+void Composition::GetJacobian(CompositionJacobian& jacobian) const
+{
+    jacobian.Columns.clear();
+    for (size_t i = 0; i < mvpLayout->NumberOfElements; i++) {
+        const ElementData& el = element(i);
+        if (mvIsCompositionLocked ? el.mvIsVariable && !el.mvIsMajor : !el.mvIsMajor)
+            jacobian.Columns.push_back(i);
+    }
+    jacobian.Resize(mvpLayout->NumberOfElements);
+
+    auto el = ElementDataAccessor { [this](size_t i) -> const ElementData& { return element(i); } };
+    CompositionKernels::Jacobians(el, mvpLayout->Partition, mvIsCompositionLocked, mvMolarMassAvg,
+        mvMolarMassAvgFixedPartial, mvXSumSubstitutionalFixedPartial, jacobian);
+}
+
+/** @brief Converts mole fractions of a variable interstitial element of a
+ * locked composition without variable substitutional elements (e.g., C in
+ * steels) into mass and site fractions
+ *
+ * Each conversion gives the same results as setting the mole fraction of the
+ * element in a copy of the composition and updating its fractions, but the
+ * fractions of the other elements are neither computed nor changed. With the
+ * partial components of the molar mass and of the fraction of substitutional
+ * elements precomputed by LockComposition, each conversion costs a few flops.
+ *
+ * @param interstitial The variable interstitial element (e.g., comp.C)
+ * @param x Mole fractions of the element
+ * @param count Number of mole fractions
+ * @param w Mass fractions of the element (output)
+ * @param u Site fractions of the element (output, optional)
+ * @param molarMassAvg Average molar masses (output, optional)
+ *
+ * @return CompositionStatus::Ok, or CompositionStatus::InvalidArgument if the
+ * composition is not locked, has variable substitutional elements, or the
+ * element is not a variable interstitial element. Never prints
+ */
+CompositionStatus Composition::ConvertLockedInterstitial(const ElementData& interstitial, const double* x, size_t count,
+    double* w, double* u, double* molarMassAvg) const noexcept
 {
-    updatePointers();
+    const ElementPartition& p = mvpLayout->Partition;
+    if (!mvIsCompositionLocked || !p.VariableSubstitutional.empty())
+        return CompositionDiagnostics::Report(CompositionStatus::InvalidArgument, nullptr);
 
-    if (mvpMajorElement == nullptr) {
-        fprintf(stderr, "Composition::Print: Error! No major element defined!\n");
-        return;
+    size_t k = 0;
+    while (k < p.VariableInterstitial.size() && &element(p.VariableInterstitial[k]) != &interstitial) {
+        k++;
+    }
+    if (k == p.VariableInterstitial.size())
+        return CompositionDiagnostics::Report(CompositionStatus::InvalidArgument, interstitial.mvSymbol);
+
+    // Partial sums of the other variable interstitial elements, in the same
+    // order as in CompositionKernels::UpdateFractionsUFixed. The elements
+    // after this one are summed once, so with more than one of them the
+    // results can differ from UpdateFractions by rounding errors
+    double MMajor = element(p.Major).mvMolarMass;
+    double xSumBefore = mvXSumSubstitutionalFixedPartial;
+    double xMSumProductBefore = 0.0;
+    for (size_t j = 0; j < k; j++) {
+        const ElementData& el = element(p.VariableInterstitial[j]);
+        xSumBefore -= el.mvX;
+        xMSumProductBefore += el.mvX * (MMajor - el.mvMolarMass);
     }
+    double xSumAfter = 0.0;
+    double xMSumProductAfter = 0.0;
+    for (size_t j = k + 1; j < p.VariableInterstitial.size(); j++) {
+        const ElementData& el = element(p.VariableInterstitial[j]);
+        xSumAfter += el.mvX;
+        xMSumProductAfter += el.mvX * (MMajor - el.mvMolarMass);
+    }
+    double M = interstitial.mvMolarMass;
+    double dM = MMajor - M;
+
+    for (size_t i = 0; i < count; i++) {
+        double xSum = xSumBefore - x[i] - xSumAfter;
+        double xMSumProduct = xMSumProductBefore + x[i] * dM + xMSumProductAfter;
+
+        double MAvg = MMajor - xMSumProduct - xSum * mvMolarMassAvgFixedPartial;
+        w[i] = x[i] * M / MAvg;
+        if (u != nullptr)
+            u[i] = x[i] / xSum;
+        if (molarMassAvg != nullptr)
+            molarMassAvg[i] = MAvg;
+    }
+    return CompositionStatus::Ok;
+}
 
+/** @brief Updates the fractions and prints composition
+ *
+ * @param stream The file stream (stdout by default)
+ */
+void Composition::Print(FILE* stream)
+{
     UpdateFractions();
 
     const auto* constThis = this;
@@ -248,150 +348,36 @@ void Composition::Print(FILE* stream) const
     fprintf(stream, "        | At. fraction (X) | Wt. fraction (W) | Site fraction (U)\n"
                     "  ------+------------------+------------------+-------------------\n");
 
-    for (ConstElementPointer pEl : getElementPointers()) {
-        if (pEl->mvX <= 0)
+    for (const ElementData& el : GetElements()) {
+        if (el.mvX <= 0)
             continue;
 
-        unsigned char pos = pEl->mvIsMajor ? 2 : (pEl->mvIsAllowedToVary ? 1 : 0);
+        unsigned char pos = el.mvIsMajor ? 2 : (el.mvIsAllowedToVary ? 1 : 0);
         fprintf(stream, "   %c%2s%c | %16.6g | %16.6g | %17.6g\n",
-            ">  "[pos], pEl->mvSymbol.c_str(), "< *"[pos], pEl->mvX, pEl->mvW, pEl->mvU);
+            ">  "[pos], el.mvSymbol, "< *"[pos], el.mvX, el.mvW, el.mvU);
     }
     fprintf(stream, "  Average molar mass: %8g\n", mvMolarMassAvg);
 }
 
 /** @brief Private implementation of update fractions that is used when
- * the composition is unlocked
+ * the composition is unlocked (see CompositionKernels::UpdateFractions)
  */
 void Composition::updateFractions()
 {
-    double MMajor = mvpMajorElement->mvMolarMass;
-    // MAvgNum: Average molar mass numerator
-    // MAvgDen: Average molar mass denominator
-    double MAvgNum = MMajor, MAvgDen = 1.0;
-
-    // xSum: sum of the atomic fractions of all atomic elements (excluding major)
-    // wSum: sum of the weight fractions of all atomic elements (excluding major)
-    double xSum = 0.0, wSum = 0.0;
-    // Calculates average molar mass and mole fraction of major element
-    for (ElementPointer pEl : mvAlloyingElements) {
-        xSum += pEl->mvUserX;
-        MAvgNum -= (MMajor - pEl->mvMolarMass) * pEl->mvUserX;
-
-        wSum += pEl->mvUserW / pEl->mvMolarMass;
-        MAvgDen += (MMajor / pEl->mvMolarMass - 1.0) * pEl->mvUserW;
-    }
-
-    mvMolarMassAvg = MAvgNum / MAvgDen;
-    double xMajor = 1.0 - xSum - wSum * mvMolarMassAvg;
-
-    mvpMajorElement->mvX = xMajor;
-    mvpMajorElement->mvW = xMajor * MMajor / mvMolarMassAvg;
-
-    // Calculates mole and mass fractions of remaining elements
-    for (ElementPointer pEl : mvAlloyingElements) {
-        double conversionFactor = mvMolarMassAvg / pEl->mvMolarMass;
-        if (pEl->mvUserX > 0)
-            pEl->mvW = pEl->mvUserX / conversionFactor;
-        else if (pEl->mvUserW > 0)
-            pEl->mvX = pEl->mvUserW * conversionFactor;
-    }
-
-    double xSumSubstitutional = 1.0;
-    // Calculates fraction of substitutional elements
-    for (ElementPointer pEl : mvInterstitialElements) {
-        xSumSubstitutional -= pEl->mvX;
-    }
-
-    // Calculates site fractions U
-    mvpMajorElement->mvU = mvpMajorElement->mvX / xSumSubstitutional;
-    mvpMajorElement->mvIsUpdated = true;
-
-    for (ElementPointer pEl : mvVariableElements) {
-        pEl->mvU = pEl->mvX / xSumSubstitutional;
-        pEl->mvIsUpdated = true;
-    }
-
-    mvMolarMassAvgFixedPartial = 0.0;
-    for (ElementPointer pEl : mvFixedElements) {
-        pEl->mvU = pEl->mvX / xSumSubstitutional;
-        mvMolarMassAvgFixedPartial += pEl->mvU * (mvpMajorElement->mvMolarMass - pEl->mvMolarMass);
-        pEl->mvIsUpdated = true;
-    }
-
-    mvXSumSubstitutionalFixedPartial = 1.0;
-    for (ElementPointer pEl : mvFixedInterstitialElements) {
-        mvXSumSubstitutionalFixedPartial -= pEl->mvX;
-    }
+    COMPOSITION_COUNT(UpdateUnlocked);
+    auto el = ElementDataAccessor { [this](size_t i) -> ElementData& { return element(i); } };
+    CompositionKernels::UpdateFractions(el, mvpLayout->Partition, mvMolarMassAvg,
+        mvMolarMassAvgFixedPartial, mvXSumSubstitutionalFixedPartial);
 }
 
 /** @brief Implementation of update fraction that is used when the composition
  * is locked. It assumes that the u-fractions (site fractions) of the "fixed"
- * or "non-variable" elements does not change
+ * or "non-variable" elements does not change (see CompositionKernels::UpdateFractionsUFixed)
  */
 void Composition::updateFractionsUFixed()
 {
-    double xMSumProduct = 0.0;
-    double xSumSubstitutional = mvXSumSubstitutionalFixedPartial;
-    double xSumAlloying = 0.0;
-    int notUpdatedCounterInterstitial = 0;
-    int notUpdatedCounterSubstitutional = 0;
-
-    // Loop through variable interstitial elements to compute the the partial sum xMSumProduct
-    // used for determining average molar mass
-    for (ElementPointer pEl : mvVariableInterstitialElements) {
-        if (!pEl->mvIsUpdated) {
-            notUpdatedCounterInterstitial++;
-        }
-        xSumSubstitutional -= pEl->mvX;
-        xMSumProduct += pEl->mvX * (mvpMajorElement->mvMolarMass - pEl->mvMolarMass);
-    }
-
-    // Loop through variable interstitial elements to compute the partial sum xMSumProduct
-    // used for determining average molar mass
-    for (ElementPointer pEl : mvVariableSubstitutionalElements) {
-        if (!pEl->mvIsUpdated) {
-            xMSumProduct += pEl->mvX * (mvpMajorElement->mvMolarMass - pEl->mvMolarMass);
-            notUpdatedCounterSubstitutional++;
-        } else {
-            xMSumProduct += xSumSubstitutional * pEl->mvU * (mvpMajorElement->mvMolarMass - pEl->mvMolarMass);
-        }
-    }
-
-    // If the composition has changed
-    if (notUpdatedCounterInterstitial + notUpdatedCounterSubstitutional > 0) {
-        // Evaluates average molar mass
-        mvMolarMassAvg = mvpMajorElement->mvMolarMass - xMSumProduct - xSumSubstitutional * mvMolarMassAvgFixedPartial;
-
-        // If interstitial element fraction changed, then updates site fractions of variable interstitial elements
-        if (notUpdatedCounterInterstitial > 0) {
-            for (ElementPointer pEl : mvVariableInterstitialElements) {
-                if (!pEl->mvIsUpdated) {
-                    pEl->mvU = pEl->mvX / xSumSubstitutional;
-                }
-            }
-        }
-
-        // Updates site fractions of variable substitutional elements
-        for (ElementPointer pEl : mvVariableSubstitutionalElements) {
-            if (!pEl->mvIsUpdated) {
-                pEl->mvU = pEl->mvX / xSumSubstitutional;
-            }
-        }
-
-        // Updates mole and mass fractions of all alloying elements
-        for (ElementPointer pEl : mvAlloyingElements) {
-            if (notUpdatedCounterInterstitial > 0) {
-                if (pEl->mvIsUpdated)
-                    pEl->mvX = pEl->mvU * xSumSubstitutional;
-                else
-                    pEl->mvIsUpdated = true;
-            }
-            pEl->mvW = pEl->mvX * pEl->mvMolarMass / mvMolarMassAvg;
-            xSumAlloying += pEl->mvX;
-        }
-
-        mvpMajorElement->mvX = 1.0 - xSumAlloying;
-        mvpMajorElement->mvW = mvpMajorElement->mvX * mvpMajorElement->mvMolarMass / mvMolarMassAvg;
-        mvpMajorElement->mvU = mvpMajorElement->mvX / xSumSubstitutional;
-    }
+    COMPOSITION_COUNT(UpdateLocked);
+    auto el = ElementDataAccessor { [this](size_t i) -> ElementData& { return element(i); } };
+    CompositionKernels::UpdateFractionsUFixed(el, mvpLayout->Partition, mvMolarMassAvg,
+        mvMolarMassAvgFixedPartial, mvXSumSubstitutionalFixedPartial);
 }
@@ -0,0 +1,395 @@
+#include "composition_additions.hpp"
+#include "composition_parallel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+
+/** @brief Simplex tableau of the linear program of a heat, reused for all
+ * heats solved by a thread
+ *
+ * The masses of the additions are normalized by the mass of the heat. Each
+ * bound of a target range is a row \f$\sum_k g_k x_k + s - v = b\f$, with a
+ * slack s and an elastic variable v that relaxes the bound when it cannot be
+ * reached. Each available mass is a row \f$x_k + s = u_k / H\f$. The columns
+ * are the masses, the slacks, the elastic variables and the right hand side.
+ *
+ * The objective is lexicographic, with one row of reduced costs per
+ * objective: the sum of the elastic variables first, and the cost of the
+ * additions second.
+ */
+struct CompositionAdditionSolver::Tableau {
+    size_t NumberOfRows; ///< Number of constraints
+    size_t NumberOfColumns; ///< Number of variables
+    std::vector<double> Rows; ///< Coefficients of the constraints and right hand sides (one row per constraint)
+    std::vector<double> DeviationCosts; ///< Reduced costs of the sum of the elastic variables, and its value
+    std::vector<double> ReducedCosts; ///< Reduced costs of the cost of the additions, and its value
+    std::vector<unsigned char> IsFixed; ///< If the variables are kept at zero while minimizing the cost
+    std::vector<size_t> Basis; ///< Basic variable of each row
+
+    /// Coefficients of a row
+    double* Row(size_t r) { return Rows.data() + r * (NumberOfColumns + 1); }
+
+    /// Makes variable j basic in row r
+    void Pivot(size_t r, size_t j)
+    {
+        size_t nColumns = NumberOfColumns + 1;
+        double* pivotRow = Row(r);
+        double pivot = pivotRow[j];
+        for (size_t c = 0; c < nColumns; c++) {
+            pivotRow[c] /= pivot;
+        }
+        for (size_t i = 0; i < NumberOfRows; i++) {
+            double* row = Row(i);
+            double f = row[j];
+            if (i == r || f == 0.0)
+                continue;
+            for (size_t c = 0; c < nColumns; c++) {
+                row[c] -= f * pivotRow[c];
+            }
+        }
+        double fDeviation = DeviationCosts[j];
+        double fCost = ReducedCosts[j];
+        for (size_t c = 0; c < nColumns; c++) {
+            DeviationCosts[c] -= fDeviation * pivotRow[c];
+            ReducedCosts[c] -= fCost * pivotRow[c];
+        }
+        Basis[r] = j;
+    }
+
+    /** @brief Minimizes an objective with the simplex algorithm, from a
+     * feasible basis. The entering variables are chosen with Bland's rule,
+     * which cannot cycle
+     *
+     * @param d Reduced costs of the objective
+     * @param tolerance Reduced costs above -tolerance are taken as optimal
+     *
+     * @return true, or false if the iteration limit is reached or the
+     * objective is unbounded (due to rounding errors), in which case the
+     * basis is still feasible
+     */
+    bool Minimize(const double* d, double tolerance)
+    {
+        const double pivotTolerance = 1e-12;
+        for (size_t iteration = 0; iteration < 50 * (NumberOfRows + NumberOfColumns); iteration++) {
+            size_t entering = NumberOfColumns;
+            for (size_t j = 0; j < NumberOfColumns; j++) {
+                if (!IsFixed[j] && d[j] < -tolerance) {
+                    entering = j;
+                    break;
+                }
+            }
+            if (entering == NumberOfColumns)
+                return true;
+
+            size_t leaving = NumberOfRows;
+            double minRatio = HUGE_VAL;
+            for (size_t r = 0; r < NumberOfRows; r++) {
+                const double* row = Row(r);
+                if (row[entering] <= pivotTolerance)
+                    continue;
+                double ratio = row[NumberOfColumns] / row[entering];
+                if (ratio < minRatio || (ratio == minRatio && leaving < NumberOfRows && Basis[r] < Basis[leaving])) {
+                    minRatio = ratio;
+                    leaving = r;
+                }
+            }
+            // Unbounded, which cannot happen with objectives that are not
+            // negative
+            if (leaving == NumberOfRows)
+                return false;
+            Pivot(leaving, entering);
+        }
+        return false;
+    }
+};
+
+/** @brief Constructor of CompositionAdditionSolver. The costs of the
+ * additions are 1 per unit mass (i.e., the total mass of the additions is
+ * minimized) and their available masses are unlimited
+ *
+ * @param additions Batch with the compositions of the additions, one per
+ * row, whose fractions are updated (see CompositionBatch::UpdateFractions)
+ */
+CompositionAdditionSolver::CompositionAdditionSolver(const CompositionBatch& additions)
+    : mvNumberOfAdditions(additions.Size())
+    , mvElements(additions)
+    , mvAlloying(additions.GetPartition().Alloying)
+    , mvCosts(additions.Size(), 1.0)
+    , mvMaxMasses(additions.Size(), HUGE_VAL)
+{
+    mvElements.Resize(0);
+
+    size_t nElements = additions.NumberOfElements();
+    mvAdditionW.resize(mvNumberOfAdditions * nElements);
+    for (size_t k = 0; k < mvNumberOfAdditions; k++) {
+        for (size_t e = 0; e < nElements; e++) {
+            mvAdditionW[k * nElements + e] = additions.GetW(e, k);
+        }
+    }
+}
+
+/** @brief Sets the costs of the additions
+ *
+ * @param costs Cost per unit mass of each addition (NumberOfAdditions()
+ * values, not negative)
+ *
+ * @return CompositionStatus::Ok, or CompositionStatus::InvalidArgument if a
+ * cost is negative, in which case the costs are not changed
+ */
+CompositionStatus CompositionAdditionSolver::SetCosts(const double* costs) noexcept
+{
+    for (size_t k = 0; k < mvNumberOfAdditions; k++) {
+        if (!(costs[k] >= 0.0 && costs[k] < HUGE_VAL))
+            return CompositionDiagnostics::Report(CompositionStatus::InvalidArgument, nullptr);
+    }
+    std::copy(costs, costs + mvNumberOfAdditions, mvCosts.begin());
+    return CompositionStatus::Ok;
+}
+
+/** @brief Sets the available masses of the additions
+ *
+ * @param maxMasses Maximum mass of each addition in each heat
+ * (NumberOfAdditions() values, not negative, HUGE_VAL if unlimited)
+ *
+ * @return CompositionStatus::Ok, or CompositionStatus::InvalidArgument if a
+ * mass is negative, in which case the masses are not changed
+ */
+CompositionStatus CompositionAdditionSolver::SetMaxMasses(const double* maxMasses) noexcept
+{
+    for (size_t k = 0; k < mvNumberOfAdditions; k++) {
+        if (!(maxMasses[k] >= 0.0))
+            return CompositionDiagnostics::Report(CompositionStatus::InvalidArgument, nullptr);
+    }
+    std::copy(maxMasses, maxMasses + mvNumberOfAdditions, mvMaxMasses.begin());
+    return CompositionStatus::Ok;
+}
+
+/** @brief Sets the target ranges of the mass fractions
+ *
+ * @param targets Target ranges, at most one per element. Elements without
+ * target are not constrained
+ *
+ * @return CompositionStatus::Ok, or CompositionStatus::InvalidArgument if a
+ * range is empty or an element is not defined or has several ranges, in
+ * which case the targets are not changed
+ */
+CompositionStatus CompositionAdditionSolver::SetTargets(const std::vector<Target>& targets)
+{
+    std::vector<bool> hasTarget(NumberOfElements(), false);
+    std::vector<TargetRow> targetRows;
+    for (const Target& target : targets) {
+        if (target.Element >= NumberOfElements() || hasTarget[target.Element] || !(target.MinW <= target.MaxW))
+            return CompositionDiagnostics::Report(CompositionStatus::InvalidArgument, nullptr);
+        hasTarget[target.Element] = true;
+
+        // Mass fractions are always between 0 and 1
+        if (target.MinW > 0.0)
+            targetRows.push_back({ target.Element, target.MinW, 1.0 });
+        if (target.MaxW < 1.0)
+            targetRows.push_back({ target.Element, target.MaxW, -1.0 });
+    }
+    mvTargets = targets;
+    mvTargetRows.swap(targetRows);
+    return CompositionStatus::Ok;
+}
+
+/// Checks if a batch has the same element definitions as the additions
+void CompositionAdditionSolver::checkHeats(const CompositionBatch& heats) const
+{
+    if (!mvElements.HasSameLayout(heats)) {
+        throw std::runtime_error("CompositionAdditionSolver: batch has different element definitions");
+    }
+}
+
+/** @brief Solves the linear program of a heat with the simplex algorithm
+ *
+ * The first phase minimizes the sum of the elastic variables, i.e., the
+ * masses of the elements outside their ranges (relative to the mass of the
+ * heat). The second phase minimizes the cost of the additions without
+ * changing that sum, by keeping at zero the variables whose reduced costs in
+ * the first phase are positive. The initial basis is made of the slacks, or
+ * of the elastic variables of the bounds that the heat does not meet, so it
+ * is always feasible.
+ *
+ * @param tableau Tableau, resized as needed
+ * @param heatW Mass fractions of the heat (NumberOfElements() values)
+ * @param heatMass Mass of the heat
+ * @param masses Receives the masses of the additions
+ *
+ * @return true, or false if a phase stopped before its optimum, in which
+ * case the masses are within the available masses but may not be optimal
+ */
+bool CompositionAdditionSolver::solveHeat(Tableau& tableau, const double* heatW, double heatMass, double* masses) const
+{
+    size_t nAdditions = mvNumberOfAdditions;
+    size_t nElements = NumberOfElements();
+    size_t nTargetRows = mvTargetRows.size();
+    size_t nRows = nTargetRows;
+    for (size_t k = 0; k < nAdditions; k++) {
+        nRows += mvMaxMasses[k] < HUGE_VAL;
+    }
+    size_t nColumns = nAdditions + nRows + nTargetRows;
+
+    tableau.NumberOfRows = nRows;
+    tableau.NumberOfColumns = nColumns;
+    tableau.Rows.assign(nRows * (nColumns + 1), 0.0);
+    tableau.DeviationCosts.assign(nColumns + 1, 0.0);
+    tableau.ReducedCosts.assign(nColumns + 1, 0.0);
+    tableau.IsFixed.assign(nColumns, false);
+    tableau.Basis.resize(nRows);
+
+    double* dDeviation = tableau.DeviationCosts.data();
+    double* dCost = tableau.ReducedCosts.data();
+    double maxCost = 0.0;
+    for (size_t k = 0; k < nAdditions; k++) {
+        dCost[k] = mvCosts[k];
+        maxCost = std::max(maxCost, mvCosts[k]);
+    }
+
+    for (size_t r = 0; r < nTargetRows; r++) {
+        const TargetRow& target = mvTargetRows[r];
+        double* row = tableau.Row(r);
+        for (size_t k = 0; k < nAdditions; k++) {
+            row[k] = target.Sign * (target.Bound - mvAdditionW[k * nElements + target.Element]);
+        }
+        size_t slack = nAdditions + r, elastic = nAdditions + nRows + r;
+        row[slack] = 1.0;
+        row[elastic] = -1.0;
+        row[nColumns] = target.Sign * (heatW[target.Element] - target.Bound);
+        dDeviation[elastic] = 1.0;
+
+        if (row[nColumns] >= 0.0) {
+            tableau.Basis[r] = slack;
+        } else {
+            // Bound not met: the elastic variable starts basic
+            for (size_t c = 0; c <= nColumns; c++) {
+                row[c] = -row[c];
+                dDeviation[c] -= row[c];
+            }
+            tableau.Basis[r] = elastic;
+        }
+    }
+    for (size_t k = 0, r = nTargetRows; k < nAdditions; k++) {
+        if (!(mvMaxMasses[k] < HUGE_VAL))
+            continue;
+        double* row = tableau.Row(r);
+        row[k] = 1.0;
+        row[nAdditions + r] = 1.0;
+        row[nColumns] = mvMaxMasses[k] / heatMass;
+        tableau.Basis[r] = nAdditions + r;
+        r++;
+    }
+
+    const double tolerance = 1e-12;
+    bool isOptimal = tableau.Minimize(dDeviation, tolerance);
+    if (isOptimal) {
+        for (size_t j = 0; j < nColumns; j++) {
+            tableau.IsFixed[j] = dDeviation[j] > tolerance;
+        }
+        isOptimal = tableau.Minimize(dCost, tolerance * maxCost);
+    }
+
+    std::fill(masses, masses + nAdditions, 0.0);
+    for (size_t r = 0; r < nRows; r++) {
+        if (tableau.Basis[r] < nAdditions)
+            masses[tableau.Basis[r]] = std::max(tableau.Row(r)[nColumns], 0.0) * heatMass;
+    }
+    return isOptimal;
+}
+
+/** @brief Computes the masses of the additions for each heat and the
+ * resulting compositions
+ *
+ * @param heats Batch with the compositions of the heats, one per row, whose
+ * fractions are updated, with the same elements as the additions
+ * @param heatMasses Mass of each heat (heats.Size() positive values)
+ * @param masses Receives the masses of the additions, with one row of
+ * NumberOfAdditions() values per heat
+ * @param deviations Receives, for each heat, the largest deviation of the
+ * resulting mass fractions from their target ranges (0 if all are reached,
+ * up to rounding errors). Can be nullptr
+ * @param results Batch with the same elements as the heats, resized to the
+ * number of heats and unlocked. Receives the resulting compositions
+ * @param pExecutor Executor running the heats in parallel (optional)
+ *
+ * @return CompositionStatus::Ok, CompositionStatus::InvalidArgument if the
+ * mass of a heat is not positive, in which case nothing is changed, or
+ * CompositionStatus::NotConverged if the linear program of a heat stopped
+ * before its optimum, in which case the masses of that heat are within the
+ * available masses but may not minimize the deviations or the cost
+ */
+CompositionStatus CompositionAdditionSolver::Solve(const CompositionBatch& heats, const double* heatMasses, double* masses,
+    double* deviations, CompositionBatch& results, Executor* pExecutor) const
+{
+    checkHeats(heats);
+    checkHeats(results);
+    size_t nHeats = heats.Size();
+    for (size_t h = 0; h < nHeats; h++) {
+        if (!(heatMasses[h] > 0.0 && heatMasses[h] < HUGE_VAL))
+            return CompositionDiagnostics::Report(CompositionStatus::InvalidArgument, nullptr);
+    }
+
+    // Mass fractions of the alloying elements of the results, one column per
+    // element as in CompositionBatch
+    size_t nElements = NumberOfElements();
+    size_t nAlloying = mvAlloying.size();
+    std::vector<double> resultW(nAlloying * nHeats);
+    std::atomic<bool> isConverged { true };
+    const size_t blockSize = 64;
+    auto solveBlock = [&](size_t block) {
+        Tableau tableau;
+        std::vector<double> heatW(nElements);
+        for (size_t h = block * blockSize; h < std::min(nHeats, (block + 1) * blockSize); h++) {
+            for (size_t e = 0; e < nElements; e++) {
+                heatW[e] = heats.GetW(e, h);
+            }
+            double* heatMassesOut = masses + h * mvNumberOfAdditions;
+            if (!solveHeat(tableau, heatW.data(), heatMasses[h], heatMassesOut))
+                isConverged.store(false, std::memory_order_relaxed);
+
+            double total = heatMasses[h];
+            for (size_t k = 0; k < mvNumberOfAdditions; k++) {
+                total += heatMassesOut[k];
+            }
+            for (size_t a = 0; a < nAlloying; a++) {
+                size_t e = mvAlloying[a];
+                double mass = heatMasses[h] * heatW[e];
+                for (size_t k = 0; k < mvNumberOfAdditions; k++) {
+                    mass += heatMassesOut[k] * mvAdditionW[k * nElements + e];
+                }
+                resultW[a * nHeats + h] = mass / total;
+            }
+        }
+    };
+    size_t nBlocks = (nHeats + blockSize - 1) / blockSize;
+    if (pExecutor != nullptr) {
+        pExecutor->Run(nBlocks, solveBlock);
+    } else {
+        for (size_t block = 0; block < nBlocks; block++) {
+            solveBlock(block);
+        }
+    }
+
+    if (results.Size() != nHeats)
+        results.Resize(nHeats);
+    results.UnlockComposition();
+    for (size_t a = 0; a < nAlloying; a++) {
+        results.TrySetW(mvAlloying[a], resultW.data() + a * nHeats);
+    }
+    results.UpdateFractions();
+
+    if (deviations != nullptr) {
+        for (size_t h = 0; h < nHeats; h++) {
+            double deviation = 0.0;
+            for (const Target& target : mvTargets) {
+                double w = results.GetW(target.Element, h);
+                deviation = std::max({ deviation, target.MinW - w, w - target.MaxW });
+            }
+            deviations[h] = deviation;
+        }
+    }
+    if (!isConverged.load(std::memory_order_relaxed))
+        return CompositionDiagnostics::Report(CompositionStatus::NotConverged, nullptr);
+    return CompositionStatus::Ok;
+}
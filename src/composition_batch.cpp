@@ -0,0 +1,588 @@
+#include "composition_batch.hpp"
+#include "composition_kernels.hpp"
+#include "composition_simd.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+/// Accessor to the fractions of a single row of ScalarCompositionBatch used
+/// by the templates in CompositionKernels
+template <typename Scalar>
+struct ScalarCompositionBatch<Scalar>::RowAccessor {
+    ScalarCompositionBatch& Batch; ///< The batch
+    size_t Row; ///< The row
+
+    Scalar MolarMass(size_t element) const { return Batch.mvMolarMasses[element]; }
+    Scalar& UserX(size_t element) const { return Batch.mvUserX[element * Batch.mvSize + Row]; }
+    Scalar& UserW(size_t element) const { return Batch.mvUserW[element * Batch.mvSize + Row]; }
+    Scalar& X(size_t element) const { return Batch.mvX[element * Batch.mvSize + Row]; }
+    Scalar& W(size_t element) const { return Batch.mvW[element * Batch.mvSize + Row]; }
+    Scalar& U(size_t element) const { return Batch.mvU[element * Batch.mvSize + Row]; }
+    unsigned char& IsUpdated(size_t element) const { return Batch.mvIsUpdated[element * Batch.mvSize + Row]; }
+};
+
+// Best instruction set supported by both the CPU and this build
+static InstructionSet detectInstructionSet()
+{
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (CompositionSimd::KernelsAVX512() && __builtin_cpu_supports("avx512f"))
+        return InstructionSet::AVX512;
+    if (CompositionSimd::KernelsAVX2() && __builtin_cpu_supports("avx2"))
+        return InstructionSet::AVX2;
+    if (CompositionSimd::KernelsSSE2() && __builtin_cpu_supports("sse2"))
+        return InstructionSet::SSE2;
+#endif
+    return InstructionSet::Scalar;
+}
+
+// Vectorized kernels of a scalar type for an instruction set (nullptr if none)
+template <typename Scalar>
+static const CompositionSimd::BasicKernels<Scalar>* getKernels(InstructionSet)
+{
+    return nullptr;
+}
+
+template <>
+const CompositionSimd::BasicKernels<float>* getKernels<float>(InstructionSet instructionSet)
+{
+    switch (instructionSet) {
+    case InstructionSet::AVX512:
+        return CompositionSimd::KernelsFloatAVX512();
+    case InstructionSet::AVX2:
+        return CompositionSimd::KernelsFloatAVX2();
+    case InstructionSet::SSE2:
+        return CompositionSimd::KernelsFloatSSE2();
+    case InstructionSet::Scalar:
+        break;
+    }
+    return nullptr;
+}
+
+template <>
+const CompositionSimd::BasicKernels<double>* getKernels<double>(InstructionSet instructionSet)
+{
+    switch (instructionSet) {
+    case InstructionSet::AVX512:
+        return CompositionSimd::KernelsAVX512();
+    case InstructionSet::AVX2:
+        return CompositionSimd::KernelsAVX2();
+    case InstructionSet::SSE2:
+        return CompositionSimd::KernelsSSE2();
+    case InstructionSet::Scalar:
+        break;
+    }
+    return nullptr;
+}
+
+/** @brief Constructor of ScalarCompositionBatch
+ *
+ * @param prototype Composition from which the element definitions and their partition are taken
+ * @param size Number of compositions (rows)
+ */
+template <typename Scalar>
+ScalarCompositionBatch<Scalar>::ScalarCompositionBatch(const Composition& prototype, size_t size)
+{
+    for (size_t e = 0; e < prototype.mvpLayout->NumberOfElements; e++) {
+        const ElementData& el = prototype.element(e);
+        mvSymbols.push_back(el.mvSymbol);
+        mvMolarMasses.push_back(static_cast<Scalar>(el.mvMolarMass));
+        mvIsInterstitial.push_back(el.mvIsInterstitial);
+        mvIsVariable.push_back(el.mvIsVariable);
+    }
+
+    mvPartition = prototype.mvpLayout->Partition;
+    mvpSymbolTable = prototype.mvpLayout->SymbolTable;
+
+    mvInstructionSet = GetSupportedInstructionSet();
+
+    Resize(size);
+}
+
+/// @brief Gets the best instruction set supported by the CPU for Scalar,
+/// detected once at runtime (InstructionSet::Scalar for long double)
+template <typename Scalar>
+InstructionSet ScalarCompositionBatch<Scalar>::GetSupportedInstructionSet()
+{
+    static const InstructionSet detected = detectInstructionSet();
+    static const InstructionSet supported = getKernels<Scalar>(detected) != nullptr ? detected : InstructionSet::Scalar;
+    return supported;
+}
+
+/** @brief Sets the instruction set of the vectorized kernels. If it is not
+ * supported, the best supported instruction set is used instead
+ *
+ * @param instructionSet The instruction set
+ */
+template <typename Scalar>
+void ScalarCompositionBatch<Scalar>::SetInstructionSet(InstructionSet instructionSet)
+{
+    InstructionSet supported = GetSupportedInstructionSet();
+    mvInstructionSet = instructionSet < supported ? instructionSet : supported;
+}
+
+/// Number of compositions (rows) per instruction of the vectorized kernels,
+/// given by the instruction set and Scalar (1 if not vectorized)
+template <typename Scalar>
+size_t ScalarCompositionBatch<Scalar>::GetVectorWidth() const
+{
+    switch (mvInstructionSet) {
+    case InstructionSet::AVX512:
+        return 64 / sizeof(Scalar);
+    case InstructionSet::AVX2:
+        return 32 / sizeof(Scalar);
+    case InstructionSet::SSE2:
+        return 16 / sizeof(Scalar);
+    case InstructionSet::Scalar:
+        break;
+    }
+    return 1;
+}
+
+// Changes the number of rows of a vector storing one column per element
+template <typename T>
+static void resizeColumns(std::vector<T>& columns, size_t nElements, size_t oldSize, size_t newSize)
+{
+    size_t nCopy = newSize < oldSize ? newSize : oldSize;
+    std::vector<T> newColumns(nElements * newSize);
+    for (size_t e = 0; e < nElements; e++)
+        for (size_t r = 0; r < nCopy; r++)
+            newColumns[e * newSize + r] = columns[e * oldSize + r];
+    columns.swap(newColumns);
+}
+
+/** @brief Changes the number of compositions (rows) in the batch. Existing
+ * rows are kept, new rows are initialized as in a new Composition
+ *
+ * @param size New number of rows
+ */
+template <typename Scalar>
+void ScalarCompositionBatch<Scalar>::Resize(size_t size)
+{
+    size_t nElements = NumberOfElements();
+
+    resizeColumns(mvUserX, nElements, mvSize, size);
+    resizeColumns(mvUserW, nElements, mvSize, size);
+    resizeColumns(mvX, nElements, mvSize, size);
+    resizeColumns(mvW, nElements, mvSize, size);
+    resizeColumns(mvU, nElements, mvSize, size);
+    resizeColumns(mvIsUpdated, nElements, mvSize, size);
+
+    mvMolarMassAvg.resize(size, 0);
+    mvMolarMassAvgFixedPartial.resize(size, 0);
+    mvXSumSubstitutionalFixedPartial.resize(size, 0);
+
+    mvSize = size;
+}
+
+/** @brief Gets the index (column) of an element
+ *
+ * @param elementSymbol The element symbol (case insensitive)
+ *
+ * @return Index of the element
+ */
+template <typename Scalar>
+size_t ScalarCompositionBatch<Scalar>::GetElementIndex(std::string_view elementSymbol) const
+{
+    size_t key = PeriodicTable::SymbolKey(elementSymbol);
+    if (key < PeriodicTable::SymbolKeyCount && (*mvpSymbolTable)[key] > 0) {
+        return (*mvpSymbolTable)[key] - 1;
+    }
+
+    throw std::runtime_error("Element " + std::string(elementSymbol) + " is not defined");
+}
+
+/// Checks if the mole fraction of an element can be set (see ElementData::TrySetX)
+template <typename Scalar>
+CompositionStatus ScalarCompositionBatch<Scalar>::checkSetX(size_t element) const noexcept
+{
+    if (element == mvPartition.Major)
+        return CompositionStatus::MajorElement;
+    if (mvIsCompositionLocked && !mvIsVariable[element])
+        return CompositionStatus::LockedElement;
+    return CompositionStatus::Ok;
+}
+
+/// Checks if the weight fraction of an element can be set (see ElementData::TrySetW)
+template <typename Scalar>
+CompositionStatus ScalarCompositionBatch<Scalar>::checkSetW(size_t element) const noexcept
+{
+    if (element == mvPartition.Major)
+        return CompositionStatus::MajorElement;
+    if (mvIsCompositionLocked && !mvIsVariable[element])
+        return CompositionStatus::LockedElement;
+    if (mvIsCompositionLocked)
+        return CompositionStatus::LockedMassFraction;
+    return CompositionStatus::Ok;
+}
+
+/// Prints the error message of the setters, if any
+template <typename Scalar>
+void ScalarCompositionBatch<Scalar>::printSetError(CompositionStatus status, char fraction, size_t element) const
+{
+    if (status != CompositionStatus::Ok)
+        CompositionDiagnostics::PrintSetError(status, fraction, mvSymbols[element].c_str(), "CompositionBatch");
+}
+
+/** @brief Set mole fraction of element in one row. Prints an error message if
+ * it cannot be set (see TrySetX)
+ *
+ * @param element Index of the element
+ * @param row The row
+ * @param x Mole fraction
+ */
+template <typename Scalar>
+void ScalarCompositionBatch<Scalar>::SetX(size_t element, size_t row, Scalar x)
+{
+    printSetError(TrySetX(element, row, x), 'X', element);
+}
+
+/** @brief Set weight fraction of element in one row. Prints an error message
+ * if it cannot be set (see TrySetW)
+ *
+ * @param element Index of the element
+ * @param row The row
+ * @param w Weight fraction
+ */
+template <typename Scalar>
+void ScalarCompositionBatch<Scalar>::SetW(size_t element, size_t row, Scalar w)
+{
+    printSetError(TrySetW(element, row, w), 'W', element);
+}
+
+/** @brief Set mole fractions of element in all rows. Prints an error message
+ * if they cannot be set (see TrySetX)
+ *
+ * @param element Index of the element
+ * @param x Array with Size() mole fractions
+ */
+template <typename Scalar>
+void ScalarCompositionBatch<Scalar>::SetX(size_t element, const Scalar* x)
+{
+    printSetError(TrySetX(element, x), 'X', element);
+}
+
+/** @brief Set weight fractions of element in all rows. Prints an error
+ * message if they cannot be set (see TrySetW)
+ *
+ * @param element Index of the element
+ * @param w Array with Size() weight fractions
+ */
+template <typename Scalar>
+void ScalarCompositionBatch<Scalar>::SetW(size_t element, const Scalar* w)
+{
+    printSetError(TrySetW(element, w), 'W', element);
+}
+
+/** @brief Set mole fraction of element in one row. Never prints (see
+ * ElementData::TrySetX)
+ *
+ * @param element Index of the element
+ * @param row The row
+ * @param x Mole fraction
+ *
+ * @return CompositionStatus::Ok, or the error
+ */
+template <typename Scalar>
+CompositionStatus ScalarCompositionBatch<Scalar>::TrySetX(size_t element, size_t row, Scalar x) noexcept
+{
+    CompositionStatus status = checkSetX(element);
+    if (status != CompositionStatus::Ok)
+        return CompositionDiagnostics::Report(status, mvSymbols[element].c_str());
+
+    size_t i = element * mvSize + row;
+    mvUserX[i] = mvX[i] = x;
+    mvUserW[i] = mvW[i] = mvU[i] = 0;
+    mvIsUpdated[i] = false;
+    return CompositionStatus::Ok;
+}
+
+/** @brief Set weight fraction of element in one row. Never prints (see
+ * ElementData::TrySetW)
+ *
+ * @param element Index of the element
+ * @param row The row
+ * @param w Weight fraction
+ *
+ * @return CompositionStatus::Ok, or the error
+ */
+template <typename Scalar>
+CompositionStatus ScalarCompositionBatch<Scalar>::TrySetW(size_t element, size_t row, Scalar w) noexcept
+{
+    CompositionStatus status = checkSetW(element);
+    if (status != CompositionStatus::Ok)
+        return CompositionDiagnostics::Report(status, mvSymbols[element].c_str());
+
+    size_t i = element * mvSize + row;
+    mvUserW[i] = mvW[i] = w;
+    mvUserX[i] = mvX[i] = mvU[i] = 0;
+    mvIsUpdated[i] = false;
+    return CompositionStatus::Ok;
+}
+
+/** @brief Set mole fractions of element in all rows. Never prints (see
+ * ElementData::TrySetX). The error is reported once for all rows
+ *
+ * @param element Index of the element
+ * @param x Array with Size() mole fractions
+ *
+ * @return CompositionStatus::Ok, or the error
+ */
+template <typename Scalar>
+CompositionStatus ScalarCompositionBatch<Scalar>::TrySetX(size_t element, const Scalar* x) noexcept
+{
+    CompositionStatus status = checkSetX(element);
+    if (status != CompositionStatus::Ok)
+        return CompositionDiagnostics::Report(status, mvSymbols[element].c_str());
+
+    for (size_t r = 0, i = element * mvSize; r < mvSize; r++, i++) {
+        mvUserX[i] = mvX[i] = x[r];
+        mvUserW[i] = mvW[i] = mvU[i] = 0;
+        mvIsUpdated[i] = false;
+    }
+    return CompositionStatus::Ok;
+}
+
+/** @brief Set weight fractions of element in all rows. Never prints (see
+ * ElementData::TrySetW). The error is reported once for all rows
+ *
+ * @param element Index of the element
+ * @param w Array with Size() weight fractions
+ *
+ * @return CompositionStatus::Ok, or the error
+ */
+template <typename Scalar>
+CompositionStatus ScalarCompositionBatch<Scalar>::TrySetW(size_t element, const Scalar* w) noexcept
+{
+    CompositionStatus status = checkSetW(element);
+    if (status != CompositionStatus::Ok)
+        return CompositionDiagnostics::Report(status, mvSymbols[element].c_str());
+
+    for (size_t r = 0, i = element * mvSize; r < mvSize; r++, i++) {
+        mvUserW[i] = mvW[i] = w[r];
+        mvUserX[i] = mvX[i] = mvU[i] = 0;
+        mvIsUpdated[i] = false;
+    }
+    return CompositionStatus::Ok;
+}
+
+/** @brief Checks if a batch has the same element definitions as this one:
+ * symbols, molar masses, and major, interstitial and variable elements
+ *
+ * @param batch The batch
+ *
+ * @return true if the element definitions are the same
+ */
+template <typename Scalar>
+bool ScalarCompositionBatch<Scalar>::HasSameLayout(const ScalarCompositionBatch& batch) const
+{
+    return mvSymbols == batch.mvSymbols && mvMolarMasses == batch.mvMolarMasses
+        && mvIsInterstitial == batch.mvIsInterstitial && mvIsVariable == batch.mvIsVariable
+        && mvPartition.Major == batch.mvPartition.Major;
+}
+
+/** @brief Checks if a composition has the same element definitions as the
+ * batch: symbols, molar masses, and major, interstitial and variable elements
+ *
+ * @param comp The composition
+ *
+ * @return true if the element definitions are the same
+ */
+template <typename Scalar>
+bool ScalarCompositionBatch<Scalar>::HasSameLayout(const Composition& comp) const
+{
+    if (comp.mvpLayout->NumberOfElements != mvSymbols.size())
+        return false;
+    for (size_t e = 0; e < mvSymbols.size(); e++) {
+        const ElementData& el = comp.element(e);
+        if (mvSymbols[e] != el.mvSymbol || mvMolarMasses[e] != static_cast<Scalar>(el.mvMolarMass)
+            || mvIsInterstitial[e] != el.mvIsInterstitial || mvIsVariable[e] != el.mvIsVariable
+            || (e == mvPartition.Major) != el.mvIsMajor)
+            return false;
+    }
+    return true;
+}
+
+/// Checks if a composition has the same element definitions as the batch
+template <typename Scalar>
+void ScalarCompositionBatch<Scalar>::checkPrototype(const Composition& comp) const
+{
+    if (!HasSameLayout(comp)) {
+        throw std::runtime_error("CompositionBatch: composition has different element definitions");
+    }
+}
+
+/** @brief Copies the fractions of a composition into a row, rounded to
+ * Scalar
+ *
+ * @param row The row
+ * @param comp Composition with the same element definitions as the batch
+ */
+template <typename Scalar>
+void ScalarCompositionBatch<Scalar>::Load(size_t row, const Composition& comp)
+{
+    checkPrototype(comp);
+
+    for (size_t e = 0; e < mvSymbols.size(); e++) {
+        const ElementData& el = comp.element(e);
+        size_t i = e * mvSize + row;
+        mvUserX[i] = static_cast<Scalar>(el.mvUserX);
+        mvUserW[i] = static_cast<Scalar>(el.mvUserW);
+        mvX[i] = static_cast<Scalar>(el.mvX);
+        mvW[i] = static_cast<Scalar>(el.mvW);
+        mvU[i] = static_cast<Scalar>(el.mvU);
+        mvIsUpdated[i] = el.mvIsUpdated;
+    }
+
+    mvMolarMassAvg[row] = static_cast<Scalar>(comp.mvMolarMassAvg);
+    mvMolarMassAvgFixedPartial[row] = static_cast<Scalar>(comp.mvMolarMassAvgFixedPartial);
+    mvXSumSubstitutionalFixedPartial[row] = static_cast<Scalar>(comp.mvXSumSubstitutionalFixedPartial);
+}
+
+/** @brief Copies the fractions of a row into a composition, converted to
+ * double. The lock state of the composition is not changed
+ *
+ * @param row The row
+ * @param comp Composition with the same element definitions as the batch
+ */
+template <typename Scalar>
+void ScalarCompositionBatch<Scalar>::Store(size_t row, Composition& comp) const
+{
+    checkPrototype(comp);
+
+    for (size_t e = 0; e < mvSymbols.size(); e++) {
+        ElementData& el = comp.element(e);
+        size_t i = e * mvSize + row;
+        el.mvUserX = static_cast<double>(mvUserX[i]);
+        el.mvUserW = static_cast<double>(mvUserW[i]);
+        el.mvX = static_cast<double>(mvX[i]);
+        el.mvW = static_cast<double>(mvW[i]);
+        el.mvU = static_cast<double>(mvU[i]);
+        el.mvIsUpdated = mvIsUpdated[i];
+    }
+
+    comp.mvMolarMassAvg = static_cast<double>(mvMolarMassAvg[row]);
+    comp.mvMolarMassAvgFixedPartial = static_cast<double>(mvMolarMassAvgFixedPartial[row]);
+    comp.mvXSumSubstitutionalFixedPartial = static_cast<double>(mvXSumSubstitutionalFixedPartial[row]);
+}
+
+/// @brief Locks all compositions, i.e., keeps site fraction of non-variable elements fixed
+template <typename Scalar>
+void ScalarCompositionBatch<Scalar>::LockComposition()
+{
+    updateFractions(false, 0, mvSize);
+
+    mvIsCompositionLocked = true;
+}
+
+/// @brief Unlocks all compositions (see LockComposition)
+template <typename Scalar>
+void ScalarCompositionBatch<Scalar>::UnlockComposition()
+{
+    mvIsCompositionLocked = false;
+}
+
+/// @brief Updates fractions of all compositions
+template <typename Scalar>
+void ScalarCompositionBatch<Scalar>::UpdateFractions()
+{
+    updateFractions(mvIsCompositionLocked, 0, mvSize);
+}
+
+/** @brief Updates fractions of the compositions in a range of rows. Rows are
+ * independent, so disjoint ranges can be updated concurrently (see
+ * ConvertParallel)
+ *
+ * @param beginRow First row
+ * @param endRow One past the last row
+ */
+template <typename Scalar>
+void ScalarCompositionBatch<Scalar>::UpdateFractions(size_t beginRow, size_t endRow)
+{
+    updateFractions(mvIsCompositionLocked, beginRow, std::min(endRow, mvSize));
+}
+
+/** @brief Updates the fractions with the vectorized kernels and the remaining
+ * rows with the scalar algorithms
+ *
+ * @param isLocked If true, uses the locked algorithm
+ * @param begin First row
+ * @param end One past the last row
+ */
+template <typename Scalar>
+void ScalarCompositionBatch<Scalar>::updateFractions(bool isLocked, size_t begin, size_t end)
+{
+    COMPOSITION_SCOPED_TIMER(BatchUpdateFractions);
+    COMPOSITION_COUNT(BatchUpdate);
+    COMPOSITION_COUNT_N(BatchRows, end > begin ? end - begin : 0);
+
+    const CompositionSimd::BasicKernels<Scalar>* kernels = getKernels<Scalar>(mvInstructionSet);
+
+    size_t r = begin;
+    if (kernels != nullptr) {
+        auto range = [](const std::vector<size_t>& indices) {
+            return CompositionSimd::IndexRange { indices.data(), indices.data() + indices.size() };
+        };
+        CompositionSimd::BasicBatchData<Scalar> data = {
+            mvSize,
+            mvMolarMasses.data(),
+            mvPartition.Major,
+            range(mvPartition.Alloying),
+            range(mvPartition.Interstitial),
+            range(mvPartition.VariableInterstitial),
+            range(mvPartition.VariableSubstitutional),
+            range(mvPartition.FixedInterstitial),
+            range(mvPartition.Variable),
+            range(mvPartition.Fixed),
+            mvUserX.data(),
+            mvUserW.data(),
+            mvX.data(),
+            mvW.data(),
+            mvU.data(),
+            mvIsUpdated.data(),
+            mvMolarMassAvg.data(),
+            mvMolarMassAvgFixedPartial.data(),
+            mvXSumSubstitutionalFixedPartial.data(),
+        };
+        r += isLocked ? kernels->UpdateFractionsUFixed(data, begin, end) : kernels->UpdateFractions(data, begin, end);
+    }
+
+    for (; r < end; r++) {
+        RowAccessor el { *this, r };
+        if (!isLocked) {
+            CompositionKernels::UpdateFractions(el, mvPartition, mvMolarMassAvg[r],
+                mvMolarMassAvgFixedPartial[r], mvXSumSubstitutionalFixedPartial[r]);
+        } else {
+            CompositionKernels::UpdateFractionsUFixed(el, mvPartition, mvMolarMassAvg[r],
+                mvMolarMassAvgFixedPartial[r], mvXSumSubstitutionalFixedPartial[r]);
+        }
+    }
+}
+
+/** @brief Computes the Jacobians of the fractions of a row with respect to
+ * the fractions of the independent elements, as Composition::GetJacobian.
+ * The row must be updated (see UpdateFractions). The derivatives are computed
+ * in double. Different rows can be computed concurrently
+ *
+ * @param row The row
+ * @param jacobian The Jacobians (output)
+ */
+template <typename Scalar>
+void ScalarCompositionBatch<Scalar>::GetJacobian(size_t row, CompositionJacobian& jacobian) const
+{
+    jacobian.Columns.clear();
+    for (size_t e = 0; e < mvSymbols.size(); e++) {
+        if (e != mvPartition.Major && (!mvIsCompositionLocked || mvIsVariable[e]))
+            jacobian.Columns.push_back(e);
+    }
+    jacobian.Resize(mvSymbols.size());
+
+    // The accessor is only used for reading
+    RowAccessor el { const_cast<ScalarCompositionBatch&>(*this), row };
+    CompositionKernels::Jacobians(el, mvPartition, mvIsCompositionLocked, mvMolarMassAvg[row],
+        mvMolarMassAvgFixedPartial[row], mvXSumSubstitutionalFixedPartial[row], jacobian);
+}
+
+template class ScalarCompositionBatch<float>;
+template class ScalarCompositionBatch<double>;
+template class ScalarCompositionBatch<long double>;
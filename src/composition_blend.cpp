@@ -0,0 +1,92 @@
+#include "composition_blend.hpp"
+#include <stdexcept>
+
+/** @brief Constructor of CompositionBlender
+ *
+ * @param sources Batch with the source compositions, one per row, whose
+ * fractions are updated (see CompositionBatch::UpdateFractions)
+ */
+CompositionBlender::CompositionBlender(const CompositionBatch& sources)
+    : mvNumberOfSources(sources.Size())
+    , mvElements(sources)
+    , mvAlloying(sources.GetPartition().Alloying)
+{
+    mvElements.Resize(0);
+
+    // Sources as rows, so that each source adds a contiguous row to a mix
+    size_t nAlloying = mvAlloying.size();
+    mvSourceW.resize(mvNumberOfSources * nAlloying);
+    for (size_t a = 0; a < nAlloying; a++) {
+        const double* w = sources.W(mvAlloying[a]);
+        for (size_t s = 0; s < mvNumberOfSources; s++) {
+            mvSourceW[s * nAlloying + a] = w[s];
+        }
+    }
+}
+
+/// Checks if a batch has the same element definitions as the sources
+void CompositionBlender::checkMixes(const CompositionBatch& mixes) const
+{
+    if (!mvElements.HasSameLayout(mixes)) {
+        throw std::runtime_error("CompositionBlender: batch has different element definitions");
+    }
+}
+
+/** @brief Blends the sources into mixes and updates their fractions
+ *
+ * @param masses Matrix with the mass of each source in each mix, with one
+ * row of NumberOfSources() values per mix. Only the ratios of the masses of
+ * a mix matter (e.g., kg or fractions of the charge)
+ * @param numberOfMixes Number of mixes (rows of masses)
+ * @param mixes Batch with the same elements as the sources, resized to
+ * numberOfMixes rows and unlocked. Receives the fractions of the mixes
+ *
+ * @return CompositionStatus::Ok, or CompositionStatus::InvalidArgument if a
+ * mass is negative or the total mass of a mix is not positive, in which case
+ * mixes is not changed
+ */
+CompositionStatus CompositionBlender::Blend(const double* masses, size_t numberOfMixes, CompositionBatch& mixes) const
+{
+    checkMixes(mixes);
+
+    // Mass fractions of the alloying elements of the mixes, one column per
+    // element as in CompositionBatch. The masses are checked on the way, and
+    // mixes is only changed if they are all valid
+    size_t nAlloying = mvAlloying.size();
+    std::vector<double> mixW(nAlloying * numberOfMixes);
+    std::vector<double> sum(nAlloying);
+    for (size_t m = 0; m < numberOfMixes; m++) {
+        const double* row = masses + m * mvNumberOfSources;
+        double total = 0.0;
+        for (size_t a = 0; a < nAlloying; a++) {
+            sum[a] = 0.0;
+        }
+        for (size_t s = 0; s < mvNumberOfSources; s++) {
+            double mass = row[s];
+            if (mass == 0.0)
+                continue;
+            // Also false if the mass is NaN
+            if (!(mass > 0.0))
+                return CompositionDiagnostics::Report(CompositionStatus::InvalidArgument, nullptr);
+            total += mass;
+            const double* w = mvSourceW.data() + s * nAlloying;
+            for (size_t a = 0; a < nAlloying; a++) {
+                sum[a] += mass * w[a];
+            }
+        }
+        if (!(total > 0.0))
+            return CompositionDiagnostics::Report(CompositionStatus::InvalidArgument, nullptr);
+        for (size_t a = 0; a < nAlloying; a++) {
+            mixW[a * numberOfMixes + m] = sum[a] / total;
+        }
+    }
+
+    if (mixes.Size() != numberOfMixes)
+        mixes.Resize(numberOfMixes);
+    mixes.UnlockComposition();
+    for (size_t a = 0; a < nAlloying; a++) {
+        mixes.TrySetW(mvAlloying[a], mixW.data() + a * numberOfMixes);
+    }
+    mixes.UpdateFractions();
+    return CompositionStatus::Ok;
+}
@@ -0,0 +1,191 @@
+#include "composition_catalog.hpp"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+/** @brief Constructor of CompositionCatalog
+ *
+ * @param prototype Composition from which the element definitions are taken
+ * (see CompositionBatch)
+ */
+CompositionCatalog::CompositionCatalog(const Composition& prototype)
+    : mvBatch(prototype)
+{
+}
+
+/// Column of a fraction of an element
+const double* CompositionCatalog::column(size_t element, FieldFraction fraction) const
+{
+    switch (fraction) {
+    case FieldFraction::X:
+        return mvBatch.X(element);
+    case FieldFraction::W:
+        return mvBatch.W(element);
+    default:
+        return mvBatch.U(element);
+    }
+}
+
+/// Index of the fraction of the element of a range
+const CompositionCatalog::SortedColumn& CompositionCatalog::index(const Range& range) const
+{
+    return mvIndexes[3 * range.Element + static_cast<size_t>(range.Fraction)];
+}
+
+/** @brief Adds a grade to the catalog. Its fractions are converted by Build
+ *
+ * @param grade Composition with the same element definitions as the prototype
+ * @param name Name of the grade (optional)
+ *
+ * @return Index of the grade
+ */
+size_t CompositionCatalog::Add(const Composition& grade, std::string name)
+{
+    if (mvSize == std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("CompositionCatalog: too many grades");
+    }
+    if (mvSize == mvBatch.Size()) {
+        mvBatch.Resize(std::max<size_t>(2 * mvSize, 64));
+    }
+    mvBatch.Load(mvSize, grade);
+    mvNames.push_back(std::move(name));
+    mvIsBuilt = false;
+    return mvSize++;
+}
+
+/** @brief Converts the fractions of all grades and sorts them into the
+ * indexes. Must be called after adding grades and before querying them
+ */
+void CompositionCatalog::Build()
+{
+    mvBatch.Resize(mvSize);
+    mvBatch.UnlockComposition();
+    mvBatch.UpdateFractions();
+
+    size_t nElements = NumberOfElements();
+    mvIndexes.assign(3 * nElements, SortedColumn());
+    for (size_t e = 0; e < nElements; e++) {
+        for (FieldFraction fraction : { FieldFraction::X, FieldFraction::W, FieldFraction::U }) {
+            const double* values = column(e, fraction);
+            SortedColumn& sorted = mvIndexes[3 * e + static_cast<size_t>(fraction)];
+            sorted.Rows.resize(mvSize);
+            std::iota(sorted.Rows.begin(), sorted.Rows.end(), uint32_t(0));
+            std::sort(sorted.Rows.begin(), sorted.Rows.end(), [values](uint32_t a, uint32_t b) {
+                return values[a] < values[b] || (values[a] == values[b] && a < b);
+            });
+            sorted.Values.resize(mvSize);
+            for (size_t i = 0; i < mvSize; i++) {
+                sorted.Values[i] = values[sorted.Rows[i]];
+            }
+        }
+    }
+    mvIsBuilt = true;
+}
+
+/** @brief Copies the fractions of a grade into a composition (see
+ * CompositionBatch::Store)
+ *
+ * @param grade Index of the grade
+ * @param comp Composition with the same element definitions as the prototype
+ */
+void CompositionCatalog::Store(size_t grade, Composition& comp) const
+{
+    mvBatch.Store(grade, comp);
+}
+
+/// Checks that the catalog is built and that the elements of a query exist
+void CompositionCatalog::checkQuery(const std::vector<Range>& ranges) const
+{
+    if (!mvIsBuilt) {
+        throw std::runtime_error("CompositionCatalog: grades were added since the last Build");
+    }
+    for (const Range& range : ranges) {
+        if (range.Element >= NumberOfElements()) {
+            throw std::runtime_error("CompositionCatalog: element " + std::to_string(range.Element) + " is not defined");
+        }
+    }
+}
+
+/** @brief Calls f with the row of each grade whose fractions are in all
+ * ranges, in no particular order
+ *
+ * The rows of the range with fewest grades, found by binary searches in the
+ * indexes, are checked against the other ranges.
+ */
+template <typename F>
+void CompositionCatalog::forEachMatch(const std::vector<Range>& ranges, F f) const
+{
+    checkQuery(ranges);
+
+    const uint32_t* candidates = nullptr;
+    size_t nCandidates = mvSize;
+    size_t narrowest = ranges.size();
+    for (size_t i = 0; i < ranges.size(); i++) {
+        const Range& range = ranges[i];
+        // Also false if a bound is NaN
+        if (!(range.Min <= range.Max))
+            return;
+        const SortedColumn& sorted = index(range);
+        auto begin = std::lower_bound(sorted.Values.begin(), sorted.Values.end(), range.Min);
+        auto end = std::upper_bound(begin, sorted.Values.end(), range.Max);
+        size_t count = end - begin;
+        if (count == 0)
+            return;
+        if (count < nCandidates || narrowest == ranges.size()) {
+            candidates = sorted.Rows.data() + (begin - sorted.Values.begin());
+            nCandidates = count;
+            narrowest = i;
+        }
+    }
+
+    if (narrowest == ranges.size()) {
+        // No ranges: all grades
+        for (size_t row = 0; row < mvSize; row++) {
+            f(row);
+        }
+        return;
+    }
+
+    std::vector<const double*> columns(ranges.size());
+    for (size_t i = 0; i < ranges.size(); i++) {
+        columns[i] = column(ranges[i].Element, ranges[i].Fraction);
+    }
+    for (size_t c = 0; c < nCandidates; c++) {
+        size_t row = candidates[c];
+        bool isMatch = true;
+        for (size_t i = 0; i < ranges.size() && isMatch; i++) {
+            double value = columns[i][row];
+            isMatch = i == narrowest || (ranges[i].Min <= value && value <= ranges[i].Max);
+        }
+        if (isMatch)
+            f(row);
+    }
+}
+
+/** @brief Finds the grades whose fractions are in all given ranges
+ *
+ * @param ranges The ranges (all grades if empty)
+ *
+ * @return Indexes of the grades found, in increasing order
+ */
+std::vector<size_t> CompositionCatalog::Find(const std::vector<Range>& ranges) const
+{
+    std::vector<size_t> grades;
+    forEachMatch(ranges, [&grades](size_t row) { grades.push_back(row); });
+    std::sort(grades.begin(), grades.end());
+    return grades;
+}
+
+/** @brief Counts the grades whose fractions are in all given ranges (see Find)
+ *
+ * @param ranges The ranges (all grades if empty)
+ *
+ * @return Number of grades found
+ */
+size_t CompositionCatalog::Count(const std::vector<Range>& ranges) const
+{
+    size_t count = 0;
+    forEachMatch(ranges, [&count](size_t) { count++; });
+    return count;
+}
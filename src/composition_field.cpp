@@ -0,0 +1,209 @@
+#include "composition_field.hpp"
+#include "composition_sublattice.hpp"
+#include <algorithm>
+
+/** @brief Constructor of CompositionField
+ *
+ * @param prototype Composition from which the element definitions, the lock
+ * state and the fractions of the elements without input arrays are taken
+ * @param tileSize Number of cells per tile
+ */
+CompositionField::CompositionField(const Composition& prototype, size_t tileSize)
+    : mvPrototype(prototype, 1)
+    , mvTile(prototype, std::max<size_t>(tileSize, 1))
+{
+    mvPrototype.Load(0, prototype);
+    for (size_t r = 0; r < mvTile.Size(); r++) {
+        mvTile.Load(r, prototype);
+    }
+    mvPrototype.mvIsCompositionLocked = mvTile.mvIsCompositionLocked = prototype.IsCompositionLocked();
+
+    size_t nElements = NumberOfElements();
+    mvInputs.resize(nElements);
+    for (std::vector<Output>& outputs : mvOutputs) {
+        outputs.resize(nElements);
+    }
+}
+
+/** @brief Sets the input array of an element
+ *
+ * @param element Index of the element
+ * @param fraction FieldFraction::X or FieldFraction::W
+ * @param data Value of the first cell (nullptr to remove the input)
+ * @param stride Distance between the values of consecutive cells, in doubles
+ *
+ * @return CompositionStatus::Ok, or the error (see ElementData::TrySetX and
+ * TrySetW), or CompositionStatus::InvalidArgument for site fractions
+ */
+CompositionStatus CompositionField::SetInput(size_t element, FieldFraction fraction, const double* data, std::ptrdiff_t stride) noexcept
+{
+    if (fraction == FieldFraction::U)
+        return CompositionDiagnostics::Report(CompositionStatus::InvalidArgument, mvPrototype.mvSymbols[element].c_str());
+
+    CompositionStatus status = fraction == FieldFraction::X ? mvPrototype.checkSetX(element) : mvPrototype.checkSetW(element);
+    if (status != CompositionStatus::Ok)
+        return CompositionDiagnostics::Report(status, mvPrototype.mvSymbols[element].c_str());
+
+    mvInputs[element] = Input { data, stride, fraction };
+    return CompositionStatus::Ok;
+}
+
+/** @brief Sets an output array of an element. It can be the same as an input
+ * array
+ *
+ * @param element Index of the element
+ * @param fraction The fraction written into the array
+ * @param data Value of the first cell (nullptr to remove the output)
+ * @param stride Distance between the values of consecutive cells, in doubles
+ */
+void CompositionField::SetOutput(size_t element, FieldFraction fraction, double* data, std::ptrdiff_t stride) noexcept
+{
+    mvOutputs[static_cast<size_t>(fraction)][element] = Output { data, stride };
+}
+
+/** @brief Sets the output array of the average molar mass
+ *
+ * @param data Value of the first cell (nullptr to remove the output)
+ * @param stride Distance between the values of consecutive cells, in doubles
+ */
+void CompositionField::SetMolarMassAvgOutput(double* data, std::ptrdiff_t stride) noexcept
+{
+    mvMolarMassAvgOutput = Output { data, stride };
+}
+
+/** @brief Sets the sublattice model of the site fractions. The U outputs
+ * then receive the site fractions of the model. The model is not copied,
+ * and must outlive the field and its copies
+ *
+ * @param pSublattices Sublattice model with the same elements as the
+ * prototype (nullptr for the site fractions of the compositions)
+ *
+ * @return CompositionStatus::Ok, or CompositionStatus::InvalidArgument if
+ * the model has other elements, in which case the model is not changed.
+ * The vacancy outputs are removed in both cases
+ */
+CompositionStatus CompositionField::SetSublattices(const CompositionSublattices* pSublattices)
+{
+    if (pSublattices != nullptr && !pSublattices->HasSameElements(mvPrototype))
+        return CompositionDiagnostics::Report(CompositionStatus::InvalidArgument, nullptr);
+
+    mvpSublattices = pSublattices;
+    size_t nSublattices = pSublattices != nullptr ? pSublattices->NumberOfSublattices() : 0;
+    mvVacancyOutputs.assign(nSublattices, Output {});
+    mvSiteFractions.resize(pSublattices != nullptr ? NumberOfElements() * mvTile.Size() : 0);
+    mvVacancies.resize(nSublattices * mvTile.Size());
+    return CompositionStatus::Ok;
+}
+
+/** @brief Sets the output array of the site fraction of the vacancies of a
+ * sublattice of the sublattice model (see SetSublattices)
+ *
+ * @param sublattice Index of the sublattice
+ * @param data Value of the first cell (nullptr to remove the output)
+ * @param stride Distance between the values of consecutive cells, in doubles
+ *
+ * @return CompositionStatus::Ok, or CompositionStatus::InvalidArgument if
+ * there is no sublattice model or it has no such sublattice
+ */
+CompositionStatus CompositionField::SetVacancyOutput(size_t sublattice, double* data, std::ptrdiff_t stride) noexcept
+{
+    if (sublattice >= mvVacancyOutputs.size())
+        return CompositionDiagnostics::Report(CompositionStatus::InvalidArgument, nullptr);
+
+    mvVacancyOutputs[sublattice] = Output { data, stride };
+    return CompositionStatus::Ok;
+}
+
+/** @brief Converts the cells in a range, tile by tile
+ *
+ * @param beginCell First cell
+ * @param endCell One past the last cell
+ */
+void CompositionField::Convert(size_t beginCell, size_t endCell)
+{
+    for (size_t begin = beginCell; begin < endCell; begin += mvTile.Size()) {
+        convertTile(begin, std::min(mvTile.Size(), endCell - begin));
+    }
+}
+
+/** @brief Converts a tile: gathers its inputs into the rows of the tile
+ * batch, updates their fractions and scatters them into the outputs
+ *
+ * @param begin First cell of the tile
+ * @param count Number of cells of the tile
+ */
+void CompositionField::convertTile(size_t begin, size_t count)
+{
+    CompositionBatch& tile = mvTile;
+    const CompositionBatch& proto = mvPrototype;
+    size_t size = tile.mvSize;
+    std::ptrdiff_t offset = static_cast<std::ptrdiff_t>(begin);
+
+    for (size_t e = 0; e < NumberOfElements(); e++) {
+        const Input& input = mvInputs[e];
+        size_t col = e * size;
+
+        if (input.Data == nullptr) {
+            // Same fractions as the prototype
+            std::fill_n(&tile.mvUserX[col], count, proto.mvUserX[e]);
+            std::fill_n(&tile.mvUserW[col], count, proto.mvUserW[e]);
+            std::fill_n(&tile.mvX[col], count, proto.mvX[e]);
+            std::fill_n(&tile.mvW[col], count, proto.mvW[e]);
+            std::fill_n(&tile.mvU[col], count, proto.mvU[e]);
+            std::fill_n(&tile.mvIsUpdated[col], count, proto.mvIsUpdated[e]);
+            continue;
+        }
+
+        // Same as CompositionBatch::SetX and SetW
+        const double* in = input.Data + offset * input.Stride;
+        bool isX = input.Fraction == FieldFraction::X;
+        std::vector<double>& set = isX ? tile.mvUserX : tile.mvUserW;
+        std::vector<double>& calculated = isX ? tile.mvX : tile.mvW;
+        std::vector<double>& other = isX ? tile.mvUserW : tile.mvUserX;
+        std::vector<double>& otherCalculated = isX ? tile.mvW : tile.mvX;
+        for (size_t r = 0, i = col; r < count; r++, i++) {
+            set[i] = calculated[i] = in[static_cast<std::ptrdiff_t>(r) * input.Stride];
+            other[i] = otherCalculated[i] = tile.mvU[i] = 0.0;
+            tile.mvIsUpdated[i] = false;
+        }
+    }
+
+    tile.UpdateFractions(0, count);
+
+    const double* columns[3] = { tile.mvX.data(), tile.mvW.data(), tile.mvU.data() };
+    if (mvpSublattices != nullptr) {
+        // Site fractions of the model, while the tile is still in cache
+        mvpSublattices->GetSiteFractions(tile, 0, count, mvSiteFractions.data(), mvVacancies.data());
+        columns[2] = mvSiteFractions.data();
+        for (size_t s = 0; s < mvVacancyOutputs.size(); s++) {
+            const Output& output = mvVacancyOutputs[s];
+            if (output.Data == nullptr)
+                continue;
+            double* out = output.Data + offset * output.Stride;
+            const double* column = mvVacancies.data() + s * size;
+            for (size_t r = 0; r < count; r++) {
+                out[static_cast<std::ptrdiff_t>(r) * output.Stride] = column[r];
+            }
+        }
+    }
+
+    for (size_t k = 0; k < 3; k++) {
+        for (size_t e = 0; e < NumberOfElements(); e++) {
+            const Output& output = mvOutputs[k][e];
+            if (output.Data == nullptr)
+                continue;
+            double* out = output.Data + offset * output.Stride;
+            const double* column = columns[k] + e * size;
+            for (size_t r = 0; r < count; r++) {
+                out[static_cast<std::ptrdiff_t>(r) * output.Stride] = column[r];
+            }
+        }
+    }
+
+    if (mvMolarMassAvgOutput.Data != nullptr) {
+        double* out = mvMolarMassAvgOutput.Data + offset * mvMolarMassAvgOutput.Stride;
+        for (size_t r = 0; r < count; r++) {
+            out[static_cast<std::ptrdiff_t>(r) * mvMolarMassAvgOutput.Stride] = tile.mvMolarMassAvg[r];
+        }
+    }
+}
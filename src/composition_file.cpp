@@ -0,0 +1,273 @@
+#include "composition_file.hpp"
+#include <cstring>
+#include <stdexcept>
+
+static const char MAGIC[8] = { 'C', 'O', 'M', 'P', 'O', 'S', 'B', '\0' };
+
+/** @brief Size of the records of a file
+ *
+ * @param numberOfElements Number of elements
+ * @param contents Contents of the records (see CompositionFile::Contents)
+ *
+ * @return Size of each record, in bytes
+ */
+size_t CompositionFile::GetRecordSize(size_t numberOfElements, uint32_t contents)
+{
+    size_t nDoubles = 3;
+    if (contents & UserFractions)
+        nDoubles += 2 * numberOfElements;
+    if (contents & Fractions)
+        nDoubles += 3 * numberOfElements;
+    size_t nFlags = 1 + numberOfElements;
+    return sizeof(double) * nDoubles + (nFlags + 7) / 8 * 8;
+}
+
+/** @brief Checks if a composition has the element definitions of a file:
+ * the same symbols, flags and molar masses, in the same order
+ *
+ * @param elements Definitions of the elements of the file
+ * @param numberOfElements Number of elements of the file
+ * @param comp The composition
+ */
+bool CompositionFile::HasSameLayout(const Element* elements, size_t numberOfElements, const Composition& comp)
+{
+    if (comp.GetNumberOfElements() != numberOfElements)
+        return false;
+
+    size_t e = 0;
+    for (const ElementData& el : comp.GetElements()) {
+        const Element& element = elements[e++];
+        if (strncmp(element.Symbol, el.GetSymbol().c_str(), sizeof(element.Symbol)) != 0
+            || element.IsMajor != el.IsMajor()
+            || element.IsVariable != el.IsVariable()
+            || element.IsInterstitial != el.IsInterstitial()
+            || element.MolarMass != el.GetMolarMass()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** @brief Constructor of CompositionWriter. Writes the header and the
+ * definitions of the elements
+ *
+ * @param stream The file stream, opened in binary mode. Must be seekable,
+ * since the number of records is written by Close
+ * @param prototype Composition from which the element definitions are taken
+ * @param contents Contents of the records (see CompositionFile::Contents)
+ */
+CompositionWriter::CompositionWriter(FILE* stream, const Composition& prototype, uint32_t contents)
+    : mvpStream(stream)
+    , mvHeaderPosition(ftell(stream))
+    , mvHeader()
+    , mvpLayout(prototype.mvpLayout)
+{
+    size_t n = prototype.GetNumberOfElements();
+    memcpy(mvHeader.Magic, MAGIC, sizeof(MAGIC));
+    mvHeader.Version = CompositionFile::Version;
+    mvHeader.ByteOrder = CompositionFile::ByteOrder;
+    mvHeader.NumberOfElements = static_cast<uint32_t>(n);
+    mvHeader.Contents = contents & CompositionFile::AllContents;
+    mvHeader.RecordSize = static_cast<uint32_t>(CompositionFile::GetRecordSize(n, mvHeader.Contents));
+    mvHeader.RecordsOffset = static_cast<uint32_t>(sizeof(CompositionFile::Header) + n * sizeof(CompositionFile::Element));
+    mvHeader.NumberOfRecords = 0;
+    write(&mvHeader, sizeof(mvHeader));
+
+    for (const ElementData& el : prototype.GetElements()) {
+        CompositionFile::Element element = {};
+        strncpy(element.Symbol, el.mvSymbol, sizeof(element.Symbol) - 1);
+        element.IsMajor = el.mvIsMajor;
+        element.IsVariable = el.mvIsVariable;
+        element.IsInterstitial = el.mvIsInterstitial;
+        element.MolarMass = el.mvMolarMass;
+        write(&element, sizeof(element));
+        mvElements.push_back(element);
+    }
+
+    mvRecord.resize(mvHeader.RecordSize);
+}
+
+/// Writes data into the stream. Throws std::runtime_error if it fails
+void CompositionWriter::write(const void* data, size_t size)
+{
+    if (fwrite(data, 1, size, mvpStream) != size) {
+        throw std::runtime_error("CompositionWriter: Error! Could not write to file");
+    }
+}
+
+/** @brief Writes a composition. Locked compositions can only be written
+ * into files with the calculated fractions
+ *
+ * @param comp Composition with the same element definitions as the prototype
+ */
+void CompositionWriter::Write(const Composition& comp)
+{
+    if (comp.mvpLayout != mvpLayout && !CompositionFile::HasSameLayout(mvElements.data(), mvElements.size(), comp)) {
+        throw std::runtime_error("CompositionWriter::Write: composition has different element definitions");
+    }
+    if (comp.mvIsCompositionLocked && !(mvHeader.Contents & CompositionFile::Fractions)) {
+        // The site fractions of the fixed elements cannot be recovered from the user defined fractions
+        throw std::runtime_error("CompositionWriter::Write: locked compositions require CompositionFile::Fractions");
+    }
+
+    size_t n = mvElements.size();
+    double* values = reinterpret_cast<double*>(mvRecord.data());
+    *values++ = comp.mvMolarMassAvg;
+    *values++ = comp.mvMolarMassAvgFixedPartial;
+    *values++ = comp.mvXSumSubstitutionalFixedPartial;
+
+    if (mvHeader.Contents & CompositionFile::UserFractions) {
+        for (size_t e = 0; e < n; e++) {
+            values[e] = comp.element(e).mvUserX;
+            values[n + e] = comp.element(e).mvUserW;
+        }
+        values += 2 * n;
+    }
+
+    if (mvHeader.Contents & CompositionFile::Fractions) {
+        for (size_t e = 0; e < n; e++) {
+            values[e] = comp.element(e).mvX;
+            values[n + e] = comp.element(e).mvW;
+            values[2 * n + e] = comp.element(e).mvU;
+        }
+        values += 3 * n;
+    }
+
+    unsigned char* flags = reinterpret_cast<unsigned char*>(values);
+    flags[0] = comp.mvIsCompositionLocked;
+    for (size_t e = 0; e < n; e++) {
+        flags[1 + e] = comp.element(e).mvIsUpdated;
+    }
+
+    write(mvRecord.data(), mvRecord.size());
+    mvHeader.NumberOfRecords++;
+}
+
+/// @brief Writes the number of records into the header and moves back to
+/// the end of the file
+void CompositionWriter::Close()
+{
+    long end = ftell(mvpStream);
+    if (end < 0 || fseek(mvpStream, mvHeaderPosition, SEEK_SET) != 0) {
+        throw std::runtime_error("CompositionWriter: Error! File is not seekable");
+    }
+    write(&mvHeader, sizeof(mvHeader));
+    if (fseek(mvpStream, end, SEEK_SET) != 0 || fflush(mvpStream) != 0) {
+        throw std::runtime_error("CompositionWriter: Error! Could not write to file");
+    }
+}
+
+/** @brief Constructor of CompositionFileView. Throws std::runtime_error if
+ * the contents are not a valid file
+ *
+ * @param data Contents of the file, aligned to 8 bytes
+ * @param size Size of the contents, in bytes
+ */
+CompositionFileView::CompositionFileView(const void* data, size_t size)
+    : mvpData(static_cast<const unsigned char*>(data))
+    , mvpHeader(static_cast<const CompositionFile::Header*>(data))
+    , mvpElements(nullptr)
+{
+    if (reinterpret_cast<uintptr_t>(data) % alignof(double) != 0) {
+        throw std::runtime_error("CompositionFileView: Error! Contents must be aligned to 8 bytes");
+    }
+    if (size < sizeof(CompositionFile::Header) || memcmp(mvpHeader->Magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw std::runtime_error("CompositionFileView: Error! Not a composition file");
+    }
+    if (mvpHeader->ByteOrder != CompositionFile::ByteOrder) {
+        throw std::runtime_error("CompositionFileView: Error! File written with a different byte order");
+    }
+    if (mvpHeader->Version == 0 || mvpHeader->Version > CompositionFile::Version) {
+        throw std::runtime_error("CompositionFileView: Error! Unsupported version " + std::to_string(mvpHeader->Version));
+    }
+
+    size_t n = mvpHeader->NumberOfElements;
+    size_t recordsOffset = sizeof(CompositionFile::Header) + n * sizeof(CompositionFile::Element);
+    if (mvpHeader->RecordsOffset != recordsOffset
+        || mvpHeader->RecordSize != CompositionFile::GetRecordSize(n, mvpHeader->Contents)
+        || size < recordsOffset
+        || (size - recordsOffset) / mvpHeader->RecordSize < mvpHeader->NumberOfRecords) {
+        throw std::runtime_error("CompositionFileView: Error! Truncated or corrupted file");
+    }
+    mvpElements = reinterpret_cast<const CompositionFile::Element*>(mvpData + sizeof(CompositionFile::Header));
+}
+
+/// Copy constructor of CompositionFileView
+CompositionFileView::CompositionFileView(const CompositionFileView& other)
+    : mvpData(other.mvpData)
+    , mvpHeader(other.mvpHeader)
+    , mvpElements(other.mvpElements)
+    , mvpCheckedLayout(other.mvpCheckedLayout.load(std::memory_order_relaxed))
+{
+}
+
+/// Copy assignment of CompositionFileView
+CompositionFileView& CompositionFileView::operator=(const CompositionFileView& other)
+{
+    mvpData = other.mvpData;
+    mvpHeader = other.mvpHeader;
+    mvpElements = other.mvpElements;
+    mvpCheckedLayout.store(other.mvpCheckedLayout.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    return *this;
+}
+
+/// Checks if a composition has the element definitions of the file. Only
+/// the first composition of each class is compared element by element
+void CompositionFileView::checkLayout(const Composition& comp) const
+{
+    if (comp.mvpLayout == mvpCheckedLayout.load(std::memory_order_relaxed))
+        return;
+    if (!CompositionFile::HasSameLayout(mvpElements, NumberOfElements(), comp)) {
+        throw std::runtime_error("CompositionFileView::Load: composition has different element definitions");
+    }
+    mvpCheckedLayout.store(comp.mvpLayout, std::memory_order_relaxed);
+}
+
+/** @brief Copies a record into a composition, restoring its lock state and
+ * fixed partial components, so that it resumes without updating its fractions
+ *
+ * If the record has no calculated fractions, they are updated from the user
+ * defined fractions (see Composition::UpdateFractions). If it has no user
+ * defined fractions, the user defined mole fractions are set to the
+ * calculated ones, so later changes agree with the written composition up to
+ * rounding errors.
+ *
+ * @param i The record
+ * @param comp Composition with the same element definitions as the file
+ */
+void CompositionFileView::Load(size_t i, Composition& comp) const
+{
+    checkLayout(comp);
+
+    size_t n = NumberOfElements();
+    const double* userX = UserX(i);
+    const double* userW = UserW(i);
+    const double* x = X(i);
+    const double* w = W(i);
+    const double* u = U(i);
+    const unsigned char* isUpdated = flags(i) + 1;
+
+    for (size_t e = 0; e < n; e++) {
+        ElementData& el = comp.element(e);
+        el.mvUserX = userX != nullptr ? userX[e] : (el.mvIsMajor ? 0.0 : x[e]);
+        el.mvUserW = userW != nullptr ? userW[e] : 0.0;
+        if (x != nullptr) {
+            el.mvX = x[e];
+            el.mvW = w[e];
+            el.mvU = u[e];
+            el.mvIsUpdated = isUpdated[e];
+        } else {
+            el.mvX = el.mvUserX;
+            el.mvW = el.mvUserW;
+            el.mvU = 0.0;
+            el.mvIsUpdated = false;
+        }
+    }
+
+    comp.mvMolarMassAvg = GetMolarMassAvg(i);
+    comp.mvMolarMassAvgFixedPartial = *doubles(i, 1);
+    comp.mvXSumSubstitutionalFixedPartial = *doubles(i, 2);
+    comp.setCompositionLocked(IsCompositionLocked(i));
+    if (x == nullptr)
+        comp.UpdateFractions();
+}
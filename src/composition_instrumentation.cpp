@@ -0,0 +1,210 @@
+#include "composition_instrumentation.hpp"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace {
+using namespace CompositionInstrumentation;
+
+/// Counters of a thread. Only the thread writes them, with a relaxed load and
+/// store (no read-modify-write), but any thread can read them
+struct ThreadCounters {
+    std::atomic<unsigned long long> Events[EventCount] {};
+    std::atomic<unsigned long long> TimerCalls[TimerCount] {};
+    std::atomic<unsigned long long> TimerNanoseconds[TimerCount] {};
+
+    ThreadCounters();
+    ~ThreadCounters();
+
+    /// Adds the counters to the metrics
+    void addTo(Metrics& metrics) const
+    {
+        for (size_t i = 0; i < EventCount; i++)
+            metrics.Events[i] += Events[i].load(std::memory_order_relaxed);
+        for (size_t i = 0; i < TimerCount; i++) {
+            metrics.TimerCalls[i] += TimerCalls[i].load(std::memory_order_relaxed);
+            metrics.TimerNanoseconds[i] += TimerNanoseconds[i].load(std::memory_order_relaxed);
+        }
+    }
+};
+
+/// Counters of all threads
+struct Registry {
+    std::mutex Mutex; ///< Protects the members below
+    std::vector<const ThreadCounters*> Threads; ///< Counters of the running threads
+    Metrics Exited; ///< Sum of the counters of the exited threads
+    Metrics Baseline; ///< Sum of all counters at the last Reset
+};
+
+/// The registry. Never destroyed, since threads can exit after the static
+/// objects are destroyed
+Registry& registry()
+{
+    static Registry* pRegistry = new Registry;
+    return *pRegistry;
+}
+
+ThreadCounters::ThreadCounters()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.Mutex);
+    r.Threads.push_back(this);
+}
+
+ThreadCounters::~ThreadCounters()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.Mutex);
+    addTo(r.Exited);
+    r.Threads.erase(std::find(r.Threads.begin(), r.Threads.end(), this));
+}
+
+ThreadCounters& threadCounters()
+{
+    thread_local ThreadCounters counters;
+    return counters;
+}
+
+/// Increments a counter owned by the calling thread
+void add(std::atomic<unsigned long long>& counter, unsigned long long n)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+std::atomic<bool> gAreTimersEnabled { false };
+}
+
+/// Name of an event
+const char* CompositionInstrumentation::GetEventName(Event event) noexcept
+{
+    static const char* const names[EventCount] = { "UpdateUnlocked", "UpdateLocked", "LayoutBinding",
+        "LockComposition", "UnlockComposition",
+        "BatchUpdate", "BatchRows" };
+    return static_cast<size_t>(event) < EventCount ? names[static_cast<size_t>(event)] : "Unknown";
+}
+
+/// Name of a timer
+const char* CompositionInstrumentation::GetTimerName(Timer timer) noexcept
+{
+    static const char* const names[TimerCount] = { "UpdateFractions", "LockComposition", "BatchUpdateFractions" };
+    return static_cast<size_t>(timer) < TimerCount ? names[static_cast<size_t>(timer)] : "Unknown";
+}
+
+/** @brief Counts an event in the counters of the calling thread. Called by
+ * COMPOSITION_COUNT
+ *
+ * @param event The event
+ * @param n Number of occurrences
+ */
+void CompositionInstrumentation::Count(Event event, unsigned long long n) noexcept
+{
+    add(threadCounters().Events[static_cast<size_t>(event)], n);
+}
+
+/** @brief Adds a timed call to the timers of the calling thread (see ScopedTimer)
+ *
+ * @param timer The timer
+ * @param nanoseconds Duration of the call
+ */
+void CompositionInstrumentation::AddTime(Timer timer, unsigned long long nanoseconds) noexcept
+{
+    ThreadCounters& counters = threadCounters();
+    add(counters.TimerCalls[static_cast<size_t>(timer)], 1);
+    add(counters.TimerNanoseconds[static_cast<size_t>(timer)], nanoseconds);
+}
+
+/// Enables or disables the timers (disabled by default, since reading the
+/// clock costs more than the fastest timed operations)
+void CompositionInstrumentation::SetTimersEnabled(bool isEnabled) noexcept
+{
+    gAreTimersEnabled.store(isEnabled, std::memory_order_relaxed);
+}
+
+/// Whether the timers are enabled (see SetTimersEnabled)
+bool CompositionInstrumentation::AreTimersEnabled() noexcept
+{
+    return gAreTimersEnabled.load(std::memory_order_relaxed);
+}
+
+/** @brief Gets the counters and timers summed over all threads since the
+ * last Reset. Can be called from any thread, while the counters are updated
+ *
+ * @return The metrics
+ */
+CompositionInstrumentation::Metrics CompositionInstrumentation::GetMetrics()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.Mutex);
+
+    Metrics metrics = r.Exited;
+    for (const ThreadCounters* pCounters : r.Threads) {
+        pCounters->addTo(metrics);
+    }
+
+    for (size_t i = 0; i < EventCount; i++)
+        metrics.Events[i] -= r.Baseline.Events[i];
+    for (size_t i = 0; i < TimerCount; i++) {
+        metrics.TimerCalls[i] -= r.Baseline.TimerCalls[i];
+        metrics.TimerNanoseconds[i] -= r.Baseline.TimerNanoseconds[i];
+    }
+    return metrics;
+}
+
+/// Sets all counters and timers to zero, for all threads
+void CompositionInstrumentation::Reset()
+{
+    Metrics metrics = GetMetrics();
+
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.Mutex);
+    for (size_t i = 0; i < EventCount; i++)
+        r.Baseline.Events[i] += metrics.Events[i];
+    for (size_t i = 0; i < TimerCount; i++) {
+        r.Baseline.TimerCalls[i] += metrics.TimerCalls[i];
+        r.Baseline.TimerNanoseconds[i] += metrics.TimerNanoseconds[i];
+    }
+}
+
+/** @brief Writes metrics as a JSON object
+ *
+ * @param stream The file stream
+ * @param metrics The metrics (see GetMetrics)
+ *
+ * @return False if writing failed
+ */
+bool CompositionInstrumentation::WriteJson(FILE* stream, const Metrics& metrics)
+{
+    fprintf(stream, "{\n  \"enabled\": %s,\n  \"events\": {\n", IsEnabled() ? "true" : "false");
+    for (size_t i = 0; i < EventCount; i++) {
+        fprintf(stream, "    \"%s\": %llu%s\n", GetEventName(static_cast<Event>(i)), metrics.Events[i],
+            i + 1 < EventCount ? "," : "");
+    }
+    fprintf(stream, "  },\n  \"timers\": {\n");
+    for (size_t i = 0; i < TimerCount; i++) {
+        fprintf(stream, "    \"%s\": { \"calls\": %llu, \"nanoseconds\": %llu }%s\n", GetTimerName(static_cast<Timer>(i)),
+            metrics.TimerCalls[i], metrics.TimerNanoseconds[i], i + 1 < TimerCount ? "," : "");
+    }
+    fprintf(stream, "  }\n}\n");
+    return !ferror(stream);
+}
+
+/** @brief Writes metrics as CSV, one line per event and timer
+ *
+ * @param stream The file stream
+ * @param metrics The metrics (see GetMetrics)
+ *
+ * @return False if writing failed
+ */
+bool CompositionInstrumentation::WriteCsv(FILE* stream, const Metrics& metrics)
+{
+    fprintf(stream, "type,name,count,nanoseconds\n");
+    for (size_t i = 0; i < EventCount; i++) {
+        fprintf(stream, "event,%s,%llu,\n", GetEventName(static_cast<Event>(i)), metrics.Events[i]);
+    }
+    for (size_t i = 0; i < TimerCount; i++) {
+        fprintf(stream, "timer,%s,%llu,%llu\n", GetTimerName(static_cast<Timer>(i)),
+            metrics.TimerCalls[i], metrics.TimerNanoseconds[i]);
+    }
+    return !ferror(stream);
+}
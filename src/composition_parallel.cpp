@@ -0,0 +1,216 @@
+#include "composition_parallel.hpp"
+
+/// Pool whose tasks are run by the current thread, used to run nested calls
+/// to WorkStealingThreadPool::Run sequentially
+static thread_local const WorkStealingThreadPool* tpCurrentPool = nullptr;
+
+/** @brief Runs all tasks in the calling thread
+ *
+ * @param count Number of tasks
+ * @param task The task
+ */
+void SequentialExecutor::Run(size_t count, const std::function<void(size_t)>& task)
+{
+    for (size_t i = 0; i < count; i++) {
+        task(i);
+    }
+}
+
+/** @brief Constructor of WorkStealingThreadPool
+ *
+ * @param numberOfThreads Number of threads running the tasks, including the
+ * thread calling Run. If 0, the number of cores is used
+ */
+WorkStealingThreadPool::WorkStealingThreadPool(size_t numberOfThreads)
+{
+    if (numberOfThreads == 0) {
+        numberOfThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    mvNumberOfSlots = numberOfThreads;
+    mvpSlots.reset(new Slot[mvNumberOfSlots]);
+
+    for (size_t slot = 0; slot + 1 < mvNumberOfSlots; slot++) {
+        mvWorkers.emplace_back(&WorkStealingThreadPool::workerLoop, this, slot);
+    }
+}
+
+/// Destructor. Waits for the workers to exit
+WorkStealingThreadPool::~WorkStealingThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mvMutex);
+        mvIsStopping = true;
+    }
+    mvCondition.notify_all();
+    for (std::thread& worker : mvWorkers) {
+        worker.join();
+    }
+}
+
+/// Gets the default pool, with one thread per core
+WorkStealingThreadPool& WorkStealingThreadPool::Default()
+{
+    static WorkStealingThreadPool pool;
+    return pool;
+}
+
+/// Takes the next task from the front of the range of a slot
+bool WorkStealingThreadPool::popTask(size_t slot, size_t& task)
+{
+    Slot& s = mvpSlots[slot];
+    std::lock_guard<std::mutex> lock(s.Mutex);
+    if (s.Begin == s.End)
+        return false;
+    task = s.Begin++;
+    return true;
+}
+
+/// Steals the back half of the range of another slot. Takes its first task
+/// and moves the remaining ones to the range of the slot, which is empty
+bool WorkStealingThreadPool::stealTask(size_t slot, size_t& task)
+{
+    for (size_t k = 1; k < mvNumberOfSlots; k++) {
+        Slot& victim = mvpSlots[(slot + k) % mvNumberOfSlots];
+        size_t begin, end;
+        {
+            std::lock_guard<std::mutex> lock(victim.Mutex);
+            size_t count = victim.End - victim.Begin;
+            if (count == 0)
+                continue;
+            end = victim.End;
+            begin = victim.End - (count + 1) / 2;
+            victim.End = begin;
+        }
+
+        task = begin;
+        Slot& own = mvpSlots[slot];
+        std::lock_guard<std::mutex> lock(own.Mutex);
+        own.Begin = begin + 1;
+        own.End = end;
+        return true;
+    }
+    return false;
+}
+
+/// Runs tasks of the current run until there are none left to run or steal
+void WorkStealingThreadPool::work(size_t slot)
+{
+    size_t task;
+    while (popTask(slot, task) || stealTask(slot, task)) {
+        try {
+            (*mvpTask)(task);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mvMutex);
+            if (!mvException)
+                mvException = std::current_exception();
+        }
+
+        if (mvRemaining.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> lock(mvMutex);
+            mvCondition.notify_all();
+        }
+    }
+}
+
+/// Loop of the worker threads, which wait for runs and work on them
+void WorkStealingThreadPool::workerLoop(size_t slot)
+{
+    tpCurrentPool = this;
+    size_t generation = 0;
+
+    std::unique_lock<std::mutex> lock(mvMutex);
+    while (true) {
+        mvCondition.wait(lock, [&] { return mvIsStopping || mvGeneration != generation; });
+        if (mvIsStopping)
+            return;
+        generation = mvGeneration;
+        mvActiveWorkers++;
+        lock.unlock();
+
+        work(slot);
+
+        lock.lock();
+        mvActiveWorkers--;
+        mvCondition.notify_all();
+    }
+}
+
+/** @brief Runs task(i) for all i in [0, count) in the threads of the pool,
+ * including the calling thread, and returns when all of them are finished
+ *
+ * @param count Number of tasks
+ * @param task The task
+ */
+void WorkStealingThreadPool::Run(size_t count, const std::function<void(size_t)>& task)
+{
+    if (count == 0)
+        return;
+
+    if (mvNumberOfSlots == 1 || tpCurrentPool == this) {
+        SequentialExecutor().Run(count, task);
+        return;
+    }
+
+    std::lock_guard<std::mutex> runLock(mvRunMutex);
+    mvpTask = &task;
+    mvRemaining = count;
+    mvException = nullptr;
+
+    // Splits the tasks evenly between the threads
+    for (size_t slot = 0; slot < mvNumberOfSlots; slot++) {
+        std::lock_guard<std::mutex> lock(mvpSlots[slot].Mutex);
+        mvpSlots[slot].Begin = count * slot / mvNumberOfSlots;
+        mvpSlots[slot].End = count * (slot + 1) / mvNumberOfSlots;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mvMutex);
+        mvGeneration++;
+    }
+    mvCondition.notify_all();
+
+    const WorkStealingThreadPool* pPreviousPool = tpCurrentPool;
+    tpCurrentPool = this;
+    work(mvNumberOfSlots - 1);
+    tpCurrentPool = pPreviousPool;
+
+    std::unique_lock<std::mutex> lock(mvMutex);
+    mvCondition.wait(lock, [&] { return mvRemaining == 0 && mvActiveWorkers == 0; });
+    mvpTask = nullptr;
+
+    if (mvException) {
+        std::exception_ptr exception = mvException;
+        mvException = nullptr;
+        std::rethrow_exception(exception);
+    }
+}
+
+/** @brief Updates the fractions of all compositions (rows) of a batch in
+ * parallel (see ConvertParallel for ranges of compositions)
+ *
+ * The rows are split into blocks of ParallelOptions::GrainSize rows, rounded
+ * up to a multiple of the vector width of the batch (see
+ * ScalarCompositionBatch::GetVectorWidth). Since each row goes through the
+ * same operations regardless of how the rows are split, the results are
+ * identical to ScalarCompositionBatch::UpdateFractions().
+ *
+ * @param batch The batch
+ * @param options The options
+ */
+template <typename Scalar>
+void ConvertParallel(ScalarCompositionBatch<Scalar>& batch, const ParallelOptions& options)
+{
+    size_t vectorWidth = batch.GetVectorWidth();
+    size_t grainSize = std::max<size_t>(options.GrainSize, 1);
+    grainSize = (grainSize + vectorWidth - 1) / vectorWidth * vectorWidth;
+    Executor& executor = options.pExecutor != nullptr ? *options.pExecutor : WorkStealingThreadPool::Default();
+
+    size_t size = batch.Size();
+    executor.Run((size + grainSize - 1) / grainSize, [&](size_t t) {
+        batch.UpdateFractions(t * grainSize, (t + 1) * grainSize);
+    });
+}
+
+template void ConvertParallel(ScalarCompositionBatch<float>&, const ParallelOptions&);
+template void ConvertParallel(ScalarCompositionBatch<double>&, const ParallelOptions&);
+template void ConvertParallel(ScalarCompositionBatch<long double>&, const ParallelOptions&);
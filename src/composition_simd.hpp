@@ -0,0 +1,81 @@
+/// @file composition_simd.hpp
+/// Internal interface between CompositionBatch and its vectorized kernels
+
+#ifndef COMPOSITION_SIMD_H
+#define COMPOSITION_SIMD_H
+
+#include <cstddef>
+
+namespace CompositionSimd {
+
+/// Range of element indices
+struct IndexRange {
+    const size_t* First; ///< First index
+    const size_t* Last; ///< One past the last index
+
+    const size_t* begin() const { return First; }
+    const size_t* end() const { return Last; }
+};
+
+/// Columns and element partition of a ScalarCompositionBatch passed to the
+/// kernels. The column of element e starts at e * Stride
+template <typename Scalar>
+struct BasicBatchData {
+    size_t Stride; ///< Number of rows of each column
+    const Scalar* MolarMasses; ///< Molar masses of the elements
+
+    size_t Major; ///< Index of the major element
+    IndexRange Alloying; ///< Indices of all alloying elements
+    IndexRange Interstitial; ///< Indices of interstitial elements
+    IndexRange VariableInterstitial; ///< Indices of variable interstitial elements
+    IndexRange VariableSubstitutional; ///< Indices of variable substitutional elements
+    IndexRange FixedInterstitial; ///< Indices of fixed interstitial elements
+    IndexRange Variable; ///< Indices of all variable elements
+    IndexRange Fixed; ///< Indices of all fixed elements
+
+    Scalar* UserX; ///< User defined mole fractions
+    Scalar* UserW; ///< User defined mass fractions
+    Scalar* X; ///< Calculated mole fractions
+    Scalar* W; ///< Calculated mass fractions
+    Scalar* U; ///< Calculated site fractions
+    unsigned char* IsUpdated; ///< If the fractions are updated
+
+    Scalar* MolarMassAvg; ///< Average molar mass of each row
+    Scalar* MolarMassAvgFixedPartial; ///< Fixed partial component of the molar mass of each row
+    Scalar* XSumSubstitutionalFixedPartial; ///< Fixed partial component of the fraction of substitutional elements of each row
+};
+
+typedef BasicBatchData<double> BatchData;
+
+/// Vectorized kernels for one instruction set and scalar type. Each kernel
+/// processes rows [begin, end) of a batch and returns the number of
+/// processed rows, which is a multiple of the vector width. The remaining
+/// rows have to be processed by the scalar path
+template <typename Scalar>
+struct BasicKernels {
+    typedef size_t (*Kernel)(const BasicBatchData<Scalar>& data, size_t begin, size_t end);
+
+    Kernel UpdateFractions; ///< Unlocked algorithm (see CompositionKernels::UpdateFractions)
+    Kernel UpdateFractionsUFixed; ///< Locked algorithm (see CompositionKernels::UpdateFractionsUFixed)
+};
+
+typedef BasicKernels<double> Kernels;
+typedef BasicKernels<float> KernelsFloat;
+
+/// Kernels compiled for SSE2 (nullptr if not available in this build)
+const Kernels* KernelsSSE2();
+/// Kernels compiled for AVX2 (nullptr if not available in this build)
+const Kernels* KernelsAVX2();
+/// Kernels compiled for AVX-512 (nullptr if not available in this build)
+const Kernels* KernelsAVX512();
+
+/// Single precision kernels compiled for SSE2 (nullptr if not available in this build)
+const KernelsFloat* KernelsFloatSSE2();
+/// Single precision kernels compiled for AVX2 (nullptr if not available in this build)
+const KernelsFloat* KernelsFloatAVX2();
+/// Single precision kernels compiled for AVX-512 (nullptr if not available in this build)
+const KernelsFloat* KernelsFloatAVX512();
+
+} // namespace CompositionSimd
+
+#endif
@@ -0,0 +1,112 @@
+/// @file composition_simd_avx2.cpp
+/// AVX2 kernels of ScalarCompositionBatch<double> (CompositionBatch) and ScalarCompositionBatch<float>. Compiled with -mavx2 (see CMakeLists.txt)
+
+#include "composition_simd.hpp"
+
+#if defined(__AVX2__)
+
+#include "composition_simd_kernels.hpp"
+#include <cstring>
+#include <immintrin.h>
+
+namespace {
+
+/// AVX2 vector operations used in composition_simd_kernels.hpp
+struct VectorAVX2 {
+    typedef double Scalar;
+    typedef __m256d Vector;
+    typedef __m256d Mask;
+    static const size_t Width = 4;
+
+    static Vector Load(const double* p) { return _mm256_loadu_pd(p); }
+    static void Store(double* p, Vector a) { _mm256_storeu_pd(p, a); }
+    static Vector Set1(double a) { return _mm256_set1_pd(a); }
+    static Vector Add(Vector a, Vector b) { return _mm256_add_pd(a, b); }
+    static Vector Sub(Vector a, Vector b) { return _mm256_sub_pd(a, b); }
+    static Vector Mul(Vector a, Vector b) { return _mm256_mul_pd(a, b); }
+    static Vector Div(Vector a, Vector b) { return _mm256_div_pd(a, b); }
+
+    static Mask True() { return _mm256_castsi256_pd(_mm256_set1_epi32(-1)); }
+    static Mask False() { return _mm256_setzero_pd(); }
+    static Mask GreaterThanZero(Vector a) { return _mm256_cmp_pd(a, _mm256_setzero_pd(), _CMP_GT_OQ); }
+    static Vector Select(Mask m, Vector a, Vector b) { return _mm256_blendv_pd(b, a, m); }
+    static Mask And(Mask a, Mask b) { return _mm256_and_pd(a, b); }
+    static Mask AndNot(Mask a, Mask b) { return _mm256_andnot_pd(a, b); }
+    static Mask Or(Mask a, Mask b) { return _mm256_or_pd(a, b); }
+    static Mask Not(Mask a) { return _mm256_xor_pd(a, True()); }
+    static bool Any(Mask a) { return _mm256_movemask_pd(a) != 0; }
+
+    static Mask LoadFlags(const unsigned char* p)
+    {
+        int flags;
+        std::memcpy(&flags, p, sizeof(flags));
+        __m256i wide = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(flags));
+        return Not(_mm256_castsi256_pd(_mm256_cmpeq_epi64(wide, _mm256_setzero_si256())));
+    }
+    static void StoreFlags(unsigned char* p, Mask m)
+    {
+        int bits = _mm256_movemask_pd(m);
+        for (size_t i = 0; i < Width; i++)
+            p[i] = (bits >> i) & 1;
+    }
+};
+
+/// AVX2 single precision vector operations used in composition_simd_kernels.hpp
+struct VectorFloatAVX2 {
+    typedef float Scalar;
+    typedef __m256 Vector;
+    typedef __m256 Mask;
+    static const size_t Width = 8;
+
+    static Vector Load(const float* p) { return _mm256_loadu_ps(p); }
+    static void Store(float* p, Vector a) { _mm256_storeu_ps(p, a); }
+    static Vector Set1(float a) { return _mm256_set1_ps(a); }
+    static Vector Add(Vector a, Vector b) { return _mm256_add_ps(a, b); }
+    static Vector Sub(Vector a, Vector b) { return _mm256_sub_ps(a, b); }
+    static Vector Mul(Vector a, Vector b) { return _mm256_mul_ps(a, b); }
+    static Vector Div(Vector a, Vector b) { return _mm256_div_ps(a, b); }
+
+    static Mask True() { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+    static Mask False() { return _mm256_setzero_ps(); }
+    static Mask GreaterThanZero(Vector a) { return _mm256_cmp_ps(a, _mm256_setzero_ps(), _CMP_GT_OQ); }
+    static Vector Select(Mask m, Vector a, Vector b) { return _mm256_blendv_ps(b, a, m); }
+    static Mask And(Mask a, Mask b) { return _mm256_and_ps(a, b); }
+    static Mask AndNot(Mask a, Mask b) { return _mm256_andnot_ps(a, b); }
+    static Mask Or(Mask a, Mask b) { return _mm256_or_ps(a, b); }
+    static Mask Not(Mask a) { return _mm256_xor_ps(a, True()); }
+    static bool Any(Mask a) { return _mm256_movemask_ps(a) != 0; }
+
+    static Mask LoadFlags(const unsigned char* p)
+    {
+        __m256i wide = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+        return Not(_mm256_castsi256_ps(_mm256_cmpeq_epi32(wide, _mm256_setzero_si256())));
+    }
+    static void StoreFlags(unsigned char* p, Mask m)
+    {
+        int bits = _mm256_movemask_ps(m);
+        for (size_t i = 0; i < Width; i++)
+            p[i] = (bits >> i) & 1;
+    }
+};
+
+const CompositionSimd::Kernels kernelsAVX2 = {
+    CompositionSimd::UpdateFractions<VectorAVX2>,
+    CompositionSimd::UpdateFractionsUFixed<VectorAVX2>,
+};
+
+const CompositionSimd::KernelsFloat kernelsFloatAVX2 = {
+    CompositionSimd::UpdateFractions<VectorFloatAVX2>,
+    CompositionSimd::UpdateFractionsUFixed<VectorFloatAVX2>,
+};
+
+} // namespace
+
+const CompositionSimd::Kernels* CompositionSimd::KernelsAVX2() { return &kernelsAVX2; }
+const CompositionSimd::KernelsFloat* CompositionSimd::KernelsFloatAVX2() { return &kernelsFloatAVX2; }
+
+#else
+
+const CompositionSimd::Kernels* CompositionSimd::KernelsAVX2() { return nullptr; }
+const CompositionSimd::KernelsFloat* CompositionSimd::KernelsFloatAVX2() { return nullptr; }
+
+#endif
@@ -0,0 +1,111 @@
+/// @file composition_simd_avx512.cpp
+/// AVX-512 kernels of ScalarCompositionBatch<double> (CompositionBatch) and ScalarCompositionBatch<float>. Compiled with -mavx512f (see CMakeLists.txt)
+
+#include "composition_simd.hpp"
+
+#if defined(__AVX512F__)
+
+#include "composition_simd_kernels.hpp"
+#include <immintrin.h>
+
+namespace {
+
+/// AVX-512 vector operations used in composition_simd_kernels.hpp
+struct VectorAVX512 {
+    typedef double Scalar;
+    typedef __m512d Vector;
+    typedef __mmask8 Mask;
+    static const size_t Width = 8;
+
+    static Vector Load(const double* p) { return _mm512_loadu_pd(p); }
+    static void Store(double* p, Vector a) { _mm512_storeu_pd(p, a); }
+    static Vector Set1(double a) { return _mm512_set1_pd(a); }
+    static Vector Add(Vector a, Vector b) { return _mm512_add_pd(a, b); }
+    static Vector Sub(Vector a, Vector b) { return _mm512_sub_pd(a, b); }
+    static Vector Mul(Vector a, Vector b) { return _mm512_mul_pd(a, b); }
+    static Vector Div(Vector a, Vector b) { return _mm512_div_pd(a, b); }
+
+    static Mask True() { return 0xFF; }
+    static Mask False() { return 0; }
+    static Mask GreaterThanZero(Vector a) { return _mm512_cmp_pd_mask(a, _mm512_setzero_pd(), _CMP_GT_OQ); }
+    static Vector Select(Mask m, Vector a, Vector b) { return _mm512_mask_blend_pd(m, b, a); }
+    static Mask And(Mask a, Mask b) { return a & b; }
+    static Mask AndNot(Mask a, Mask b) { return ~a & b; }
+    static Mask Or(Mask a, Mask b) { return a | b; }
+    static Mask Not(Mask a) { return ~a & 0xFF; }
+    static bool Any(Mask a) { return a != 0; }
+
+    static Mask LoadFlags(const unsigned char* p)
+    {
+        // The zero-masking variant with all lanes set is the same instruction,
+        // but does not start from _mm512_undefined_epi32, which GCC reports
+        // as maybe uninitialized
+        __m512i wide = _mm512_maskz_cvtepu8_epi64(0xFF, _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+        return _mm512_test_epi64_mask(wide, wide);
+    }
+    static void StoreFlags(unsigned char* p, Mask m)
+    {
+        for (size_t i = 0; i < Width; i++)
+            p[i] = (m >> i) & 1;
+    }
+};
+
+/// AVX-512 single precision vector operations used in composition_simd_kernels.hpp
+struct VectorFloatAVX512 {
+    typedef float Scalar;
+    typedef __m512 Vector;
+    typedef __mmask16 Mask;
+    static const size_t Width = 16;
+
+    static Vector Load(const float* p) { return _mm512_loadu_ps(p); }
+    static void Store(float* p, Vector a) { _mm512_storeu_ps(p, a); }
+    static Vector Set1(float a) { return _mm512_set1_ps(a); }
+    static Vector Add(Vector a, Vector b) { return _mm512_add_ps(a, b); }
+    static Vector Sub(Vector a, Vector b) { return _mm512_sub_ps(a, b); }
+    static Vector Mul(Vector a, Vector b) { return _mm512_mul_ps(a, b); }
+    static Vector Div(Vector a, Vector b) { return _mm512_div_ps(a, b); }
+
+    static Mask True() { return 0xFFFF; }
+    static Mask False() { return 0; }
+    static Mask GreaterThanZero(Vector a) { return _mm512_cmp_ps_mask(a, _mm512_setzero_ps(), _CMP_GT_OQ); }
+    static Vector Select(Mask m, Vector a, Vector b) { return _mm512_mask_blend_ps(m, b, a); }
+    static Mask And(Mask a, Mask b) { return a & b; }
+    static Mask AndNot(Mask a, Mask b) { return ~a & b; }
+    static Mask Or(Mask a, Mask b) { return a | b; }
+    static Mask Not(Mask a) { return ~a & 0xFFFF; }
+    static bool Any(Mask a) { return a != 0; }
+
+    static Mask LoadFlags(const unsigned char* p)
+    {
+        // Zero-masking variant for the same reason as VectorAVX512::LoadFlags
+        __m512i wide = _mm512_maskz_cvtepu8_epi32(0xFFFF, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+        return _mm512_test_epi32_mask(wide, wide);
+    }
+    static void StoreFlags(unsigned char* p, Mask m)
+    {
+        for (size_t i = 0; i < Width; i++)
+            p[i] = (m >> i) & 1;
+    }
+};
+
+const CompositionSimd::Kernels kernelsAVX512 = {
+    CompositionSimd::UpdateFractions<VectorAVX512>,
+    CompositionSimd::UpdateFractionsUFixed<VectorAVX512>,
+};
+
+const CompositionSimd::KernelsFloat kernelsFloatAVX512 = {
+    CompositionSimd::UpdateFractions<VectorFloatAVX512>,
+    CompositionSimd::UpdateFractionsUFixed<VectorFloatAVX512>,
+};
+
+} // namespace
+
+const CompositionSimd::Kernels* CompositionSimd::KernelsAVX512() { return &kernelsAVX512; }
+const CompositionSimd::KernelsFloat* CompositionSimd::KernelsFloatAVX512() { return &kernelsFloatAVX512; }
+
+#else
+
+const CompositionSimd::Kernels* CompositionSimd::KernelsAVX512() { return nullptr; }
+const CompositionSimd::KernelsFloat* CompositionSimd::KernelsFloatAVX512() { return nullptr; }
+
+#endif
@@ -0,0 +1,197 @@
+/// @file composition_simd_kernels.hpp
+/// Vectorized versions of the algorithms in CompositionKernels. They process
+/// V::Width rows of a CompositionBatch at once, replacing the branches of the
+/// scalar algorithms with masks. Every row goes through the same sequence of
+/// floating point operations as in the scalar algorithms, so the results are
+/// identical.
+///
+/// This header must only be included in the translation units compiled for
+/// the respective instruction set, and V is a struct (defined in each of
+/// them) with the vector operations:
+/// - `Scalar` (double or float), `Vector`, `Mask` and `Width`
+/// - `Load`, `Store`, `Set1`, `Add`, `Sub`, `Mul`, `Div`
+/// - `True`, `False`, `GreaterThanZero`, `Select(m, a, b)` (m ? a : b), `And`, `AndNot(a, b)` (!a && b), `Or`, `Not`, `Any`
+/// - `LoadFlags` (flag != 0), `StoreFlags`
+
+#ifndef COMPOSITION_SIMD_KERNELS_H
+#define COMPOSITION_SIMD_KERNELS_H
+
+#include "composition_simd.hpp"
+
+namespace CompositionSimd {
+namespace {
+
+    /// Vectorized CompositionKernels::UpdateFractions
+    template <typename V>
+    size_t UpdateFractions(const BasicBatchData<typename V::Scalar>& d, size_t begin, size_t end)
+    {
+        typedef typename V::Scalar Scalar;
+        typedef typename V::Vector Vector;
+        typedef typename V::Mask Mask;
+
+        const size_t n = d.Stride;
+        const Scalar MMajor = d.MolarMasses[d.Major];
+        const Vector one = V::Set1(Scalar(1));
+        const Vector vMMajor = V::Set1(MMajor);
+
+        size_t r = begin;
+        for (; r + V::Width <= end; r += V::Width) {
+            Vector MAvgNum = vMMajor, MAvgDen = one;
+            Vector xSum = V::Set1(Scalar(0)), wSum = V::Set1(Scalar(0));
+
+            for (size_t h : d.Alloying) {
+                const Scalar M = d.MolarMasses[h];
+                Vector userX = V::Load(d.UserX + h * n + r);
+                Vector userW = V::Load(d.UserW + h * n + r);
+
+                xSum = V::Add(xSum, userX);
+                MAvgNum = V::Sub(MAvgNum, V::Mul(V::Set1(MMajor - M), userX));
+
+                wSum = V::Add(wSum, V::Div(userW, V::Set1(M)));
+                MAvgDen = V::Add(MAvgDen, V::Mul(V::Set1(MMajor / M - Scalar(1)), userW));
+            }
+
+            Vector molarMassAvg = V::Div(MAvgNum, MAvgDen);
+            Vector xMajor = V::Sub(V::Sub(one, xSum), V::Mul(wSum, molarMassAvg));
+
+            V::Store(d.X + d.Major * n + r, xMajor);
+            V::Store(d.W + d.Major * n + r, V::Div(V::Mul(xMajor, vMMajor), molarMassAvg));
+
+            for (size_t h : d.Alloying) {
+                Vector conversionFactor = V::Div(molarMassAvg, V::Set1(d.MolarMasses[h]));
+                Vector userX = V::Load(d.UserX + h * n + r);
+                Vector userW = V::Load(d.UserW + h * n + r);
+                Mask hasX = V::GreaterThanZero(userX);
+                Mask hasW = V::AndNot(hasX, V::GreaterThanZero(userW));
+
+                Scalar* W = d.W + h * n + r;
+                Scalar* X = d.X + h * n + r;
+                V::Store(W, V::Select(hasX, V::Div(userX, conversionFactor), V::Load(W)));
+                V::Store(X, V::Select(hasW, V::Mul(userW, conversionFactor), V::Load(X)));
+            }
+
+            Vector xSumSubstitutional = one;
+            for (size_t h : d.Interstitial) {
+                xSumSubstitutional = V::Sub(xSumSubstitutional, V::Load(d.X + h * n + r));
+            }
+
+            V::Store(d.U + d.Major * n + r, V::Div(xMajor, xSumSubstitutional));
+            V::StoreFlags(d.IsUpdated + d.Major * n + r, V::True());
+
+            for (size_t h : d.Variable) {
+                V::Store(d.U + h * n + r, V::Div(V::Load(d.X + h * n + r), xSumSubstitutional));
+                V::StoreFlags(d.IsUpdated + h * n + r, V::True());
+            }
+
+            Vector molarMassAvgFixedPartial = V::Set1(Scalar(0));
+            for (size_t h : d.Fixed) {
+                Vector U = V::Div(V::Load(d.X + h * n + r), xSumSubstitutional);
+                V::Store(d.U + h * n + r, U);
+                molarMassAvgFixedPartial = V::Add(molarMassAvgFixedPartial, V::Mul(U, V::Set1(MMajor - d.MolarMasses[h])));
+                V::StoreFlags(d.IsUpdated + h * n + r, V::True());
+            }
+
+            Vector xSumSubstitutionalFixedPartial = one;
+            for (size_t h : d.FixedInterstitial) {
+                xSumSubstitutionalFixedPartial = V::Sub(xSumSubstitutionalFixedPartial, V::Load(d.X + h * n + r));
+            }
+
+            V::Store(d.MolarMassAvg + r, molarMassAvg);
+            V::Store(d.MolarMassAvgFixedPartial + r, molarMassAvgFixedPartial);
+            V::Store(d.XSumSubstitutionalFixedPartial + r, xSumSubstitutionalFixedPartial);
+        }
+
+        return r - begin;
+    }
+
+    /// Vectorized CompositionKernels::UpdateFractionsUFixed. Rows whose
+    /// variable elements are all updated are left untouched
+    template <typename V>
+    size_t UpdateFractionsUFixed(const BasicBatchData<typename V::Scalar>& d, size_t begin, size_t end)
+    {
+        typedef typename V::Scalar Scalar;
+        typedef typename V::Vector Vector;
+        typedef typename V::Mask Mask;
+
+        const size_t n = d.Stride;
+        const Scalar MMajor = d.MolarMasses[d.Major];
+        const Vector one = V::Set1(Scalar(1));
+        const Vector vMMajor = V::Set1(MMajor);
+
+        size_t r = begin;
+        for (; r + V::Width <= end; r += V::Width) {
+            Vector xMSumProduct = V::Set1(Scalar(0));
+            Vector xSumSubstitutional = V::Load(d.XSumSubstitutionalFixedPartial + r);
+            Vector xSumAlloying = V::Set1(Scalar(0));
+            // Rows where at least one interstitial/substitutional element is not updated
+            Mask notUpdatedInterstitial = V::False();
+            Mask notUpdatedSubstitutional = notUpdatedInterstitial;
+
+            for (size_t h : d.VariableInterstitial) {
+                Vector X = V::Load(d.X + h * n + r);
+                notUpdatedInterstitial = V::Or(notUpdatedInterstitial, V::Not(V::LoadFlags(d.IsUpdated + h * n + r)));
+                xSumSubstitutional = V::Sub(xSumSubstitutional, X);
+                xMSumProduct = V::Add(xMSumProduct, V::Mul(X, V::Set1(MMajor - d.MolarMasses[h])));
+            }
+
+            for (size_t h : d.VariableSubstitutional) {
+                Vector dM = V::Set1(MMajor - d.MolarMasses[h]);
+                Mask isUpdated = V::LoadFlags(d.IsUpdated + h * n + r);
+                Vector fromX = V::Mul(V::Load(d.X + h * n + r), dM);
+                Vector fromU = V::Mul(V::Mul(xSumSubstitutional, V::Load(d.U + h * n + r)), dM);
+                xMSumProduct = V::Add(xMSumProduct, V::Select(isUpdated, fromU, fromX));
+                notUpdatedSubstitutional = V::Or(notUpdatedSubstitutional, V::Not(isUpdated));
+            }
+
+            Mask changed = V::Or(notUpdatedInterstitial, notUpdatedSubstitutional);
+            if (!V::Any(changed))
+                continue;
+
+            Scalar* pMolarMassAvg = d.MolarMassAvg + r;
+            Vector molarMassAvg = V::Sub(V::Sub(vMMajor, xMSumProduct),
+                V::Mul(xSumSubstitutional, V::Load(d.MolarMassAvgFixedPartial + r)));
+            molarMassAvg = V::Select(changed, molarMassAvg, V::Load(pMolarMassAvg));
+            V::Store(pMolarMassAvg, molarMassAvg);
+
+            for (size_t h : d.VariableInterstitial) {
+                Scalar* U = d.U + h * n + r;
+                Mask update = V::And(notUpdatedInterstitial, V::Not(V::LoadFlags(d.IsUpdated + h * n + r)));
+                V::Store(U, V::Select(update, V::Div(V::Load(d.X + h * n + r), xSumSubstitutional), V::Load(U)));
+            }
+
+            for (size_t h : d.VariableSubstitutional) {
+                Scalar* U = d.U + h * n + r;
+                Mask update = V::Not(V::LoadFlags(d.IsUpdated + h * n + r));
+                V::Store(U, V::Select(update, V::Div(V::Load(d.X + h * n + r), xSumSubstitutional), V::Load(U)));
+            }
+
+            for (size_t h : d.Alloying) {
+                Scalar* X = d.X + h * n + r;
+                Scalar* W = d.W + h * n + r;
+                unsigned char* pIsUpdated = d.IsUpdated + h * n + r;
+                Mask isUpdated = V::LoadFlags(pIsUpdated);
+
+                Vector x = V::Select(V::And(notUpdatedInterstitial, isUpdated),
+                    V::Mul(V::Load(d.U + h * n + r), xSumSubstitutional), V::Load(X));
+                V::Store(X, x);
+                V::StoreFlags(pIsUpdated, V::Or(notUpdatedInterstitial, isUpdated));
+                V::Store(W, V::Select(changed, V::Div(V::Mul(x, V::Set1(d.MolarMasses[h])), molarMassAvg), V::Load(W)));
+                xSumAlloying = V::Add(xSumAlloying, x);
+            }
+
+            Scalar* XMajor = d.X + d.Major * n + r;
+            Scalar* WMajor = d.W + d.Major * n + r;
+            Scalar* UMajor = d.U + d.Major * n + r;
+            Vector xMajor = V::Select(changed, V::Sub(one, xSumAlloying), V::Load(XMajor));
+            V::Store(XMajor, xMajor);
+            V::Store(WMajor, V::Select(changed, V::Div(V::Mul(xMajor, vMMajor), molarMassAvg), V::Load(WMajor)));
+            V::Store(UMajor, V::Select(changed, V::Div(xMajor, xSumSubstitutional), V::Load(UMajor)));
+        }
+
+        return r - begin;
+    }
+
+} // namespace
+} // namespace CompositionSimd
+
+#endif
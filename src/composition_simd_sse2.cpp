@@ -0,0 +1,107 @@
+/// @file composition_simd_sse2.cpp
+/// SSE2 kernels of ScalarCompositionBatch<double> (CompositionBatch) and ScalarCompositionBatch<float>. Compiled with -msse2 (see CMakeLists.txt)
+
+#include "composition_simd.hpp"
+
+#if defined(__SSE2__)
+
+#include "composition_simd_kernels.hpp"
+#include <emmintrin.h>
+
+namespace {
+
+/// SSE2 vector operations used in composition_simd_kernels.hpp
+struct VectorSSE2 {
+    typedef double Scalar;
+    typedef __m128d Vector;
+    typedef __m128d Mask;
+    static const size_t Width = 2;
+
+    static Vector Load(const double* p) { return _mm_loadu_pd(p); }
+    static void Store(double* p, Vector a) { _mm_storeu_pd(p, a); }
+    static Vector Set1(double a) { return _mm_set1_pd(a); }
+    static Vector Add(Vector a, Vector b) { return _mm_add_pd(a, b); }
+    static Vector Sub(Vector a, Vector b) { return _mm_sub_pd(a, b); }
+    static Vector Mul(Vector a, Vector b) { return _mm_mul_pd(a, b); }
+    static Vector Div(Vector a, Vector b) { return _mm_div_pd(a, b); }
+
+    static Mask True() { return _mm_castsi128_pd(_mm_set1_epi32(-1)); }
+    static Mask False() { return _mm_setzero_pd(); }
+    static Mask GreaterThanZero(Vector a) { return _mm_cmpgt_pd(a, _mm_setzero_pd()); }
+    static Vector Select(Mask m, Vector a, Vector b) { return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b)); }
+    static Mask And(Mask a, Mask b) { return _mm_and_pd(a, b); }
+    static Mask AndNot(Mask a, Mask b) { return _mm_andnot_pd(a, b); }
+    static Mask Or(Mask a, Mask b) { return _mm_or_pd(a, b); }
+    static Mask Not(Mask a) { return _mm_xor_pd(a, True()); }
+    static bool Any(Mask a) { return _mm_movemask_pd(a) != 0; }
+
+    static Mask LoadFlags(const unsigned char* p)
+    {
+        return _mm_castsi128_pd(_mm_set_epi64x(p[1] ? -1 : 0, p[0] ? -1 : 0));
+    }
+    static void StoreFlags(unsigned char* p, Mask m)
+    {
+        int bits = _mm_movemask_pd(m);
+        p[0] = bits & 1;
+        p[1] = (bits >> 1) & 1;
+    }
+};
+
+/// SSE2 single precision vector operations used in composition_simd_kernels.hpp
+struct VectorFloatSSE2 {
+    typedef float Scalar;
+    typedef __m128 Vector;
+    typedef __m128 Mask;
+    static const size_t Width = 4;
+
+    static Vector Load(const float* p) { return _mm_loadu_ps(p); }
+    static void Store(float* p, Vector a) { _mm_storeu_ps(p, a); }
+    static Vector Set1(float a) { return _mm_set1_ps(a); }
+    static Vector Add(Vector a, Vector b) { return _mm_add_ps(a, b); }
+    static Vector Sub(Vector a, Vector b) { return _mm_sub_ps(a, b); }
+    static Vector Mul(Vector a, Vector b) { return _mm_mul_ps(a, b); }
+    static Vector Div(Vector a, Vector b) { return _mm_div_ps(a, b); }
+
+    static Mask True() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+    static Mask False() { return _mm_setzero_ps(); }
+    static Mask GreaterThanZero(Vector a) { return _mm_cmpgt_ps(a, _mm_setzero_ps()); }
+    static Vector Select(Mask m, Vector a, Vector b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+    static Mask And(Mask a, Mask b) { return _mm_and_ps(a, b); }
+    static Mask AndNot(Mask a, Mask b) { return _mm_andnot_ps(a, b); }
+    static Mask Or(Mask a, Mask b) { return _mm_or_ps(a, b); }
+    static Mask Not(Mask a) { return _mm_xor_ps(a, True()); }
+    static bool Any(Mask a) { return _mm_movemask_ps(a) != 0; }
+
+    static Mask LoadFlags(const unsigned char* p)
+    {
+        return _mm_castsi128_ps(_mm_set_epi32(p[3] ? -1 : 0, p[2] ? -1 : 0, p[1] ? -1 : 0, p[0] ? -1 : 0));
+    }
+    static void StoreFlags(unsigned char* p, Mask m)
+    {
+        int bits = _mm_movemask_ps(m);
+        for (size_t i = 0; i < Width; i++)
+            p[i] = (bits >> i) & 1;
+    }
+};
+
+const CompositionSimd::Kernels kernelsSSE2 = {
+    CompositionSimd::UpdateFractions<VectorSSE2>,
+    CompositionSimd::UpdateFractionsUFixed<VectorSSE2>,
+};
+
+const CompositionSimd::KernelsFloat kernelsFloatSSE2 = {
+    CompositionSimd::UpdateFractions<VectorFloatSSE2>,
+    CompositionSimd::UpdateFractionsUFixed<VectorFloatSSE2>,
+};
+
+} // namespace
+
+const CompositionSimd::Kernels* CompositionSimd::KernelsSSE2() { return &kernelsSSE2; }
+const CompositionSimd::KernelsFloat* CompositionSimd::KernelsFloatSSE2() { return &kernelsFloatSSE2; }
+
+#else
+
+const CompositionSimd::Kernels* CompositionSimd::KernelsSSE2() { return nullptr; }
+const CompositionSimd::KernelsFloat* CompositionSimd::KernelsFloatSSE2() { return nullptr; }
+
+#endif
@@ -0,0 +1,111 @@
+#include "composition_snapshot.hpp"
+#include <stdexcept>
+#include <string>
+
+/** @brief Takes a snapshot of a composition
+ *
+ * The composition must not be changed concurrently.
+ *
+ * @param comp The composition
+ * @param sequence Sequence number (see CompositionPublisher)
+ */
+CompositionSnapshot::CompositionSnapshot(const Composition& comp, unsigned long long sequence)
+    : mvNumberOfElements(comp.mvpLayout->NumberOfElements)
+    , mvMajor(comp.mvpLayout->Partition.Major)
+    , mvpSymbolTable(comp.mvpLayout->SymbolTable)
+    , mvIsCompositionLocked(comp.mvIsCompositionLocked)
+    , mvSequence(sequence)
+    , mvpSymbols(new const char*[mvNumberOfElements])
+    , mvpFractions(new double[3 * mvNumberOfElements])
+{
+    mvMolarMassAvg = comp.mvMolarMassAvg;
+
+    size_t n = mvNumberOfElements;
+    for (size_t i = 0; i < n; i++) {
+        const ElementData& el = comp.element(i);
+        mvpSymbols[i] = el.mvSymbol;
+        mvpFractions[i] = el.mvX;
+        mvpFractions[n + i] = el.mvW;
+        mvpFractions[2 * n + i] = el.mvU;
+    }
+}
+
+/** @brief Finds the index of an element. Does not allocate memory
+ *
+ * @param elementSymbol The element symbol (case insensitive)
+ *
+ * @return Index of the element, or GetNumberOfElements() if it is not defined
+ */
+size_t CompositionSnapshot::FindElementIndex(std::string_view elementSymbol) const noexcept
+{
+    size_t key = PeriodicTable::SymbolKey(elementSymbol);
+    if (key < PeriodicTable::SymbolKeyCount && (*mvpSymbolTable)[key] > 0) {
+        return (*mvpSymbolTable)[key] - 1;
+    }
+    return mvNumberOfElements;
+}
+
+/** @brief Gets the index of an element
+ *
+ * @param elementSymbol The element symbol (case insensitive)
+ *
+ * @return Index of the element
+ */
+size_t CompositionSnapshot::GetElementIndex(std::string_view elementSymbol) const
+{
+    size_t i = FindElementIndex(elementSymbol);
+    if (i == mvNumberOfElements) {
+        throw std::runtime_error("Element " + std::string(elementSymbol) + " is not defined");
+    }
+    return i;
+}
+
+/** @brief Takes a snapshot of the composition and publishes it
+ *
+ * Readers that loaded the previous snapshot keep reading it until they
+ * release it.
+ *
+ * @param comp The composition
+ *
+ * @return The published snapshot
+ */
+std::shared_ptr<const CompositionSnapshot> CompositionPublisher::Publish(const Composition& comp)
+{
+    std::shared_ptr<const CompositionSnapshot> pSnapshot = std::make_shared<const CompositionSnapshot>(comp, ++mvSequence);
+
+    // A reader that has not checked the current slot again after counting
+    // itself does not read the slot, so it can be written once it has no
+    // readers. The sequentially consistent operations order these checks
+    // with the ones of Load
+    size_t current = mvCurrent.load(std::memory_order_relaxed);
+    size_t i = (current + 1) % NumberOfSlots;
+    while (mvSlots[i].Readers.load() != 0) {
+        i = (i + 1) % NumberOfSlots;
+        if (i == current)
+            i = (i + 1) % NumberOfSlots;
+    }
+    mvSlots[i].Snapshot = pSnapshot;
+    mvCurrent.store(i);
+    return pSnapshot;
+}
+
+/** @brief Latest published snapshot. Can be called from any thread, and never
+ * waits for Publish
+ *
+ * @return The snapshot, or nullptr if none was published
+ */
+std::shared_ptr<const CompositionSnapshot> CompositionPublisher::Load() const noexcept
+{
+    for (;;) {
+        size_t i = mvCurrent.load();
+        const Slot& slot = mvSlots[i];
+        slot.Readers.fetch_add(1);
+        if (mvCurrent.load() == i) {
+            std::shared_ptr<const CompositionSnapshot> pSnapshot = slot.Snapshot;
+            slot.Readers.fetch_sub(1, std::memory_order_release);
+            return pSnapshot;
+        }
+        // Published meanwhile: the slot may be being written
+        slot.Readers.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,124 @@
+#include "composition_status.hpp"
+#include <cstdio>
+
+namespace {
+std::atomic<CompositionErrorCounters*> gpCounters { nullptr };
+std::atomic<CompositionDiagnostics::Callback> gCallback { nullptr };
+std::atomic<void*> gpUserData { nullptr };
+}
+
+/** @brief Gets a short description of a status
+ *
+ * @param status The status
+ *
+ * @return The description (static string)
+ */
+const char* GetStatusMessage(CompositionStatus status) noexcept
+{
+    switch (status) {
+    case CompositionStatus::Ok:
+        return "Ok";
+    case CompositionStatus::MajorElement:
+        return "Cannot set composition of major element";
+    case CompositionStatus::LockedElement:
+        return "Cannot set locked composition";
+    case CompositionStatus::LockedMassFraction:
+        return "Setting mass fraction not supported when composition is locked";
+    case CompositionStatus::InvalidArgument:
+        return "Invalid argument";
+    case CompositionStatus::NotConverged:
+        return "Solver did not converge";
+    }
+    return "Unknown status";
+}
+
+/// Total number of errors
+unsigned long long CompositionErrorCounters::Total() const noexcept
+{
+    unsigned long long total = 0;
+    for (size_t i = 1; i < CompositionStatusCount; i++) {
+        total += Counts[i].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+/// Sets all counters to zero
+void CompositionErrorCounters::Reset() noexcept
+{
+    for (auto& count : Counts) {
+        count.store(0, std::memory_order_relaxed);
+    }
+}
+
+/** @brief Registers the counters incremented at each error
+ *
+ * @param pCounters The counters (nullptr to disable counting)
+ */
+void CompositionDiagnostics::SetErrorCounters(CompositionErrorCounters* pCounters) noexcept
+{
+    gpCounters.store(pCounters, std::memory_order_release);
+}
+
+/** @brief Registers the callback called at each error
+ *
+ * The callback and the user data are stored separately, so a Report running
+ * concurrently could pass the user data of one call to the callback of the
+ * other. Must not be called while other threads can report errors (e.g.,
+ * register the callback before starting them, and reset it after joining
+ * them).
+ *
+ * @param callback The callback (nullptr to disable it)
+ * @param userData Pointer passed to the callback
+ */
+void CompositionDiagnostics::SetCallback(Callback callback, void* userData) noexcept
+{
+    gpUserData.store(userData, std::memory_order_relaxed);
+    gCallback.store(callback, std::memory_order_release);
+}
+
+/** @brief Reports an error to the registered counters and callback. Does not
+ * do any I/O by itself
+ *
+ * Kept out of line, so the error path does not bloat the setters.
+ *
+ * @param status The status
+ * @param symbol Symbol of the element (or nullptr)
+ *
+ * @return The status
+ */
+CompositionStatus CompositionDiagnostics::Report(CompositionStatus status, const char* symbol) noexcept
+{
+    CompositionErrorCounters* pCounters = gpCounters.load(std::memory_order_acquire);
+    if (pCounters != nullptr)
+        pCounters->Counts[static_cast<size_t>(status)].fetch_add(1, std::memory_order_relaxed);
+
+    Callback callback = gCallback.load(std::memory_order_acquire);
+    if (callback != nullptr)
+        callback(status, symbol, gpUserData.load(std::memory_order_relaxed));
+
+    return status;
+}
+
+/** @brief Prints the error message of the legacy setters (e.g., ElementData::SetX)
+ *
+ * @param status The status returned by the noexcept setter
+ * @param fraction 'X' or 'W'
+ * @param symbol Symbol of the element
+ * @param className Class of the setter, to suggest setting the mole fraction instead
+ */
+void CompositionDiagnostics::PrintSetError(CompositionStatus status, char fraction, const char* symbol, const char* className)
+{
+    switch (status) {
+    case CompositionStatus::MajorElement:
+        fprintf(stderr, "Cannot set %c(%s) composition of major element\n", fraction, symbol);
+        break;
+    case CompositionStatus::LockedElement:
+        fprintf(stderr, "Cannot set locked %c(%s) composition\n", fraction, symbol);
+        break;
+    case CompositionStatus::LockedMassFraction:
+        fprintf(stderr, "Setting mass fraction W(%s) not supported when composition is locked. Try setting in atomic fraction (%s::SetX) instead\n", symbol, className);
+        break;
+    default:
+        break;
+    }
+}
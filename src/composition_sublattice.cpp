@@ -0,0 +1,250 @@
+#include "composition_sublattice.hpp"
+#include <cmath>
+#include <stdexcept>
+
+/** @brief Constructor of CompositionSublattices
+ *
+ * @param prototype Composition from which the element definitions are taken
+ * @param sublattices Sites and constituents of each sublattice. Each element
+ * must be on exactly one sublattice, and the sublattice of the major element
+ * cannot have vacancies
+ */
+CompositionSublattices::CompositionSublattices(const Composition& prototype, const std::vector<Sublattice>& sublattices)
+    : mvElements(prototype)
+    , mvMajor(mvElements.GetMajorElementIndex())
+    , mvReference(0)
+    , mvIsReferenceSubstitutional(true)
+{
+    std::vector<bool> isInterstitial;
+    for (const ElementData& el : prototype.GetElements()) {
+        isInterstitial.push_back(el.IsInterstitial());
+    }
+
+    if (sublattices.empty()) {
+        throw std::runtime_error("CompositionSublattices: no sublattices");
+    }
+
+    size_t nElements = NumberOfElements();
+    size_t undefined = sublattices.size();
+    mvElementSublattice.assign(nElements, undefined);
+    mvMembers.resize(sublattices.size());
+    for (size_t s = 0; s < sublattices.size(); s++) {
+        const Sublattice& sublattice = sublattices[s];
+        if (!(sublattice.Sites > 0.0) || !std::isfinite(sublattice.Sites)) {
+            throw std::runtime_error("CompositionSublattices: number of sites must be positive");
+        }
+        if (sublattice.Constituents.empty()) {
+            throw std::runtime_error("CompositionSublattices: sublattice without constituents");
+        }
+
+        bool hasVacancies = false;
+        for (const std::string& symbol : sublattice.Constituents) {
+            if (symbol == VacancySymbol) {
+                if (hasVacancies) {
+                    throw std::runtime_error("CompositionSublattices: duplicate vacancies in a sublattice");
+                }
+                hasVacancies = true;
+                continue;
+            }
+
+            size_t e = 0;
+            while (e < nElements && GetSymbol(e) != symbol) {
+                e++;
+            }
+            if (e == nElements) {
+                throw std::runtime_error("CompositionSublattices: element " + symbol + " not defined");
+            }
+            if (mvElementSublattice[e] != undefined) {
+                throw std::runtime_error("CompositionSublattices: element " + symbol + " on more than one sublattice");
+            }
+            mvElementSublattice[e] = s;
+            mvMembers[s].push_back(e);
+        }
+        mvSites.push_back(sublattice.Sites);
+        mvHasVacancies.push_back(hasVacancies);
+    }
+
+    for (size_t e = 0; e < nElements; e++) {
+        if (mvElementSublattice[e] == undefined) {
+            throw std::runtime_error("CompositionSublattices: element " + GetSymbol(e) + " not on any sublattice");
+        }
+    }
+
+    mvReference = mvElementSublattice[mvMajor];
+    if (mvHasVacancies[mvReference]) {
+        throw std::runtime_error("CompositionSublattices: sublattice of the major element cannot have vacancies");
+    }
+
+    for (size_t e = 0; e < nElements; e++) {
+        size_t s = mvElementSublattice[e];
+        mvFactors.push_back(mvSites[mvReference] / mvSites[s]);
+        if (isInterstitial[e] == (s == mvReference))
+            mvIsReferenceSubstitutional = false;
+    }
+}
+
+/** @brief Model with the substitutional elements on one sublattice, and the
+ * interstitial elements and vacancies on another, as the site fractions of
+ * the compositions but with any site ratio
+ *
+ * @param prototype Composition from which the element definitions are taken
+ * @param substitutionalSites Number of sites of the substitutional sublattice
+ * @param interstitialSites Number of sites of the interstitial sublattice
+ *
+ * @return The model, with only the substitutional sublattice if there are no
+ * interstitial elements
+ */
+CompositionSublattices CompositionSublattices::TwoSublattices(const Composition& prototype, double substitutionalSites,
+    double interstitialSites)
+{
+    Sublattice substitutional { substitutionalSites, {} };
+    Sublattice interstitial { interstitialSites, {} };
+    for (const ElementData& el : prototype.GetElements()) {
+        (el.IsInterstitial() ? interstitial : substitutional).Constituents.push_back(el.GetSymbol());
+    }
+    if (interstitial.Constituents.empty())
+        return CompositionSublattices(prototype, { substitutional });
+
+    interstitial.Constituents.push_back(VacancySymbol);
+    return CompositionSublattices(prototype, { substitutional, interstitial });
+}
+
+/// Checks if a batch has the same element definitions as the model
+bool CompositionSublattices::HasSameElements(const CompositionBatch& batch) const
+{
+    return mvElements.HasSameLayout(batch);
+}
+
+/// Checks if a composition has the same element definitions as the model
+void CompositionSublattices::checkComposition(const Composition& comp) const
+{
+    if (!mvElements.HasSameLayout(comp)) {
+        throw std::runtime_error("CompositionSublattices: composition has different element definitions");
+    }
+}
+
+/** @brief Computes the site fractions of a composition
+ *
+ * @param comp Composition with the same elements as the model, whose
+ * fractions are updated
+ * @param siteFractions Receives the site fraction of each element
+ * @param vacancies If not nullptr, receives the site fraction of the
+ * vacancies of each sublattice (zero if it has no vacancies)
+ */
+void CompositionSublattices::GetSiteFractions(const Composition& comp, double* siteFractions, double* vacancies) const
+{
+    checkComposition(comp);
+
+    size_t e = 0;
+    for (const ElementData& el : comp.GetElements()) {
+        siteFractions[e++] = el.GetU();
+    }
+
+    // Same operations as the batch version, for identical results
+    if (mvIsReferenceSubstitutional) {
+        for (e = 0; e < NumberOfElements(); e++) {
+            siteFractions[e] *= mvFactors[e];
+        }
+    } else {
+        double sum = siteFractions[mvMajor];
+        for (size_t member : mvMembers[mvReference]) {
+            if (member != mvMajor)
+                sum += siteFractions[member];
+        }
+        for (e = 0; e < NumberOfElements(); e++) {
+            siteFractions[e] = siteFractions[e] * mvFactors[e] / sum;
+        }
+    }
+
+    if (vacancies == nullptr)
+        return;
+    for (size_t s = 0; s < mvSites.size(); s++) {
+        vacancies[s] = mvHasVacancies[s] ? 1.0 : 0.0;
+        if (!mvHasVacancies[s])
+            continue;
+        for (size_t member : mvMembers[s]) {
+            vacancies[s] -= siteFractions[member];
+        }
+    }
+}
+
+/** @brief Computes the site fractions of rows of a batch
+ *
+ * @param batch Batch with the same elements as the model, whose fractions
+ * are updated
+ * @param beginRow First row
+ * @param endRow One past the last row
+ * @param siteFractions Receives the site fractions, with one column of
+ * batch.Size() values per element as in CompositionBatch (only the rows in
+ * the range are written)
+ * @param vacancies If not nullptr, receives the site fractions of the
+ * vacancies, with one column of batch.Size() values per sublattice (zero if
+ * it has no vacancies)
+ */
+void CompositionSublattices::GetSiteFractions(const CompositionBatch& batch, size_t beginRow, size_t endRow,
+    double* siteFractions, double* vacancies) const
+{
+    if (!HasSameElements(batch)) {
+        throw std::runtime_error("CompositionSublattices: batch has different element definitions");
+    }
+
+    size_t size = batch.Size();
+    size_t count = endRow - beginRow;
+    if (mvIsReferenceSubstitutional) {
+        // The substitutional site fractions already add up to one
+        for (size_t e = 0; e < NumberOfElements(); e++) {
+            const double* u = batch.U(e) + beginRow;
+            double* y = siteFractions + e * size + beginRow;
+            double factor = mvFactors[e];
+            for (size_t r = 0; r < count; r++) {
+                y[r] = u[r] * factor;
+            }
+        }
+    } else {
+        // Sum of the reference sublattice, kept in the column of the major
+        // element until the other elements are scaled
+        double* sum = siteFractions + mvMajor * size + beginRow;
+        const double* uMajor = batch.U(mvMajor) + beginRow;
+        for (size_t r = 0; r < count; r++) {
+            sum[r] = uMajor[r];
+        }
+        for (size_t member : mvMembers[mvReference]) {
+            if (member == mvMajor)
+                continue;
+            const double* u = batch.U(member) + beginRow;
+            for (size_t r = 0; r < count; r++) {
+                sum[r] += u[r];
+            }
+        }
+        for (size_t e = 0; e < NumberOfElements(); e++) {
+            if (e == mvMajor)
+                continue;
+            const double* u = batch.U(e) + beginRow;
+            double* y = siteFractions + e * size + beginRow;
+            double factor = mvFactors[e];
+            for (size_t r = 0; r < count; r++) {
+                y[r] = u[r] * factor / sum[r];
+            }
+        }
+        for (size_t r = 0; r < count; r++) {
+            sum[r] = uMajor[r] / sum[r];
+        }
+    }
+
+    if (vacancies == nullptr)
+        return;
+    for (size_t s = 0; s < mvSites.size(); s++) {
+        double* va = vacancies + s * size + beginRow;
+        for (size_t r = 0; r < count; r++) {
+            va[r] = mvHasVacancies[s] ? 1.0 : 0.0;
+        }
+        if (!mvHasVacancies[s])
+            continue;
+        for (size_t member : mvMembers[s]) {
+            const double* y = siteFractions + member * size + beginRow;
+            for (size_t r = 0; r < count; r++) {
+                va[r] -= y[r];
+            }
+        }
+    }
+}
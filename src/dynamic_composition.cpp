@@ -0,0 +1,281 @@
+#include "dynamic_composition.hpp"
+#include "composition_kernels.hpp"
+#include <cstdio>
+#include <stdexcept>
+
+/// Accessor to the flat arrays of DynamicComposition used by the templates in
+/// CompositionKernels
+struct DynamicComposition::Accessor {
+    DynamicComposition& Comp; ///< The composition
+
+    double MolarMass(size_t i) const { return Comp.mvMolarMasses[i]; }
+    double& UserX(size_t i) const { return Comp.mvUserX[i]; }
+    double& UserW(size_t i) const { return Comp.mvUserW[i]; }
+    double& X(size_t i) const { return Comp.mvX[i]; }
+    double& W(size_t i) const { return Comp.mvW[i]; }
+    double& U(size_t i) const { return Comp.mvU[i]; }
+    unsigned char& IsUpdated(size_t i) const { return Comp.mvIsUpdated[i]; }
+};
+
+/** @brief Constructor of DynamicComposition
+ *
+ * Looks up the elements in the PeriodicTable and computes their partition
+ * (major, interstitial/substitutional, fixed/variable elements). Throws
+ * std::runtime_error if an element is unknown or repeated, or if there is
+ * not exactly one major element.
+ *
+ * @param elements Definitions of the elements, in order
+ */
+DynamicComposition::DynamicComposition(const std::vector<ElementDefinition>& elements)
+{
+    if (elements.size() >= 256) {
+        throw std::runtime_error("DynamicComposition: Error! Too many elements defined");
+    }
+
+    bool hasMajor = false;
+    for (size_t i = 0; i < elements.size(); i++) {
+        const ElementDefinition& def = elements[i];
+        const PeriodicTable::Element* pElement = PeriodicTable::FindBySymbol(def.Symbol);
+        if (pElement == nullptr) {
+            throw std::runtime_error("DynamicComposition: Error! Unknown element " + def.Symbol);
+        }
+
+        size_t key = PeriodicTable::SymbolKey(def.Symbol);
+        if (mvSymbolTable[key] > 0) {
+            throw std::runtime_error("DynamicComposition: Error! Element " + def.Symbol + " defined more than once");
+        }
+        mvSymbolTable[key] = static_cast<unsigned char>(i + 1);
+
+        if (def.IsMajor) {
+            if (hasMajor) {
+                throw std::runtime_error("DynamicComposition: Error! More than one major elements defined ("
+                    + std::string(mvSymbols[mvPartition.Major]) + " and " + def.Symbol + ")");
+            }
+            hasMajor = true;
+            mvPartition.Major = i;
+        } else if (def.IsInterstitial) {
+            (def.IsVariable ? mvPartition.VariableInterstitial : mvPartition.FixedInterstitial).push_back(i);
+        } else {
+            (def.IsVariable ? mvPartition.VariableSubstitutional : mvPartition.FixedSubstitutional).push_back(i);
+        }
+
+        mvSymbols.push_back(pElement->Symbol.data());
+        mvFlags.push_back(ElementFlags { def.IsVariable, def.IsInterstitial, def.IsMajor });
+        mvMolarMasses.push_back(pElement->MolarMass);
+    }
+
+    if (!hasMajor) {
+        throw std::runtime_error("DynamicComposition: Error! No major element defined");
+    }
+
+    auto concatenate = [](const std::vector<size_t>& a, const std::vector<size_t>& b) {
+        std::vector<size_t> c = a;
+        c.insert(c.end(), b.begin(), b.end());
+        return c;
+    };
+
+    mvPartition.Interstitial = concatenate(mvPartition.VariableInterstitial, mvPartition.FixedInterstitial);
+    mvPartition.Substitutional = concatenate(mvPartition.VariableSubstitutional, mvPartition.FixedSubstitutional);
+    mvPartition.Variable = concatenate(mvPartition.VariableInterstitial, mvPartition.VariableSubstitutional);
+    mvPartition.Fixed = concatenate(mvPartition.FixedInterstitial, mvPartition.FixedSubstitutional);
+    mvPartition.Alloying = concatenate(mvPartition.Interstitial, mvPartition.Substitutional);
+
+    size_t n = elements.size();
+    mvUserX.assign(n, 0.0);
+    mvUserW.assign(n, 0.0);
+    mvX.assign(n, 0.0);
+    mvW.assign(n, 0.0);
+    mvU.assign(n, 0.0);
+    mvIsUpdated.assign(n, false);
+}
+
+/** @brief Finds the index of an element. Does not allocate memory
+ *
+ * @param elementSymbol The element symbol (case insensitive)
+ *
+ * @return Index of the element, or GetNumberOfElements() if it is not defined
+ */
+size_t DynamicComposition::FindElementIndex(std::string_view elementSymbol) const noexcept
+{
+    size_t key = PeriodicTable::SymbolKey(elementSymbol);
+    if (key < PeriodicTable::SymbolKeyCount && mvSymbolTable[key] > 0) {
+        return mvSymbolTable[key] - 1;
+    }
+    return GetNumberOfElements();
+}
+
+/** @brief Gets the index of an element
+ *
+ * @param elementSymbol The element symbol (case insensitive)
+ *
+ * @return Index of the element
+ */
+size_t DynamicComposition::GetElementIndex(std::string_view elementSymbol) const
+{
+    size_t i = FindElementIndex(elementSymbol);
+    if (i == GetNumberOfElements()) {
+        throw std::runtime_error("Element " + std::string(elementSymbol) + " is not defined");
+    }
+    return i;
+}
+
+/// Checks if the mole fraction of an element can be set (see ElementData::TrySetX)
+CompositionStatus DynamicComposition::checkSetX(size_t element) const noexcept
+{
+    if (mvFlags[element].IsMajor)
+        return CompositionStatus::MajorElement;
+    if (mvIsCompositionLocked && !mvFlags[element].IsVariable)
+        return CompositionStatus::LockedElement;
+    return CompositionStatus::Ok;
+}
+
+/// Checks if the weight fraction of an element can be set (see ElementData::TrySetW)
+CompositionStatus DynamicComposition::checkSetW(size_t element) const noexcept
+{
+    if (mvFlags[element].IsMajor)
+        return CompositionStatus::MajorElement;
+    if (mvIsCompositionLocked && !mvFlags[element].IsVariable)
+        return CompositionStatus::LockedElement;
+    if (mvIsCompositionLocked)
+        return CompositionStatus::LockedMassFraction;
+    return CompositionStatus::Ok;
+}
+
+/** @brief Set mole fraction of element. Prints an error message if it cannot
+ * be set (see TrySetX)
+ *
+ * @param element Index of the element
+ * @param x Mole fraction
+ */
+void DynamicComposition::SetX(size_t element, double x)
+{
+    CompositionStatus status = TrySetX(element, x);
+    if (status != CompositionStatus::Ok)
+        CompositionDiagnostics::PrintSetError(status, 'X', mvSymbols[element], "DynamicComposition");
+}
+
+/** @brief Set weight fraction of element. Prints an error message if it
+ * cannot be set (see TrySetW)
+ *
+ * @param element Index of the element
+ * @param w Weight fraction
+ */
+void DynamicComposition::SetW(size_t element, double w)
+{
+    CompositionStatus status = TrySetW(element, w);
+    if (status != CompositionStatus::Ok)
+        CompositionDiagnostics::PrintSetError(status, 'W', mvSymbols[element], "DynamicComposition");
+}
+
+/** @brief Set mole fraction of element. Never prints (see ElementData::TrySetX)
+ *
+ * @param element Index of the element
+ * @param x Mole fraction
+ *
+ * @return CompositionStatus::Ok, or the error
+ */
+CompositionStatus DynamicComposition::TrySetX(size_t element, double x) noexcept
+{
+    CompositionStatus status = checkSetX(element);
+    if (status != CompositionStatus::Ok)
+        return CompositionDiagnostics::Report(status, mvSymbols[element]);
+
+    mvUserX[element] = mvX[element] = x;
+    mvUserW[element] = mvW[element] = mvU[element] = 0.0;
+    mvIsUpdated[element] = false;
+    return CompositionStatus::Ok;
+}
+
+/** @brief Set weight fraction of element. Never prints (see ElementData::TrySetW)
+ *
+ * @param element Index of the element
+ * @param w Weight fraction
+ *
+ * @return CompositionStatus::Ok, or the error
+ */
+CompositionStatus DynamicComposition::TrySetW(size_t element, double w) noexcept
+{
+    CompositionStatus status = checkSetW(element);
+    if (status != CompositionStatus::Ok)
+        return CompositionDiagnostics::Report(status, mvSymbols[element]);
+
+    mvUserW[element] = mvW[element] = w;
+    mvUserX[element] = mvX[element] = mvU[element] = 0.0;
+    mvIsUpdated[element] = false;
+    return CompositionStatus::Ok;
+}
+
+/// @brief Locks composition, i.e., keeps site fraction of non-variable elements fixed
+void DynamicComposition::LockComposition()
+{
+    updateFractions();
+
+    mvIsCompositionLocked = true;
+}
+
+/// @brief Unlocks composition (see LockComposition)
+void DynamicComposition::UnlockComposition()
+{
+    mvIsCompositionLocked = false;
+}
+
+/// @brief Updates fractions
+void DynamicComposition::UpdateFractions()
+{
+    if (!mvIsCompositionLocked) {
+        updateFractions();
+    } else {
+        updateFractionsUFixed();
+    }
+}
+
+/** @brief Updates the fractions and prints composition
+ *
+ * @param stream The file stream (stdout by default)
+ */
+void DynamicComposition::Print(FILE* stream)
+{
+    UpdateFractions();
+
+    const auto* constThis = this;
+    constThis->Print(stream);
+}
+
+/** @brief Prints the composition
+ *
+ * @param stream The file stream (stdout by default)
+ */
+void DynamicComposition::Print(FILE* stream) const
+{
+    fprintf(stream, "        | At. fraction (X) | Wt. fraction (W) | Site fraction (U)\n"
+                    "  ------+------------------+------------------+-------------------\n");
+
+    for (size_t i = 0; i < GetNumberOfElements(); i++) {
+        if (mvX[i] <= 0)
+            continue;
+
+        bool isAllowedToVary = !mvIsCompositionLocked || mvFlags[i].IsVariable;
+        unsigned char pos = mvFlags[i].IsMajor ? 2 : (isAllowedToVary ? 1 : 0);
+        fprintf(stream, "   %c%2s%c | %16.6g | %16.6g | %17.6g\n",
+            ">  "[pos], mvSymbols[i], "< *"[pos], mvX[i], mvW[i], mvU[i]);
+    }
+    fprintf(stream, "  Average molar mass: %8g\n", mvMolarMassAvg);
+}
+
+/// Updates the fractions when the composition is unlocked (see CompositionKernels::UpdateFractions)
+void DynamicComposition::updateFractions()
+{
+    COMPOSITION_COUNT(UpdateUnlocked);
+    Accessor el { *this };
+    CompositionKernels::UpdateFractions(el, mvPartition, mvMolarMassAvg,
+        mvMolarMassAvgFixedPartial, mvXSumSubstitutionalFixedPartial);
+}
+
+/// Updates the fractions when the composition is locked (see CompositionKernels::UpdateFractionsUFixed)
+void DynamicComposition::updateFractionsUFixed()
+{
+    COMPOSITION_COUNT(UpdateLocked);
+    Accessor el { *this };
+    CompositionKernels::UpdateFractionsUFixed(el, mvPartition, mvMolarMassAvg,
+        mvMolarMassAvgFixedPartial, mvXSumSubstitutionalFixedPartial);
+}
@@ -4,6 +4,10 @@
 #include <cassert>
 #include <cmath>
 #include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 /// Tolerance for floating point comparisons
 static const double TOL = 1e-9;
@@ -28,6 +32,25 @@ MAKE_COMPOSITION_CLASS(CompositionFeC, FOR_FE_C_ELEMENTS)
 
 MAKE_COMPOSITION_CLASS(CompositionSteel, FOR_STEEL_ELEMENTS)
 
+/// Alloy with variable and fixed, interstitial and substitutional elements
+#define FOR_ALLOY_ELEMENTS(DO) \
+    DO(Fe, false, false, true) \
+    DO(C, true, true)          \
+    DO(N, false, true)         \
+    DO(Mn, true)               \
+    DO(Si)
+
+MAKE_COMPOSITION_CLASS(CompositionAlloy, FOR_ALLOY_ELEMENTS)
+
+/// Steel whose only variable elements are interstitial
+#define FOR_CARBON_STEEL_ELEMENTS(DO) \
+    DO(Fe, false, false, true)        \
+    DO(C, true, true)                 \
+    DO(N, true, true)                 \
+    DO(Mn)
+
+MAKE_COMPOSITION_CLASS(CompositionCarbonSteel, FOR_CARBON_STEEL_ELEMENTS)
+
 /// Test: setting mole fraction X and checking weight fraction W (binary Fe-C)
 /// C is interstitial: X_C is relative to substitutional sublattice (X_Fe = 1.0)
 /// W_C = (X_C * M_C) / (X_C * M_C + X_Fe * M_Fe)
@@ -169,6 +192,314 @@ static void test_UnlockComposition()
     printf("PASS: test_UnlockComposition\n");
 }
 
+/// Test: copies keep working independently of the original composition
+static void test_CopyComposition()
+{
+    CompositionSteel comp;
+    comp.C.SetX(0.05);
+    comp.Mn.SetX(0.02);
+    comp.UpdateFractions();
+
+    CompositionSteel copy = comp;
+    copy.Mn.SetX(0.03);
+    copy.UpdateFractions();
+    assert(nearlyEqual(comp.Mn.GetX(), 0.02));
+    assert(nearlyEqual(copy.Mn.GetX(), 0.03));
+    assert(nearlyEqual(copy["Mn"].GetX(), 0.03));
+
+    static_assert(std::is_trivially_copyable<CompositionSteel>::value, "Compositions must be trivially copyable");
+
+    std::vector<CompositionSteel> comps(3, comp);
+    comps.push_back(std::move(copy));
+    comps[0] = comps[3];
+    comps[0].UpdateFractions();
+    assert(nearlyEqual(comps[0].C.GetX(), 0.05));
+    assert(nearlyEqual(comps[0].Mn.GetX(), 0.03));
+    assert(nearlyEqual(comps[0].Fe.GetX(), 1.0 - 0.05 - 0.03));
+    assert(comps[1].GetMajorElementSymbol() == "Fe");
+
+    size_t n = 0;
+    for (const ElementData& el : comps[0].GetElements()) {
+        assert(&el == &comps[0][el.GetSymbol()]);
+        n++;
+    }
+    assert(n == CompositionSteel::NumberOfElements && n == comps[0].GetNumberOfElements());
+    printf("PASS: test_CopyComposition\n");
+}
+
+/// Test: getters read the stored fractions, and copies of elements and
+/// compositions are independent of the original
+static void test_CopiedElements()
+{
+    CompositionAlloy comp;
+    comp.C.SetW(3e-3);
+    comp.Mn.SetW(1.5e-2);
+    comp.UpdateFractions();
+    double xFe = comp.Fe.GetX();
+
+    // Setting a fraction does not update the other elements
+    comp.Si.SetX(4e-3);
+    assert(comp.Si.GetX() == 4e-3 && comp.Fe.GetX() == xFe);
+
+    ElementData si = comp.Si;
+    const CompositionAlloy copy = comp;
+    comp.UpdateFractions();
+    assert(comp.Fe.GetX() != xFe);
+    assert(copy.Fe.GetX() == xFe && si.GetX() == 4e-3 && si.GetW() == 0.0);
+
+    CompositionAlloy updated = copy;
+    updated.UpdateFractions();
+    auto elements = updated.GetElements();
+    auto it = elements.begin();
+    for (const ElementData& el : comp.GetElements()) {
+        assert(el.GetX() == it->GetX() && el.GetW() == it->GetW() && el.GetU() == it->GetU());
+        ++it;
+    }
+
+    si.SetX(1e-2);
+    assert(si.GetX() == 1e-2 && comp.Si.GetX() == 4e-3);
+    printf("PASS: test_CopiedElements\n");
+}
+
+/// Test: conversions of arrays of mole fractions of a variable interstitial
+/// element of a locked composition give identical results to SetX
+static void test_ConvertLockedInterstitial()
+{
+    CompositionCarbonSteel comp;
+    comp.C.SetW(3e-3);
+    comp.N.SetX(1e-4);
+    comp.Mn.SetW(1.5e-2);
+    comp.LockComposition();
+    comp.N.SetX(2e-4);
+
+    const size_t n = 5;
+    double x[n] = { 0.0, 1e-3, 1e-2, 2e-2, 5e-2 }, w[n], u[n], molarMassAvg[n];
+    for (const ElementData* pEl : { &comp.C, &comp.N }) {
+        comp.ConvertLockedInterstitial(*pEl, x, n, w, u, molarMassAvg);
+        for (size_t i = 0; i < n; i++) {
+            CompositionCarbonSteel copy = comp;
+            copy[pEl->GetSymbol()].SetX(x[i]);
+            copy.UpdateFractions();
+            assert(w[i] == copy[pEl->GetSymbol()].GetW());
+            assert(u[i] == copy[pEl->GetSymbol()].GetU());
+        }
+    }
+
+    // Mn is variable and substitutional
+    CompositionAlloy alloy;
+    alloy.LockComposition();
+    w[0] = -1;
+    assert(alloy.ConvertLockedInterstitial(alloy.C, x, 1, w) == CompositionStatus::InvalidArgument);
+    assert(w[0] == -1);
+    assert(comp.ConvertLockedInterstitial(comp.Mn, x, 1, w) == CompositionStatus::InvalidArgument);
+    printf("PASS: test_ConvertLockedInterstitial\n");
+}
+
+/// Diagnostic callback counting the errors of the C element
+static void countErrorsOfC(CompositionStatus, const char* symbol, void* userData)
+{
+    if (symbol != nullptr && std::string(symbol) == "C")
+        ++*static_cast<int*>(userData);
+}
+
+/// Test: the noexcept setters return status codes, leave the element
+/// unchanged on errors and report them to the counters and callback
+static void test_StatusCodes()
+{
+    static_assert(noexcept(std::declval<ElementData&>().TrySetX(0.0)), "TrySetX must be noexcept");
+
+    CompositionErrorCounters counters;
+    int errorsOfC = 0;
+    CompositionDiagnostics::SetErrorCounters(&counters);
+    CompositionDiagnostics::SetCallback(countErrorsOfC, &errorsOfC);
+
+    CompositionAlloy comp;
+    assert(comp.C.TrySetW(3e-3) == CompositionStatus::Ok);
+    assert(comp.Si.TrySetX(1e-2) == CompositionStatus::Ok);
+    assert(comp.Fe.TrySetX(0.5) == CompositionStatus::MajorElement);
+    assert(comp.TryLockComposition() == CompositionStatus::Ok);
+    double wC = comp.C.GetW(), xSi = comp.Si.GetX();
+
+    assert(comp.Si.TrySetX(2e-2) == CompositionStatus::LockedElement);
+    assert(comp.C.TrySetW(1e-2) == CompositionStatus::LockedMassFraction);
+    assert(comp.TryUpdateFractions() == CompositionStatus::Ok);
+    assert(comp.C.GetW() == wC && comp.Si.GetX() == xSi);
+
+    assert(counters.Get(CompositionStatus::Ok) == 0);
+    assert(counters.Get(CompositionStatus::MajorElement) == 1);
+    assert(counters.Get(CompositionStatus::LockedElement) == 1);
+    assert(counters.Get(CompositionStatus::LockedMassFraction) == 1);
+    assert(counters.Total() == 3);
+    assert(errorsOfC == 1);
+
+    counters.Reset();
+    CompositionDiagnostics::SetErrorCounters(nullptr);
+    CompositionDiagnostics::SetCallback(nullptr);
+    assert(comp.Fe.TrySetX(0.5) == CompositionStatus::MajorElement);
+    assert(counters.Total() == 0 && errorsOfC == 1);
+    assert(std::string(GetStatusMessage(CompositionStatus::LockedElement)) == "Cannot set locked composition");
+    printf("PASS: test_StatusCodes\n");
+}
+
+/// Fractions of all elements of a composition, in order of definition
+static std::vector<double> fractions(const Composition& comp, char fraction)
+{
+    std::vector<double> values;
+    for (const ElementData& el : comp.GetElements()) {
+        values.push_back(fraction == 'X' ? el.GetX() : (fraction == 'W' ? el.GetW() : el.GetU()));
+    }
+    return values;
+}
+
+/// Checks a Jacobian against central finite differences, setting the
+/// independent elements with SetX (if input is 'X') or SetW. The fractions of
+/// the other independent elements are held constant
+static void assertJacobian(const CompositionAlloy& comp, const CompositionJacobian& jac,
+    const std::vector<double>& derivatives, char input, char output)
+{
+    const double h = 1e-7;
+    std::vector<std::string> symbols;
+    for (const ElementData& el : comp.GetElements()) {
+        symbols.push_back(el.GetSymbol());
+    }
+
+    for (size_t i = 0; i < jac.Columns.size(); i++) {
+        const std::string& symbol = symbols[jac.Columns[i]];
+        double value = input == 'X' ? comp[symbol].GetX() : comp[symbol].GetW();
+        CompositionAlloy plus = comp, minus = comp;
+        if (comp.IsCompositionLocked()) {
+            // Holds the mole fractions of the other variable elements, instead of their site fractions
+            for (size_t k : jac.Columns) {
+                plus[symbols[k]].SetX(comp[symbols[k]].GetX());
+                minus[symbols[k]].SetX(comp[symbols[k]].GetX());
+            }
+        }
+        if (input == 'X') {
+            plus[symbol].SetX(value + h);
+            minus[symbol].SetX(value - h);
+        } else {
+            plus[symbol].SetW(value + h);
+            minus[symbol].SetW(value - h);
+        }
+        plus.UpdateFractions();
+        minus.UpdateFractions();
+
+        std::vector<double> valuesPlus = fractions(plus, output), valuesMinus = fractions(minus, output);
+        for (size_t j = 0; j < jac.NumberOfElements; j++) {
+            double finiteDifference = (valuesPlus[j] - valuesMinus[j]) / (2 * h);
+            assert(nearlyEqual(derivatives[jac.Index(j, i)], finiteDifference, 1e-6));
+        }
+    }
+}
+
+/// Test: analytic Jacobians agree with finite differences (unlocked and locked)
+static void test_Jacobian()
+{
+    CompositionAlloy comp;
+    comp.C.SetX(1.5e-2);
+    comp.N.SetX(1e-3);
+    comp.Mn.SetX(1.5e-2);
+    comp.Si.SetX(4e-3);
+    comp.UpdateFractions();
+
+    CompositionJacobian jac;
+    comp.GetJacobian(jac);
+    assert(jac.NumberOfElements == 5 && jac.Columns.size() == 4);
+    assert(jac.Columns[0] == 1 && jac.Columns[3] == 4);
+    assertJacobian(comp, jac, jac.dWdX, 'X', 'W');
+    assertJacobian(comp, jac, jac.dUdX, 'X', 'U');
+
+    // Same composition, given in mass fractions
+    CompositionAlloy compW;
+    for (const ElementData& el : comp.GetElements()) {
+        if (!el.IsMajor())
+            compW[el.GetSymbol()].SetW(el.GetW());
+    }
+    compW.UpdateFractions();
+    assertJacobian(compW, jac, jac.dXdW, 'W', 'X');
+
+    // Locked: the columns are the variable elements, C and Mn
+    comp.LockComposition();
+    comp.C.SetX(2e-2);
+    comp.UpdateFractions();
+    comp.GetJacobian(jac);
+    assert(jac.Columns.size() == 2 && jac.Columns[0] == 1 && jac.Columns[1] == 3);
+    assertJacobian(comp, jac, jac.dWdX, 'X', 'W');
+    assertJacobian(comp, jac, jac.dUdX, 'X', 'U');
+
+    // dX/dW is the inverse of dW/dX for the independent elements
+    for (size_t i = 0; i < 2; i++) {
+        for (size_t k = 0; k < 2; k++) {
+            double product = 0.0;
+            for (size_t j = 0; j < 2; j++) {
+                product += jac.dXdW[jac.Index(jac.Columns[i], j)] * jac.dWdX[jac.Index(jac.Columns[j], k)];
+            }
+            assert(nearlyEqual(product, i == k ? 1.0 : 0.0, 1e-12));
+        }
+    }
+    printf("PASS: test_Jacobian\n");
+}
+
+/// Test: elements can be looked up by symbol (case insensitive) and by handle
+static void test_ElementLookup()
+{
+    static_assert(PeriodicTable::SymbolKey("Fe") == PeriodicTable::SymbolKey("FE"), "Symbol keys must be case insensitive");
+    static_assert(PeriodicTable::SymbolKey("Fe") != PeriodicTable::SymbolKey("F"), "Symbol keys must be unique");
+    static_assert(PeriodicTable::SymbolKey("Fex") == PeriodicTable::SymbolKeyCount, "Invalid symbols have no key");
+
+    CompositionSteel comp;
+    comp.C.SetX(0.05);
+    comp.UpdateFractions();
+
+    assert(&comp["C"] == &comp.C);
+    assert(&comp["mn"] == &comp.Mn);
+    assert(&comp[std::string("FE")] == &comp.Fe);
+    assert(comp.FindElement("Si") == nullptr);
+    assert(comp.FindElement("") == nullptr);
+    assert(comp.FindElement("C1") == nullptr);
+
+    bool thrown = false;
+    try {
+        comp["Si"];
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    ElementHandle hC = comp.GetElementHandle("C");
+    CompositionSteel other = comp;
+    other[hC].SetX(0.01);
+    other.UpdateFractions();
+    assert(nearlyEqual(comp[hC].GetX(), 0.05));
+    assert(nearlyEqual(other.C.GetX(), 0.01));
+    printf("PASS: test_ElementLookup\n");
+}
+
+/// Test: the periodic table is evaluated at compile time and indexed by
+/// atomic number and by symbol
+static void test_PeriodicTable()
+{
+    static_assert(PeriodicTable::Fe.MolarMass == 55.845, "Molar masses must be constant expressions");
+    static_assert(PeriodicTable::FindByAtomicNumber(26) == &PeriodicTable::Fe, "");
+    static_assert(PeriodicTable::FindByAtomicNumber(0) == nullptr, "");
+    static_assert(PeriodicTable::FindByAtomicNumber(PeriodicTable::NumberOfElements + 1) == nullptr, "");
+    static_assert(PeriodicTable::FindBySymbol("Mn") == &PeriodicTable::Mn, "");
+    static_assert(PeriodicTable::FindBySymbol("co") == &PeriodicTable::Co, "");
+    static_assert(PeriodicTable::FindBySymbol("Xx") == nullptr, "");
+    static_assert(PeriodicTable::FindBySymbol("Fe")->AtomicNumber == 26, "");
+
+    for (unsigned int z = 1; z <= PeriodicTable::NumberOfElements; z++) {
+        const PeriodicTable::Element* pEl = PeriodicTable::FindByAtomicNumber(z);
+        assert(pEl->AtomicNumber == z);
+        assert(PeriodicTable::FindBySymbol(pEl->Symbol) == pEl);
+    }
+
+    CompositionSteel comp;
+    assert(comp.Mn.GetMolarMass() == PeriodicTable::Mn.MolarMass);
+    assert(comp.Mn.GetSymbol() == PeriodicTable::Mn.Symbol);
+    printf("PASS: test_PeriodicTable\n");
+}
+
 int main()
 {
     test_SetXCheckWBinary();
@@ -179,6 +510,13 @@ int main()
     test_UFraction_Interstitial();
     test_LockComposition();
     test_UnlockComposition();
+    test_CopyComposition();
+    test_CopiedElements();
+    test_ConvertLockedInterstitial();
+    test_StatusCodes();
+    test_Jacobian();
+    test_ElementLookup();
+    test_PeriodicTable();
 
     printf("All tests passed.\n");
     return 0;
@@ -0,0 +1,283 @@
+/// Test suite for CompositionAdditionSolver using plain assert()
+
+#include "composition_additions.hpp"
+#include "composition_parallel.hpp"
+#include "test_compositions.hpp"
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+/// Number of heats used in the tests
+static const size_t N_HEATS = 500;
+
+/// Mass of each heat (kg)
+static const double HEAT_MASS = 1e5;
+
+/// Additions: ferromanganese, ferrosilicon, carburizer and ferrochromium
+static CompositionBatch additionBatch()
+{
+    CompositionSteel prototype;
+    CompositionBatch additions(prototype, 4);
+    CompositionSteel comps[4];
+    comps[0].Mn.SetW(0.75);
+    comps[0].C.SetW(0.07);
+    comps[1].Si.SetW(0.75);
+    comps[2].C.SetW(0.9);
+    comps[3].Cr.SetW(0.6);
+    comps[3].C.SetW(0.05);
+    comps[3].N.SetW(2e-3);
+    for (size_t k = 0; k < 4; k++) {
+        comps[k].UpdateFractions();
+        additions.Load(k, comps[k]);
+    }
+    return additions;
+}
+
+/// Heats after melting, lean in C, Mn and Si
+static CompositionBatch heatBatch()
+{
+    CompositionSteel prototype;
+    CompositionBatch heats(prototype, N_HEATS);
+    CompositionSteel comp;
+    for (size_t h = 0; h < N_HEATS; h++) {
+        comp.C.SetW(4e-4 * (1 + h % 4));
+        comp.N.SetW(5e-5 * (1 + h % 3));
+        comp.Mn.SetW(1e-3 * (1 + h % 7));
+        comp.Si.SetW(5e-4 * (h % 5));
+        comp.Cr.SetW(1e-3 * (h % 11));
+        comp.UpdateFractions();
+        heats.Load(h, comp);
+    }
+    return heats;
+}
+
+/// Targets of a low alloyed grade
+static std::vector<CompositionAdditionSolver::Target> targets(const CompositionBatch& heats)
+{
+    return {
+        { heats.GetElementIndex("C"), 2e-3, 3e-3 },
+        { heats.GetElementIndex("Mn"), 1.0e-2, 1.4e-2 },
+        { heats.GetElementIndex("Si"), 2e-3, 4e-3 },
+        { heats.GetElementIndex("Cr"), 5e-3, 1.5e-2 },
+        { heats.GetElementIndex("N"), 0.0, 2e-4 },
+    };
+}
+
+/// Test: all heats reach the targets, and the results are the mass balance
+/// of the heats and additions
+static void test_Solve()
+{
+    CompositionBatch additions = additionBatch();
+    CompositionBatch heats = heatBatch();
+    CompositionAdditionSolver solver(additions);
+    assert(solver.NumberOfAdditions() == 4);
+    assert(solver.SetTargets(targets(heats)) == CompositionStatus::Ok);
+
+    std::vector<double> heatMasses(N_HEATS, HEAT_MASS);
+    std::vector<double> masses(N_HEATS * 4), deviations(N_HEATS);
+    CompositionBatch results((CompositionSteel()));
+    assert(solver.Solve(heats, heatMasses.data(), masses.data(), deviations.data(), results) == CompositionStatus::Ok);
+    assert(results.Size() == N_HEATS);
+
+    for (size_t h = 0; h < N_HEATS; h++) {
+        const double* a = masses.data() + 4 * h;
+        assert(deviations[h] <= 1e-15);
+        for (const CompositionAdditionSolver::Target& target : solver.GetTargets()) {
+            double w = results.GetW(target.Element, h);
+            assert(w >= target.MinW - 1e-15 && w <= target.MaxW + 1e-15);
+        }
+
+        // Mass balance, converted as a Composition
+        double total = HEAT_MASS + a[0] + a[1] + a[2] + a[3];
+        CompositionSteel reference;
+        for (ElementData& el : reference.GetElements()) {
+            if (el.IsMajor())
+                continue;
+            size_t e = heats.GetElementIndex(el.GetSymbol());
+            double mass = HEAT_MASS * heats.GetW(e, h);
+            for (size_t k = 0; k < 4; k++) {
+                assert(a[k] >= 0.0);
+                mass += a[k] * additions.GetW(e, k);
+            }
+            el.SetW(mass / total);
+        }
+        reference.UpdateFractions();
+        size_t e = 0;
+        for (const ElementData& el : reference.GetElements()) {
+            assert(results.GetX(e, h) == el.GetX());
+            assert(results.GetW(e, h) == el.GetW());
+            assert(results.GetU(e, h) == el.GetU());
+            e++;
+        }
+    }
+    printf("PASS: test_Solve\n");
+}
+
+/// Test: a single addition and a single minimum give the mass of the mass
+/// balance, and the costs choose the cheapest addition
+static void test_MinimumMassAndCosts()
+{
+    CompositionBatch additions = additionBatch();
+    CompositionBatch heats = heatBatch();
+    size_t iSi = heats.GetElementIndex("Si");
+    CompositionAdditionSolver solver(additions);
+    solver.SetTargets({ { iSi, 3e-3, 1.0 } });
+
+    std::vector<double> heatMasses(N_HEATS, HEAT_MASS);
+    std::vector<double> masses(N_HEATS * 4);
+    CompositionBatch results((CompositionSteel()));
+    solver.Solve(heats, heatMasses.data(), masses.data(), nullptr, results);
+    for (size_t h = 0; h < N_HEATS; h++) {
+        // FeSi only: H w + a wk = min (H + a)
+        double wSi = heats.GetW(iSi, h);
+        double expected = HEAT_MASS * (3e-3 - wSi) / (additions.GetW(iSi, 1) - 3e-3);
+        assert(std::fabs(masses[4 * h + 1] - expected) <= 1e-9 * expected);
+        assert(masses[4 * h] == 0.0 && masses[4 * h + 2] == 0.0 && masses[4 * h + 3] == 0.0);
+    }
+
+    // C from FeMn (0.07 C) or carburizer (0.9 C): the carburizer needs less
+    // mass, unless it is much more expensive
+    size_t iC = heats.GetElementIndex("C");
+    solver.SetTargets({ { iC, 3e-3, 1.0 } });
+    solver.Solve(heats, heatMasses.data(), masses.data(), nullptr, results);
+    assert(masses[0] == 0.0 && masses[2] > 0.0);
+    double costs[] = { 1.0, 1.0, 50.0, 1.0 };
+    assert(solver.SetCosts(costs) == CompositionStatus::Ok);
+    solver.Solve(heats, heatMasses.data(), masses.data(), nullptr, results);
+    assert(masses[0] > 0.0 && masses[2] == 0.0);
+    printf("PASS: test_MinimumMassAndCosts\n");
+}
+
+/// Test: unreachable targets are approached as close as possible, within
+/// the available masses
+static void test_Unreachable()
+{
+    CompositionBatch additions = additionBatch();
+    CompositionBatch heats = heatBatch();
+    CompositionAdditionSolver solver(additions);
+    solver.SetTargets(targets(heats));
+    double maxMasses[] = { 500.0, HUGE_VAL, HUGE_VAL, HUGE_VAL };
+    assert(solver.SetMaxMasses(maxMasses) == CompositionStatus::Ok);
+
+    std::vector<double> heatMasses(N_HEATS, HEAT_MASS);
+    std::vector<double> masses(N_HEATS * 4), deviations(N_HEATS);
+    CompositionBatch results((CompositionSteel()));
+    solver.Solve(heats, heatMasses.data(), masses.data(), deviations.data(), results);
+    size_t iMn = heats.GetElementIndex("Mn");
+    size_t nUnreachable = 0;
+    for (size_t h = 0; h < N_HEATS; h++) {
+        // 500 kg of FeMn add about 0.37 % Mn, which is not enough for the
+        // heats with less than 0.63 % Mn
+        assert(masses[4 * h] <= 500.0 * (1 + 1e-12));
+        if (deviations[h] <= 1e-15)
+            continue;
+        double w = results.GetW(iMn, h);
+        assert(w < 1e-2 && std::fabs(deviations[h] - (1e-2 - w)) <= 1e-15);
+        assert(masses[4 * h] >= 500.0 * (1 - 1e-12));
+        nUnreachable++;
+    }
+    assert(nUnreachable == 6 * N_HEATS / 7 + 1);
+    printf("PASS: test_Unreachable\n");
+}
+
+/// Test: the deviations are minimized before the cost, even when an addition
+/// reduces them much less than its cost
+static void test_DeviationsFirst()
+{
+    // Mn just above the minimum: thousands of times the mass of the heat are
+    // needed to reach it
+    CompositionSteel lean;
+    lean.Mn.SetW(1e-2 + 5e-7);
+    lean.UpdateFractions();
+    CompositionBatch additions(lean, 1);
+    additions.Load(0, lean);
+    CompositionBatch heats = heatBatch();
+    CompositionAdditionSolver solver(additions);
+    size_t iMn = heats.GetElementIndex("Mn");
+    solver.SetTargets({ { iMn, 1e-2, 1.0 } });
+
+    std::vector<double> heatMasses(N_HEATS, HEAT_MASS);
+    std::vector<double> masses(N_HEATS), deviations(N_HEATS);
+    CompositionBatch results((CompositionSteel()));
+    assert(solver.Solve(heats, heatMasses.data(), masses.data(), deviations.data(), results) == CompositionStatus::Ok);
+    for (size_t h = 0; h < N_HEATS; h++) {
+        assert(deviations[h] <= 1e-12);
+        assert(masses[h] > 5e3 * HEAT_MASS);
+    }
+    printf("PASS: test_DeviationsFirst\n");
+}
+
+/// Test: an executor gives identical results to the calling thread
+static void test_Executor()
+{
+    CompositionBatch additions = additionBatch();
+    CompositionBatch heats = heatBatch();
+    CompositionAdditionSolver solver(additions);
+    solver.SetTargets(targets(heats));
+
+    std::vector<double> heatMasses(N_HEATS);
+    for (size_t h = 0; h < N_HEATS; h++) {
+        heatMasses[h] = HEAT_MASS * (1 + h % 3);
+    }
+    std::vector<double> masses(N_HEATS * 4), parallelMasses(N_HEATS * 4);
+    CompositionSteel prototype;
+    CompositionBatch results(prototype), parallelResults(prototype);
+    solver.Solve(heats, heatMasses.data(), masses.data(), nullptr, results);
+    WorkStealingThreadPool pool(4);
+    solver.Solve(heats, heatMasses.data(), parallelMasses.data(), nullptr, parallelResults, &pool);
+    assert(masses == parallelMasses);
+    for (size_t h = 0; h < N_HEATS; h++) {
+        assert(results.GetMolarMassAvg(h) == parallelResults.GetMolarMassAvg(h));
+    }
+    printf("PASS: test_Executor\n");
+}
+
+/// Test: invalid arguments
+static void test_Errors()
+{
+    CompositionBatch additions = additionBatch();
+    CompositionBatch heats = heatBatch();
+    CompositionAdditionSolver solver(additions);
+    size_t iC = heats.GetElementIndex("C");
+    assert(solver.SetTargets({ { iC, 3e-3, 2e-3 } }) == CompositionStatus::InvalidArgument);
+    assert(solver.SetTargets({ { iC, 1e-3, 2e-3 }, { iC, 1e-3, 2e-3 } }) == CompositionStatus::InvalidArgument);
+    assert(solver.SetTargets({ { 6, 1e-3, 2e-3 } }) == CompositionStatus::InvalidArgument);
+    assert(solver.GetTargets().empty());
+    double costs[] = { 1.0, -1.0, 1.0, 1.0 };
+    assert(solver.SetCosts(costs) == CompositionStatus::InvalidArgument);
+    assert(solver.SetMaxMasses(costs) == CompositionStatus::InvalidArgument);
+
+    std::vector<double> heatMasses(N_HEATS, HEAT_MASS);
+    heatMasses[7] = 0.0;
+    std::vector<double> masses(N_HEATS * 4);
+    CompositionSteel prototype;
+    CompositionBatch results(prototype, 3);
+    assert(solver.Solve(heats, heatMasses.data(), masses.data(), nullptr, results) == CompositionStatus::InvalidArgument);
+    assert(results.Size() == 3);
+
+    CompositionFeC feC;
+    CompositionBatch other(feC, N_HEATS);
+    bool thrown = false;
+    try {
+        solver.Solve(other, heatMasses.data(), masses.data(), nullptr, results);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    printf("PASS: test_Errors\n");
+}
+
+int main()
+{
+    test_Solve();
+    test_MinimumMassAndCosts();
+    test_Unreachable();
+    test_DeviationsFirst();
+    test_Executor();
+    test_Errors();
+
+    printf("All tests passed.\n");
+    return 0;
+}
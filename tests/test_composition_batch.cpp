@@ -0,0 +1,305 @@
+/// Test suite for CompositionBatch using plain assert()
+
+#include "composition_batch.hpp"
+#include "test_compositions.hpp"
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+/// Steel whose only variable elements are interstitial
+#define FOR_CARBON_STEEL_ELEMENTS(DO) \
+    DO(Fe, false, false, true)        \
+    DO(C, true, true)                 \
+    DO(Mn)                            \
+    DO(N, true, true)                 \
+    DO(Si)
+
+MAKE_COMPOSITION_CLASS(CompositionCarbonSteel, FOR_CARBON_STEEL_ELEMENTS)
+
+/// Same symbols as CompositionSteel, but Mn is not variable
+#define FOR_FIXED_MN_STEEL_ELEMENTS(DO) \
+    DO(Fe, false, false, true)          \
+    DO(C, true, true)                   \
+    DO(N, false, true)                  \
+    DO(Mn)                              \
+    DO(Si)                              \
+    DO(Cr)
+
+MAKE_COMPOSITION_CLASS(CompositionFixedMnSteel, FOR_FIXED_MN_STEEL_ELEMENTS)
+
+/// Number of rows used in the tests
+static const size_t N_ROWS = 37;
+
+/// Sets the composition of row r in both a Composition and a CompositionBatch
+static void setRow(CompositionSteel& comp, CompositionBatch& batch, size_t r)
+{
+    double wC = 1e-3 * (1 + r % 7);
+    double xN = 1e-4 * (1 + r % 3);
+    double wMn = 1e-2 * (1 + r % 5) / 5.0;
+    double xSi = 1e-3 * (r % 4);
+    double wCr = 1e-2 * (r % 6);
+
+    comp.C.SetW(wC);
+    comp.N.SetX(xN);
+    comp.Mn.SetW(wMn);
+    comp.Si.SetX(xSi);
+    comp.Cr.SetW(wCr);
+
+    batch.SetW(batch.GetElementIndex("C"), r, wC);
+    batch.SetX(batch.GetElementIndex("N"), r, xN);
+    batch.SetW(batch.GetElementIndex("Mn"), r, wMn);
+    batch.SetX(batch.GetElementIndex("Si"), r, xSi);
+    batch.SetW(batch.GetElementIndex("Cr"), r, wCr);
+}
+
+/// Checks that row r of the batch is identical to a composition
+static void assertRowEqual(const Composition& comp, const CompositionBatch& batch, size_t r)
+{
+    size_t e = 0;
+    for (const auto& el : comp.GetElements()) {
+        assert(batch.GetSymbol(e) == el.GetSymbol());
+        assert(batch.GetX(e, r) == el.GetX());
+        assert(batch.GetW(e, r) == el.GetW());
+        assert(batch.GetU(e, r) == el.GetU());
+        e++;
+    }
+}
+
+/// Instruction sets tested
+static const InstructionSet INSTRUCTION_SETS[] = { InstructionSet::Scalar, InstructionSet::SSE2, InstructionSet::AVX2, InstructionSet::AVX512 };
+
+/// Test: batch gives identical results to the scalar path (unlocked)
+static void test_BatchUnlockedIdentical(InstructionSet instructionSet)
+{
+    CompositionSteel prototype;
+    CompositionBatch batch(prototype, N_ROWS);
+    batch.SetInstructionSet(instructionSet);
+    assert(batch.Size() == N_ROWS);
+    assert(batch.NumberOfElements() == 6);
+    assert(batch.GetMajorElementIndex() == batch.GetElementIndex("Fe"));
+
+    std::vector<CompositionSteel> comps(N_ROWS);
+    for (size_t r = 0; r < N_ROWS; r++) {
+        setRow(comps[r], batch, r);
+        comps[r].UpdateFractions();
+    }
+    batch.UpdateFractions();
+
+    for (size_t r = 0; r < N_ROWS; r++) {
+        assertRowEqual(comps[r], batch, r);
+    }
+    printf("PASS: test_BatchUnlockedIdentical\n");
+}
+
+/// Test: batch gives identical results to the scalar path (locked)
+static void test_BatchLockedIdentical(InstructionSet instructionSet)
+{
+    CompositionSteel prototype;
+    CompositionBatch batch(prototype, N_ROWS);
+    batch.SetInstructionSet(instructionSet);
+
+    std::vector<CompositionSteel> comps(N_ROWS);
+    for (size_t r = 0; r < N_ROWS; r++) {
+        setRow(comps[r], batch, r);
+        comps[r].LockComposition();
+    }
+    batch.LockComposition();
+    assert(batch.IsCompositionLocked());
+
+    size_t iC = batch.GetElementIndex("C");
+    size_t iMn = batch.GetElementIndex("Mn");
+    for (int step = 0; step < 3; step++) {
+        for (size_t r = 0; r < N_ROWS; r++) {
+            // In the last step, only some rows change
+            if (step == 2 && r % 5 != 0)
+                continue;
+            double xC = 1e-2 * (1 + (r + step) % 4);
+            comps[r].C.SetX(xC);
+            batch.SetX(iC, r, xC);
+            if (step == 1 && r % 3 == 0) {
+                comps[r].Mn.SetX(2e-2);
+                batch.SetX(iMn, r, 2e-2);
+            }
+        }
+        for (size_t r = 0; r < N_ROWS; r++) {
+            comps[r].UpdateFractions();
+        }
+        batch.UpdateFractions();
+
+        for (size_t r = 0; r < N_ROWS; r++) {
+            assertRowEqual(comps[r], batch, r);
+        }
+    }
+    printf("PASS: test_BatchLockedIdentical\n");
+}
+
+/// Test: locked compositions whose only variable elements are interstitial
+/// give identical results to the batch
+static void test_BatchLockedInterstitialIdentical(InstructionSet instructionSet)
+{
+    CompositionCarbonSteel prototype;
+    CompositionBatch batch(prototype, N_ROWS);
+    batch.SetInstructionSet(instructionSet);
+
+    size_t iC = batch.GetElementIndex("C");
+    size_t iN = batch.GetElementIndex("N");
+    size_t iMn = batch.GetElementIndex("Mn");
+    size_t iSi = batch.GetElementIndex("Si");
+    std::vector<CompositionCarbonSteel> comps(N_ROWS);
+    for (size_t r = 0; r < N_ROWS; r++) {
+        comps[r].C.SetW(1e-3 * (1 + r % 7));
+        comps[r].N.SetX(1e-4 * (1 + r % 3));
+        comps[r].Mn.SetW(1e-2 * (1 + r % 5) / 5.0);
+        comps[r].Si.SetX(1e-3 * (r % 4));
+        batch.Load(r, comps[r]);
+        comps[r].LockComposition();
+    }
+    batch.LockComposition();
+
+    for (int step = 0; step < 4; step++) {
+        for (size_t r = 0; r < N_ROWS; r++) {
+            double xC = 1e-2 * (1 + (r + step) % 4);
+            comps[r].C.SetX(xC);
+            batch.SetX(iC, r, xC);
+            if (step % 2 == 1) {
+                comps[r].N.SetX(1e-3 * (1 + r % 2));
+                batch.SetX(iN, r, 1e-3 * (1 + r % 2));
+            }
+            comps[r].UpdateFractions();
+        }
+        batch.UpdateFractions();
+
+        for (size_t r = 0; r < N_ROWS; r++) {
+            // Elements read in different orders
+            if (r % 2 == 0)
+                assert(comps[r].Fe.GetX() == batch.GetX(batch.GetMajorElementIndex(), r));
+            assert(comps[r].Si.GetW() == batch.GetW(iSi, r));
+            assert(comps[r].Mn.GetX() == batch.GetX(iMn, r));
+            assertRowEqual(comps[r], batch, r);
+        }
+    }
+    printf("PASS: test_BatchLockedInterstitialIdentical\n");
+}
+
+/// Checks that two Jacobians are identical
+static void assertJacobianEqual(const CompositionJacobian& a, const CompositionJacobian& b)
+{
+    assert(a.NumberOfElements == b.NumberOfElements);
+    assert(a.Columns == b.Columns);
+    assert(a.dWdX == b.dWdX && a.dXdW == b.dXdW && a.dUdX == b.dUdX);
+    assert(a.dMolarMassAvgdX == b.dMolarMassAvgdX);
+}
+
+/// Test: batch Jacobians are identical to the ones of the compositions
+static void test_BatchJacobian()
+{
+    CompositionSteel prototype;
+    CompositionBatch batch(prototype, N_ROWS);
+    std::vector<CompositionSteel> comps(N_ROWS);
+    for (size_t r = 0; r < N_ROWS; r++) {
+        setRow(comps[r], batch, r);
+        comps[r].UpdateFractions();
+    }
+    batch.UpdateFractions();
+
+    CompositionJacobian jacComp, jacBatch;
+    for (size_t r = 0; r < N_ROWS; r++) {
+        comps[r].GetJacobian(jacComp);
+        batch.GetJacobian(r, jacBatch);
+        assert(jacBatch.Columns.size() == 5);
+        assertJacobianEqual(jacComp, jacBatch);
+    }
+
+    batch.LockComposition();
+    for (size_t r = 0; r < N_ROWS; r++) {
+        comps[r].LockComposition();
+        comps[r].GetJacobian(jacComp);
+        batch.GetJacobian(r, jacBatch);
+        assert(jacBatch.Columns.size() == 2);
+        assertJacobianEqual(jacComp, jacBatch);
+    }
+    printf("PASS: test_BatchJacobian\n");
+}
+
+/// Test: fixed elements cannot be changed when the batch is locked
+static void test_BatchLockedFixedElement()
+{
+    CompositionSteel prototype;
+    CompositionBatch batch(prototype, 2);
+    size_t iSi = batch.GetElementIndex("Si");
+    batch.SetX(iSi, 0, 1e-3);
+    batch.LockComposition();
+    batch.SetX(iSi, 0, 2e-3);
+    double x[2] = { 2e-3, 3e-3 };
+    assert(batch.TrySetX(iSi, 1, 2e-3) == CompositionStatus::LockedElement);
+    assert(batch.TrySetX(iSi, x) == CompositionStatus::LockedElement);
+    assert(batch.TrySetW(batch.GetElementIndex("C"), x) == CompositionStatus::LockedMassFraction);
+    assert(batch.TrySetX(batch.GetElementIndex("Fe"), 0, 0.5) == CompositionStatus::MajorElement);
+    batch.UpdateFractions();
+    batch.UnlockComposition();
+    batch.UpdateFractions();
+
+    assert(batch.GetX(iSi, 0) == 1e-3);
+    assert(batch.GetX(iSi, 1) == 0.0);
+    printf("PASS: test_BatchLockedFixedElement\n");
+}
+
+/// Test: rows can be loaded from and stored into compositions
+static void test_BatchLoadStore()
+{
+    CompositionSteel comp;
+    comp.C.SetW(5e-3);
+    comp.Mn.SetW(2e-2);
+    comp.UpdateFractions();
+
+    CompositionBatch batch(comp, 1);
+    batch.Resize(3);
+    batch.Load(2, comp);
+    assertRowEqual(comp, batch, 2);
+    assert(batch.GetMolarMassAvg(2) > 0);
+
+    CompositionSteel other;
+    batch.Store(2, other);
+    assertRowEqual(other, batch, 2);
+    printf("PASS: test_BatchLoadStore\n");
+}
+
+/// Test: compositions and batches with the same symbols but other element
+/// flags have a different layout, and cannot be loaded
+static void test_BatchHasSameLayout()
+{
+    CompositionSteel comp;
+    CompositionFixedMnSteel fixedMn;
+    CompositionBatch batch(comp, 2);
+    assert(batch.HasSameLayout(comp));
+    assert(batch.HasSameLayout(CompositionBatch(comp)));
+    assert(!batch.HasSameLayout(fixedMn));
+    assert(!batch.HasSameLayout(CompositionBatch(fixedMn)));
+
+    bool thrown = false;
+    try {
+        batch.Load(0, fixedMn);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    printf("PASS: test_BatchHasSameLayout\n");
+}
+
+int main()
+{
+    printf("Supported instruction set: %d\n", static_cast<int>(CompositionBatch::GetSupportedInstructionSet()));
+    for (InstructionSet instructionSet : INSTRUCTION_SETS) {
+        test_BatchUnlockedIdentical(instructionSet);
+        test_BatchLockedIdentical(instructionSet);
+        test_BatchLockedInterstitialIdentical(instructionSet);
+    }
+    test_BatchLockedFixedElement();
+    test_BatchLoadStore();
+    test_BatchHasSameLayout();
+    test_BatchJacobian();
+
+    printf("All tests passed.\n");
+    return 0;
+}
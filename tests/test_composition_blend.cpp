@@ -0,0 +1,171 @@
+/// Test suite for CompositionBlender using plain assert()
+
+#include "composition_blend.hpp"
+#include "test_compositions.hpp"
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+/// Number of sources and mixes used in the tests
+static const size_t N_SOURCES = 40;
+static const size_t N_MIXES = 300;
+
+/// Sets the fractions of source s (scrap with few alloying elements, or
+/// ferroalloys rich in one element)
+static void setSource(CompositionSteel& comp, size_t s)
+{
+    if (s % 10 == 0) {
+        comp.Mn.SetW(0.75); // ferromanganese
+        comp.C.SetW(0.07);
+    } else if (s % 10 == 1) {
+        comp.Cr.SetW(0.6); // ferrochromium
+        comp.C.SetW(0.05);
+        comp.N.SetW(1e-3);
+    } else {
+        comp.C.SetW(1e-3 * (1 + s % 5));
+        comp.Mn.SetX(1e-3 * (1 + s % 7));
+        comp.Si.SetW(2e-3 * (s % 3));
+        comp.N.SetX(1e-5 * (1 + s % 11));
+    }
+}
+
+/// Masses of the sources in each mix, most of them zero
+static std::vector<double> masses()
+{
+    std::vector<double> masses(N_MIXES * N_SOURCES, 0.0);
+    for (size_t m = 0; m < N_MIXES; m++) {
+        for (size_t k = 0; k < 6; k++) {
+            size_t s = (m * 7 + k * 13) % N_SOURCES;
+            masses[m * N_SOURCES + s] += 100.0 + (m * 31 + k * 17) % 900;
+        }
+    }
+    return masses;
+}
+
+/// Builds the batch of sources
+static CompositionBatch sourceBatch(std::vector<CompositionSteel>& sources)
+{
+    CompositionBatch batch(sources[0], N_SOURCES);
+    for (size_t s = 0; s < N_SOURCES; s++) {
+        setSource(sources[s], s);
+        sources[s].UpdateFractions();
+        batch.Load(s, sources[s]);
+    }
+    return batch;
+}
+
+/// Test: mixes are identical to compositions set to the blended mass
+/// fractions, and conserve the mass of each element
+static void test_Blend()
+{
+    std::vector<CompositionSteel> sources(N_SOURCES);
+    CompositionBlender blender(sourceBatch(sources));
+    assert(blender.NumberOfSources() == N_SOURCES);
+    assert(blender.NumberOfElements() == 6);
+
+    std::vector<double> m = masses();
+    CompositionBatch mixes(sources[0], 5);
+    mixes.LockComposition();
+    assert(blender.Blend(m.data(), N_MIXES, mixes) == CompositionStatus::Ok);
+    assert(mixes.Size() == N_MIXES);
+    assert(!mixes.IsCompositionLocked());
+
+    for (size_t r = 0; r < N_MIXES; r++) {
+        const double* row = m.data() + r * N_SOURCES;
+        CompositionSteel reference;
+        for (ElementData& el : reference.GetElements()) {
+            if (el.IsMajor())
+                continue;
+            double sum = 0.0, total = 0.0;
+            for (size_t s = 0; s < N_SOURCES; s++) {
+                if (row[s] == 0.0)
+                    continue;
+                sum += row[s] * sources[s][el.GetSymbol()].GetW();
+                total += row[s];
+            }
+            el.SetW(sum / total);
+        }
+        reference.UpdateFractions();
+
+        size_t e = 0;
+        for (const ElementData& el : reference.GetElements()) {
+            assert(mixes.GetX(e, r) == el.GetX());
+            assert(mixes.GetW(e, r) == el.GetW());
+            assert(mixes.GetU(e, r) == el.GetU());
+
+            // Mass of the element in the mix
+            double mass = 0.0, total = 0.0;
+            for (size_t s = 0; s < N_SOURCES; s++) {
+                mass += row[s] * sources[s][el.GetSymbol()].GetW();
+                total += row[s];
+            }
+            assert(std::fabs(mixes.GetW(e, r) * total - mass) <= 1e-12 * total);
+            e++;
+        }
+    }
+    printf("PASS: test_Blend\n");
+}
+
+/// Test: a mix of a single source has the fractions of the source
+static void test_SingleSource()
+{
+    std::vector<CompositionSteel> sources(N_SOURCES);
+    CompositionBlender blender(sourceBatch(sources));
+    std::vector<double> m(N_SOURCES, 0.0);
+    m[3] = 2.5;
+    CompositionBatch mixes(sources[0]);
+    assert(blender.Blend(m.data(), 1, mixes) == CompositionStatus::Ok);
+    size_t e = 0;
+    for (const ElementData& el : sources[3].GetElements()) {
+        assert(std::fabs(mixes.GetX(e, 0) - el.GetX()) <= 1e-15);
+        assert(std::fabs(mixes.GetW(e, 0) - el.GetW()) <= 1e-15);
+        e++;
+    }
+    printf("PASS: test_SingleSource\n");
+}
+
+/// Test: invalid masses and batches with other elements
+static void test_Errors()
+{
+    std::vector<CompositionSteel> sources(N_SOURCES);
+    CompositionBlender blender(sourceBatch(sources));
+    std::vector<double> m = masses();
+    CompositionBatch mixes(sources[0], 7);
+
+    // Total mass zero
+    for (size_t s = 0; s < N_SOURCES; s++) {
+        m[5 * N_SOURCES + s] = 0.0;
+    }
+    assert(blender.Blend(m.data(), N_MIXES, mixes) == CompositionStatus::InvalidArgument);
+    assert(mixes.Size() == 7);
+
+    // Negative mass
+    m[5 * N_SOURCES] = 1.0;
+    m[6 * N_SOURCES] = -1.0;
+    assert(blender.Blend(m.data(), N_MIXES, mixes) == CompositionStatus::InvalidArgument);
+    m[6 * N_SOURCES] = 0.0;
+    assert(blender.Blend(m.data(), N_MIXES, mixes) == CompositionStatus::Ok);
+
+    CompositionFeC feC;
+    CompositionBatch other(feC);
+    bool thrown = false;
+    try {
+        blender.Blend(m.data(), N_MIXES, other);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    printf("PASS: test_Errors\n");
+}
+
+int main()
+{
+    test_Blend();
+    test_SingleSource();
+    test_Errors();
+
+    printf("All tests passed.\n");
+    return 0;
+}
@@ -0,0 +1,164 @@
+/// Test suite for CompositionCatalog using plain assert()
+
+#include "composition_catalog.hpp"
+#include "test_compositions.hpp"
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/// Number of grades of the catalog used in the tests
+static const size_t N_GRADES = 5000;
+
+/// Sets the fractions of grade i, with repeated values of C so that ranges
+/// have ties
+static void setGrade(CompositionSteel& comp, size_t i)
+{
+    comp.C.SetW(1e-4 * (1 + i % 50));
+    comp.N.SetX(1e-5 * (1 + (i * 7) % 300));
+    comp.Mn.SetW(1e-3 * (1 + (i * 13) % 250));
+    comp.Si.SetX(1e-3 * (1 + (i * 3) % 20));
+    comp.Cr.SetW(i % 4 ? 0.0 : 1e-3 * (i % 180));
+}
+
+/// Builds the catalog of the tests
+static void buildCatalog(CompositionCatalog& catalog)
+{
+    CompositionSteel comp;
+    for (size_t i = 0; i < N_GRADES; i++) {
+        setGrade(comp, i);
+        size_t index = catalog.Add(comp, "grade " + std::to_string(i));
+        assert(index == i);
+        (void)index;
+    }
+    assert(!catalog.IsBuilt());
+    catalog.Build();
+    assert(catalog.IsBuilt());
+}
+
+/// Grades whose fractions are in all ranges, found by a linear scan of
+/// compositions
+static std::vector<size_t> findLinear(const std::vector<CompositionCatalog::Range>& ranges)
+{
+    const char* symbols[] = { "Fe", "C", "N", "Mn", "Si", "Cr" };
+    std::vector<size_t> grades;
+    CompositionSteel comp;
+    for (size_t i = 0; i < N_GRADES; i++) {
+        setGrade(comp, i);
+        comp.UpdateFractions();
+        bool isMatch = true;
+        for (const CompositionCatalog::Range& range : ranges) {
+            const ElementData& el = comp[symbols[range.Element]];
+            double value = range.Fraction == FieldFraction::X ? el.GetX() : (range.Fraction == FieldFraction::W ? el.GetW() : el.GetU());
+            isMatch = isMatch && range.Min <= value && value <= range.Max;
+        }
+        if (isMatch)
+            grades.push_back(i);
+    }
+    return grades;
+}
+
+/// Test: the fractions of the catalog are identical to UpdateFractions
+static void test_Fractions()
+{
+    CompositionSteel prototype;
+    CompositionCatalog catalog(prototype);
+    buildCatalog(catalog);
+    assert(catalog.Size() == N_GRADES);
+    assert(catalog.GetName(42) == "grade 42");
+
+    CompositionSteel comp, stored;
+    for (size_t i = 0; i < N_GRADES; i += 7) {
+        setGrade(comp, i);
+        comp.UpdateFractions();
+        catalog.Store(i, stored);
+        size_t e = 0;
+        for (const ElementData& el : comp.GetElements()) {
+            assert(catalog.GetX(e, i) == el.GetX());
+            assert(catalog.GetW(e, i) == el.GetW());
+            assert(catalog.GetU(e, i) == el.GetU());
+            assert(stored[el.GetSymbol()].GetW() == el.GetW());
+            e++;
+        }
+    }
+    printf("PASS: test_Fractions\n");
+}
+
+/// Test: Find and Count agree with a linear scan, for ranges in mixed bases
+static void test_Find()
+{
+    CompositionSteel prototype;
+    CompositionCatalog catalog(prototype);
+    buildCatalog(catalog);
+    size_t iC = catalog.GetElementIndex("C");
+    size_t iN = catalog.GetElementIndex("N");
+    size_t iMn = catalog.GetElementIndex("Mn");
+    size_t iCr = catalog.GetElementIndex("Cr");
+    size_t iFe = catalog.GetElementIndex("Fe");
+
+    std::vector<std::vector<CompositionCatalog::Range>> queries = {
+        // C 0.1-0.3 wt%, Mn < 2 at%, N site fraction < 1e-3
+        { { iC, FieldFraction::W, 1e-3, 3e-3 },
+            { iMn, FieldFraction::X, 0.0, std::nextafter(2e-2, 0.0) },
+            { iN, FieldFraction::U, 0.0, std::nextafter(1e-3, 0.0) } },
+        // Bounds equal to stored values (ties)
+        { { iC, FieldFraction::W, catalog.GetW(iC, 9), catalog.GetW(iC, 9) } },
+        { { iCr, FieldFraction::W, 0.0, 0.0 }, { iFe, FieldFraction::X, 0.9 } },
+        { { iN, FieldFraction::X, 1e-3 }, { iMn, FieldFraction::U, -1.0, 5e-2 } },
+        { { iCr, FieldFraction::U, 0.2 } }, // none
+        { { iC, FieldFraction::W, 3e-3, 1e-3 } }, // empty range
+        {}, // all grades
+    };
+    size_t nonEmpty = 0;
+    for (const auto& ranges : queries) {
+        std::vector<size_t> found = catalog.Find(ranges);
+        assert(found == findLinear(ranges));
+        assert(catalog.Count(ranges) == found.size());
+        nonEmpty += !found.empty();
+    }
+    assert(nonEmpty == 5);
+    assert(catalog.Count({}) == N_GRADES);
+    printf("PASS: test_Find\n");
+}
+
+/// Test: queries of a catalog that is not built, and undefined elements
+static void test_Errors()
+{
+    CompositionSteel prototype;
+    CompositionCatalog catalog(prototype);
+    assert(!catalog.IsBuilt());
+    catalog.Build();
+    assert(catalog.Find({}).empty());
+
+    catalog.Add(prototype);
+    bool thrown = false;
+    try {
+        catalog.Count({});
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    catalog.Build();
+    assert(catalog.Count({}) == 1);
+    thrown = false;
+    try {
+        catalog.Find({ { catalog.NumberOfElements(), FieldFraction::X, 0.0, 1.0 } });
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    printf("PASS: test_Errors\n");
+}
+
+int main()
+{
+    test_Fractions();
+    test_Find();
+    test_Errors();
+
+    printf("All tests passed.\n");
+    return 0;
+}
@@ -0,0 +1,134 @@
+/// Test suite for CompositionField using plain assert()
+
+#include "composition_field.hpp"
+#include "test_compositions.hpp"
+#include <cassert>
+#include <cstdio>
+#include <vector>
+
+/// Steel whose only variable element is interstitial
+#define FOR_CARBON_STEEL_ELEMENTS(DO) \
+    DO(Fe, false, false, true)        \
+    DO(C, true, true)                 \
+    DO(Mn)                            \
+    DO(Si)
+
+MAKE_COMPOSITION_CLASS(CompositionCarbonSteel, FOR_CARBON_STEEL_ELEMENTS)
+
+/// Number of cells of the fields (not a multiple of the tile sizes)
+static const size_t N_CELLS = 1037;
+
+/// Tile sizes tested
+static const size_t TILE_SIZES[] = { 1, 7, CompositionField::DefaultTileSize };
+
+/// Mole fraction of C in a cell
+static double xC(size_t cell)
+{
+    return 1e-3 * (1 + cell % 37);
+}
+
+/// Mass fraction of Mn in a cell
+static double wMn(size_t cell)
+{
+    return 1e-2 + 1e-4 * (cell % 29);
+}
+
+/// Test: unlocked fields, with interleaved inputs and separate outputs, give
+/// identical results to compositions
+static void test_FieldUnlocked()
+{
+    CompositionSteel prototype;
+    prototype.Si.SetW(2e-3);
+    prototype.Cr.SetX(1e-2);
+    prototype.N.SetX(1e-4);
+    size_t n = prototype.GetNumberOfElements();
+
+    // Interleaved array: xC, wMn for each cell
+    std::vector<double> inputs(2 * N_CELLS);
+    for (size_t c = 0; c < N_CELLS; c++) {
+        inputs[2 * c] = xC(c);
+        inputs[2 * c + 1] = wMn(c);
+    }
+
+    for (size_t tileSize : TILE_SIZES) {
+        CompositionField field(prototype, tileSize);
+        size_t iC = field.GetElementIndex("C"), iMn = field.GetElementIndex("Mn");
+        assert(field.GetTileSize() == tileSize);
+        assert(field.SetInput(iC, FieldFraction::X, &inputs[0], 2) == CompositionStatus::Ok);
+        assert(field.SetInput(iMn, FieldFraction::W, &inputs[1], 2) == CompositionStatus::Ok);
+
+        std::vector<double> x(n * N_CELLS), w(n * N_CELLS), u(n * N_CELLS), molarMassAvg(N_CELLS);
+        for (size_t e = 0; e < n; e++) {
+            field.SetOutput(e, FieldFraction::X, &x[e * N_CELLS]);
+            field.SetOutput(e, FieldFraction::W, &w[e * N_CELLS]);
+            field.SetOutput(e, FieldFraction::U, &u[e * N_CELLS]);
+        }
+        field.SetMolarMassAvgOutput(molarMassAvg.data());
+        field.Convert(0, N_CELLS);
+
+        for (size_t c = 0; c < N_CELLS; c++) {
+            CompositionSteel comp = prototype;
+            comp.C.SetX(xC(c));
+            comp.Mn.SetW(wMn(c));
+            comp.UpdateFractions();
+            size_t e = 0;
+            for (const ElementData& el : comp.GetElements()) {
+                assert(x[e * N_CELLS + c] == el.GetX());
+                assert(w[e * N_CELLS + c] == el.GetW());
+                assert(u[e * N_CELLS + c] == el.GetU());
+                e++;
+            }
+            assert(molarMassAvg[c] > 0.0);
+        }
+    }
+    printf("PASS: test_FieldUnlocked\n");
+}
+
+/// Test: locked fields converted in place give identical results to
+/// compositions, and only variable elements can be inputs
+static void test_FieldLockedInPlace()
+{
+    CompositionCarbonSteel prototype;
+    prototype.C.SetW(3e-3);
+    prototype.Mn.SetW(1.5e-2);
+    prototype.Si.SetW(2e-3);
+    prototype.LockComposition();
+
+    for (size_t tileSize : TILE_SIZES) {
+        std::vector<double> field(N_CELLS);
+        for (size_t c = 0; c < N_CELLS; c++) {
+            field[c] = xC(c);
+        }
+
+        CompositionField converter(prototype, tileSize);
+        size_t iC = converter.GetElementIndex("C");
+        assert(converter.SetInput(converter.GetElementIndex("Mn"), FieldFraction::X, field.data()) == CompositionStatus::LockedElement);
+        assert(converter.SetInput(iC, FieldFraction::W, field.data()) == CompositionStatus::LockedMassFraction);
+        assert(converter.SetInput(iC, FieldFraction::U, field.data()) == CompositionStatus::InvalidArgument);
+        assert(converter.SetInput(0, FieldFraction::X, field.data()) == CompositionStatus::MajorElement);
+        assert(converter.SetInput(iC, FieldFraction::X, field.data()) == CompositionStatus::Ok);
+        converter.SetOutput(iC, FieldFraction::W, field.data());
+
+        // In two ranges, as two threads would
+        converter.Convert(0, N_CELLS / 3);
+        CompositionField copy = converter;
+        copy.Convert(N_CELLS / 3, N_CELLS);
+
+        for (size_t c = 0; c < N_CELLS; c++) {
+            CompositionCarbonSteel comp = prototype;
+            comp.C.SetX(xC(c));
+            comp.UpdateFractions();
+            assert(field[c] == comp.C.GetW());
+        }
+    }
+    printf("PASS: test_FieldLockedInPlace\n");
+}
+
+int main()
+{
+    test_FieldUnlocked();
+    test_FieldLockedInPlace();
+
+    printf("All tests passed.\n");
+    return 0;
+}
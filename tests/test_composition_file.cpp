@@ -0,0 +1,281 @@
+/// Test suite for CompositionWriter and CompositionFileView using plain assert()
+
+#include "composition_file.hpp"
+#include "test_compositions.hpp"
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#define FOR_BINARY_ELEMENTS(DO) \
+    DO(Fe, false, false, true)  \
+    DO(C, true, true)
+
+MAKE_COMPOSITION_CLASS(CompositionBinary, FOR_BINARY_ELEMENTS)
+
+/// Contents of a file, aligned to 8 bytes
+struct FileContents {
+    std::vector<double> Buffer;
+    size_t Size = 0;
+
+    const void* Data() const { return Buffer.data(); }
+};
+
+/// Writes compositions into a temporary file and reads its contents
+static FileContents writeFile(const std::vector<CompositionSteel>& comps, uint32_t contents)
+{
+    FILE* stream = tmpfile();
+    assert(stream != nullptr);
+    CompositionWriter writer(stream, comps[0], contents);
+    for (const CompositionSteel& comp : comps) {
+        writer.Write(comp);
+    }
+    assert(writer.NumberOfRecords() == comps.size());
+    writer.Close();
+
+    FileContents file;
+    file.Size = static_cast<size_t>(ftell(stream));
+    file.Buffer.resize((file.Size + sizeof(double) - 1) / sizeof(double));
+    rewind(stream);
+    size_t read = fread(file.Buffer.data(), 1, file.Size, stream);
+    assert(read == file.Size);
+    (void)read;
+    fclose(stream);
+    return file;
+}
+
+/// Compositions with varying fractions, the last ones locked
+static std::vector<CompositionSteel> makeCompositions()
+{
+    std::vector<CompositionSteel> comps(5);
+    for (size_t i = 0; i < comps.size(); i++) {
+        CompositionSteel& comp = comps[i];
+        comp.C.SetW(1e-3 * (i + 1));
+        comp.N.SetX(1e-4);
+        comp.Mn.SetW(1e-2 + 1e-3 * i);
+        comp.Si.SetX(5e-3);
+        comp.Cr.SetW(2e-2);
+        if (i >= 3) {
+            comp.LockComposition();
+            comp.C.SetX(2e-3 * i);
+        }
+        comp.UpdateFractions();
+    }
+    return comps;
+}
+
+/// Asserts that two compositions have identical fractions
+static void assertSameFractions(const CompositionSteel& a, const CompositionSteel& b)
+{
+    assert(a.IsCompositionLocked() == b.IsCompositionLocked());
+    for (const char* symbol : { "Fe", "C", "N", "Mn", "Si", "Cr" }) {
+        assert(a[symbol].GetX() == b[symbol].GetX());
+        assert(a[symbol].GetW() == b[symbol].GetW());
+        assert(a[symbol].GetU() == b[symbol].GetU());
+    }
+}
+
+/// Test: records read in place and loaded into compositions are identical to
+/// the written compositions
+static void test_RoundTrip()
+{
+    std::vector<CompositionSteel> comps = makeCompositions();
+    FileContents file = writeFile(comps, CompositionFile::AllContents);
+
+    CompositionFileView view(file.Data(), file.Size);
+    assert(view.GetVersion() == CompositionFile::Version);
+    assert(view.NumberOfElements() == 6);
+    assert(view.NumberOfRecords() == comps.size());
+    assert(view.HasUserFractions() && view.HasFractions());
+    assert(strcmp(view.GetElement(0).Symbol, "Fe") == 0 && view.GetElement(0).IsMajor);
+    assert(strcmp(view.GetElement(1).Symbol, "C") == 0 && view.GetElement(1).IsInterstitial);
+
+    for (size_t i = 0; i < comps.size(); i++) {
+        assert(view.IsCompositionLocked(i) == comps[i].IsCompositionLocked());
+        assert(view.GetMolarMassAvg(i) > 0.0);
+        assert(view.X(i)[1] == comps[i].C.GetX());
+        assert(view.W(i)[3] == comps[i].Mn.GetW());
+        assert(view.UserW(i)[5] == 2e-2);
+
+        CompositionSteel comp;
+        view.Load(i, comp);
+        assertSameFractions(comp, comps[i]);
+    }
+    printf("PASS: test_RoundTrip\n");
+}
+
+/// Test: a locked composition loaded from a checkpoint resumes with
+/// identical results to the original
+static void test_ResumeCheckpoint()
+{
+    std::vector<CompositionSteel> comps = makeCompositions();
+    FileContents file = writeFile(comps, CompositionFile::AllContents);
+    CompositionFileView view(file.Data(), file.Size);
+
+    CompositionSteel comp;
+    view.Load(4, comp);
+    assert(comp.IsCompositionLocked());
+    assert(comp.Si.TrySetX(1e-2) == CompositionStatus::LockedElement);
+
+    for (double xC : { 1e-3, 5e-3, 2e-2 }) {
+        comps[4].C.SetX(xC);
+        comps[4].UpdateFractions();
+        comp.C.SetX(xC);
+        comp.UpdateFractions();
+        assertSameFractions(comp, comps[4]);
+    }
+
+    comps[4].UnlockComposition();
+    comp.UnlockComposition();
+    comps[4].Mn.SetW(3e-2);
+    comps[4].UpdateFractions();
+    comp.Mn.SetW(3e-2);
+    comp.UpdateFractions();
+    assertSameFractions(comp, comps[4]);
+    printf("PASS: test_ResumeCheckpoint\n");
+}
+
+/// Test: files with only the user defined or only the calculated fractions
+/// are smaller and give the same compositions
+static void test_PartialContents()
+{
+    std::vector<CompositionSteel> comps = makeCompositions();
+    FileContents all = writeFile(comps, CompositionFile::AllContents);
+    FileContents inputs = writeFile(std::vector<CompositionSteel>(comps.begin(), comps.begin() + 3), CompositionFile::UserFractions);
+    FileContents fractions = writeFile(comps, CompositionFile::Fractions);
+    assert(inputs.Size < all.Size && fractions.Size < all.Size);
+
+    CompositionFileView inputsView(inputs.Data(), inputs.Size);
+    CompositionFileView fractionsView(fractions.Data(), fractions.Size);
+    assert(inputsView.HasUserFractions() && !inputsView.HasFractions());
+    assert(inputsView.X(0) == nullptr && fractionsView.UserX(0) == nullptr);
+
+    for (size_t i = 0; i < comps.size(); i++) {
+        CompositionSteel comp;
+        fractionsView.Load(i, comp);
+        assertSameFractions(comp, comps[i]);
+        if (i >= inputsView.NumberOfRecords())
+            continue;
+
+        // The user defined fractions are enough to resume unlocked compositions
+        inputsView.Load(i, comp);
+        assertSameFractions(comp, comps[i]);
+        comp.C.SetX(1e-2);
+        comp.UpdateFractions();
+        comps[i].C.SetX(1e-2);
+        comps[i].UpdateFractions();
+        assertSameFractions(comp, comps[i]);
+    }
+
+    // Without user defined fractions, the calculated ones are restored
+    CompositionSteel comp;
+    fractionsView.Load(3, comp);
+    assertSameFractions(comp, comps[3]);
+    comp.C.SetX(1e-2);
+    comp.UpdateFractions();
+    assert(comp.IsCompositionLocked() && comp.C.GetX() == 1e-2);
+    assert(comp.Si.GetU() == comps[3].Si.GetU());
+    printf("PASS: test_PartialContents\n");
+}
+
+/// Test: invalid contents and compositions with different elements throw
+static void test_InvalidFiles()
+{
+    std::vector<CompositionSteel> comps = makeCompositions();
+    FileContents file = writeFile(comps, CompositionFile::AllContents);
+
+    auto throws = [](const FileContents& f, size_t size) {
+        try {
+            CompositionFileView view(f.Data(), size);
+        } catch (const std::runtime_error&) {
+            return true;
+        }
+        return false;
+    };
+
+    assert(!throws(file, file.Size));
+    assert(throws(file, file.Size - 8)); // truncated
+    assert(throws(file, 16));
+
+    FileContents badMagic = file;
+    reinterpret_cast<char*>(badMagic.Buffer.data())[0] = 'X';
+    assert(throws(badMagic, badMagic.Size));
+
+    FileContents badVersion = file;
+    reinterpret_cast<CompositionFile::Header*>(badVersion.Buffer.data())->Version = CompositionFile::Version + 1;
+    assert(throws(badVersion, badVersion.Size));
+
+    FileContents zeroVersion = file;
+    reinterpret_cast<CompositionFile::Header*>(zeroVersion.Buffer.data())->Version = 0;
+    assert(throws(zeroVersion, zeroVersion.Size));
+
+    FileContents badByteOrder = file;
+    reinterpret_cast<CompositionFile::Header*>(badByteOrder.Buffer.data())->ByteOrder = 0x04030201;
+    assert(throws(badByteOrder, badByteOrder.Size));
+
+    CompositionFileView view(file.Data(), file.Size);
+    CompositionBinary binary;
+    bool thrown = false;
+    try {
+        view.Load(0, binary);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // Same symbols with other flags or molar masses
+    auto loadThrows = [](const FileContents& f) {
+        CompositionFileView view(f.Data(), f.Size);
+        CompositionSteel comp;
+        try {
+            view.Load(0, comp);
+        } catch (const std::runtime_error&) {
+            return true;
+        }
+        return false;
+    };
+    auto elements = [](FileContents& f) {
+        return reinterpret_cast<CompositionFile::Element*>(reinterpret_cast<char*>(f.Buffer.data()) + sizeof(CompositionFile::Header));
+    };
+    assert(!loadThrows(file));
+    FileContents badFlags = file;
+    elements(badFlags)[1].IsVariable = 0;
+    assert(loadThrows(badFlags));
+    FileContents badMolarMass = file;
+    elements(badMolarMass)[3].MolarMass += 1.0;
+    assert(loadThrows(badMolarMass));
+
+    FILE* stream = tmpfile();
+    CompositionWriter writer(stream, comps[0]);
+    thrown = false;
+    try {
+        writer.Write(binary);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // Locked compositions without the calculated fractions
+    CompositionWriter inputsWriter(stream, comps[0], CompositionFile::UserFractions);
+    thrown = false;
+    try {
+        inputsWriter.Write(comps[4]);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown && inputsWriter.NumberOfRecords() == 0);
+    fclose(stream);
+    printf("PASS: test_InvalidFiles\n");
+}
+
+int main()
+{
+    test_RoundTrip();
+    test_ResumeCheckpoint();
+    test_PartialContents();
+    test_InvalidFiles();
+
+    printf("All tests passed.\n");
+    return 0;
+}
@@ -0,0 +1,160 @@
+/// Test suite for the instrumentation counters using plain assert()
+///
+/// The counts are only checked when the library is built with
+/// -DCOMPOSITION_INSTRUMENTATION=ON. Otherwise, all metrics must be zero.
+
+#include "composition_batch.hpp"
+#include "composition_instrumentation.hpp"
+#include "test_compositions.hpp"
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+
+using namespace CompositionInstrumentation;
+
+/// Steel whose only variable element is interstitial
+#define FOR_CARBON_STEEL_ELEMENTS(DO) \
+    DO(Fe, false, false, true)        \
+    DO(C, true, true)                 \
+    DO(Mn)
+
+MAKE_COMPOSITION_CLASS(CompositionCarbonSteel, FOR_CARBON_STEEL_ELEMENTS)
+
+/// Expected count of an event: n if the instrumentation is enabled, 0 otherwise
+static unsigned long long expected(unsigned long long n)
+{
+    return IsEnabled() ? n : 0;
+}
+
+/// Test: the conversion paths taken are counted
+static void test_Events()
+{
+    Reset();
+    CompositionSteel steel;
+    CompositionCarbonSteel carbonSteel;
+    CompositionSteel copy = steel;
+    (void)copy;
+
+    steel.UpdateFractions();
+    steel.C.SetW(3e-3);
+    steel.UpdateFractions();
+    steel.Mn.SetX(1e-2);
+    steel.LockComposition();
+    steel.C.SetX(1e-2);
+    steel.UpdateFractions();
+    steel.UnlockComposition();
+
+    carbonSteel.LockComposition();
+    carbonSteel.C.SetX(1e-2);
+    carbonSteel.UpdateFractions();
+
+    CompositionBatch batch(steel, 10);
+    batch.UpdateFractions();
+    batch.UpdateFractions(2, 5);
+
+    Metrics metrics = GetMetrics();
+    assert(metrics.Events[size_t(Event::LayoutBinding)] == expected(2));
+    // UpdateFractions twice, LockComposition of both compositions
+    assert(metrics.Events[size_t(Event::UpdateUnlocked)] == expected(4));
+    assert(metrics.Events[size_t(Event::UpdateLocked)] == expected(2));
+    assert(metrics.Events[size_t(Event::LockComposition)] == expected(2));
+    assert(metrics.Events[size_t(Event::UnlockComposition)] == expected(1));
+    assert(metrics.Events[size_t(Event::BatchUpdate)] == expected(2));
+    assert(metrics.Events[size_t(Event::BatchRows)] == expected(13));
+    for (size_t i = 0; i < TimerCount; i++) {
+        assert(metrics.TimerCalls[i] == 0);
+    }
+
+    Reset();
+    metrics = GetMetrics();
+    for (size_t i = 0; i < EventCount; i++) {
+        assert(metrics.Events[i] == 0);
+    }
+    printf("PASS: test_Events\n");
+}
+
+/// Test: the counters of all threads are summed, including exited ones
+static void test_Threads()
+{
+    Reset();
+    auto update = []() {
+        CompositionSteel comp;
+        comp.C.SetW(3e-3);
+        for (size_t i = 0; i < 100; i++) {
+            comp.UpdateFractions();
+        }
+    };
+    std::thread t1(update), t2(update);
+    t1.join();
+    t2.join();
+    update();
+
+    Metrics metrics = GetMetrics();
+    assert(metrics.Events[size_t(Event::UpdateUnlocked)] == expected(300));
+    printf("PASS: test_Threads\n");
+}
+
+/// Test: the timers are only updated when enabled
+static void test_Timers()
+{
+    Reset();
+    SetTimersEnabled(true);
+    CompositionSteel comp;
+    comp.C.SetW(3e-3);
+    comp.UpdateFractions();
+    comp.LockComposition();
+    SetTimersEnabled(false);
+    comp.UpdateFractions();
+
+    Metrics metrics = GetMetrics();
+    assert(metrics.TimerCalls[size_t(Timer::UpdateFractions)] == expected(1));
+    assert(metrics.TimerCalls[size_t(Timer::LockComposition)] == expected(1));
+    assert(metrics.TimerCalls[size_t(Timer::BatchUpdateFractions)] == 0);
+    printf("PASS: test_Timers\n");
+}
+
+/// Test: the metrics are exported as JSON and CSV
+static void test_Export()
+{
+    Metrics metrics;
+    metrics.Events[size_t(Event::UpdateLocked)] = 42;
+    metrics.TimerCalls[size_t(Timer::UpdateFractions)] = 3;
+    metrics.TimerNanoseconds[size_t(Timer::UpdateFractions)] = 120;
+
+    char buffer[2048] = {};
+    FILE* stream = tmpfile();
+    assert(stream != nullptr);
+    assert(WriteJson(stream, metrics));
+    rewind(stream);
+    fread(buffer, 1, sizeof(buffer) - 1, stream);
+    std::string json(buffer);
+    assert(json.find("\"UpdateLocked\": 42,") != std::string::npos);
+    assert(json.find("\"UpdateFractions\": { \"calls\": 3, \"nanoseconds\": 120 }") != std::string::npos);
+    fclose(stream);
+
+    memset(buffer, 0, sizeof(buffer));
+    stream = tmpfile();
+    assert(stream != nullptr);
+    assert(WriteCsv(stream, metrics));
+    rewind(stream);
+    fread(buffer, 1, sizeof(buffer) - 1, stream);
+    std::string csv(buffer);
+    assert(csv.find("type,name,count,nanoseconds\n") == 0);
+    assert(csv.find("event,UpdateLocked,42,\n") != std::string::npos);
+    assert(csv.find("timer,UpdateFractions,3,120\n") != std::string::npos);
+    fclose(stream);
+    printf("PASS: test_Export\n");
+}
+
+int main()
+{
+    test_Events();
+    test_Threads();
+    test_Timers();
+    test_Export();
+
+    printf("All tests passed.\n");
+    return 0;
+}
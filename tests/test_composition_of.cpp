@@ -0,0 +1,131 @@
+/// Test suite for CompositionOf using plain assert()
+
+#include "composition_of.hpp"
+#include "test_compositions.hpp"
+#include <cassert>
+#include <cstdio>
+#include <type_traits>
+
+using namespace ElementSpecs;
+
+/// Same steel as CompositionSteel, defined by the template
+typedef CompositionOf<Major<PeriodicTable::Fe>,
+    Interstitial<PeriodicTable::C, Variable>,
+    Interstitial<PeriodicTable::N>,
+    Substitutional<PeriodicTable::Mn, Variable>,
+    Substitutional<PeriodicTable::Si>,
+    Substitutional<PeriodicTable::Cr>>
+    CompositionSteelOf;
+
+/// Checks that two compositions have identical fractions
+static void assertEqual(const Composition& a, const Composition& b)
+{
+    assert(a.GetNumberOfElements() == b.GetNumberOfElements());
+    auto itB = b.GetElements().begin();
+    for (const ElementData& el : a.GetElements()) {
+        assert(el.GetSymbol() == itB->GetSymbol());
+        assert(el.GetX() == itB->GetX());
+        assert(el.GetW() == itB->GetW());
+        assert(el.GetU() == itB->GetU());
+        ++itB;
+    }
+}
+
+/// Test: the partition is computed at compile time, both for the template
+/// and for the macro classes
+static void test_StaticPartition()
+{
+    typedef StaticPartition<CompositionSteelOf> P;
+    static_assert(P::NumberOfElements == 6, "");
+    static_assert(P::Major == 0, "");
+    static_assert(P::Alloying.size() == 5, "");
+    static_assert(P::VariableInterstitial.size() == 1 && P::VariableInterstitial[0] == 1, "");
+    static_assert(P::FixedInterstitial.size() == 1 && P::FixedInterstitial[0] == 2, "");
+    static_assert(P::VariableSubstitutional.size() == 1 && P::VariableSubstitutional[0] == 3, "");
+    static_assert(P::FixedSubstitutional.size() == 2 && P::FixedSubstitutional[1] == 5, "");
+    static_assert(P::Fixed.size() == 3 && P::Fixed[0] == 2, "");
+
+    typedef StaticPartition<CompositionSteel> Q;
+    assert(Q::Alloying == P::Alloying);
+    assert(Q::Variable == P::Variable);
+    assert(Q::Fixed == P::Fixed);
+
+    CompositionSteelOf comp;
+    assert(comp.GetNumberOfElements() == 6);
+    assert(comp.GetMajorElementSymbol() == "Fe");
+    printf("PASS: test_StaticPartition\n");
+}
+
+/// Test: elements are accessed at compile time and by their symbols
+static void test_ElementAccess()
+{
+    static_assert(std::is_trivially_copyable<CompositionSteelOf>::value, "CompositionOf must be trivially copyable");
+    static_assert(CompositionSteelOf::IndexOf<PeriodicTable::Mn>() == 3, "");
+    static_assert(CompositionSteelOf::IndexOf<PeriodicTable::Ni>() == CompositionSteelOf::NumberOfElements, "");
+
+    CompositionSteelOf comp;
+    comp.Get<PeriodicTable::C>().SetW(2e-3);
+    assert(&comp["C"] == &comp.Get<PeriodicTable::C>());
+    assert(comp.Get<PeriodicTable::C>().IsInterstitial());
+    assert(comp.Get<PeriodicTable::Mn>().IsVariable());
+    assert(!comp.Get<PeriodicTable::Si>().IsVariable());
+    assert(comp.FindElement("Ni") == nullptr);
+
+    CompositionSteelOf copy = comp;
+    copy.UpdateFractions();
+    assert(copy.Get<PeriodicTable::C>().GetW() == 2e-3);
+    assert(&copy["C"] == &copy.Get<PeriodicTable::C>());
+    printf("PASS: test_ElementAccess\n");
+}
+
+/// Test: the unrolled path gives identical results to the macro class and
+/// to the runtime layout path, both unlocked and locked
+static void test_IdenticalResults()
+{
+    CompositionSteel comp;
+    CompositionSteelOf compOf;
+    CompositionSteel compRuntime;
+    Composition& runtime = compRuntime;
+
+    for (CompositionBase* c : { static_cast<CompositionBase*>(&comp), static_cast<CompositionBase*>(&compOf), static_cast<CompositionBase*>(&compRuntime) }) {
+        (*c)["C"].SetW(3e-3);
+        (*c)["N"].SetX(1e-4);
+        (*c)["Mn"].SetW(1.5e-2);
+        (*c)["Si"].SetX(4e-3);
+        (*c)["Cr"].SetW(1e-2);
+    }
+    comp.UpdateFractions();
+    compOf.UpdateFractions();
+    runtime.UpdateFractions();
+    assertEqual(comp, compOf);
+    assertEqual(comp, compRuntime);
+
+    comp.LockComposition();
+    compOf.LockComposition();
+    runtime.LockComposition();
+    for (double xC : { 1e-2, 2e-2, 5e-3 }) {
+        comp.C.SetX(xC);
+        compOf.Get<PeriodicTable::C>().SetX(xC);
+        compRuntime.C.SetX(xC);
+        comp.Mn.SetX(xC);
+        compOf.Get<PeriodicTable::Mn>().SetX(xC);
+        compRuntime.Mn.SetX(xC);
+
+        comp.UpdateFractions();
+        compOf.UpdateFractions();
+        runtime.UpdateFractions();
+        assertEqual(comp, compOf);
+        assertEqual(comp, compRuntime);
+    }
+    printf("PASS: test_IdenticalResults\n");
+}
+
+int main()
+{
+    test_StaticPartition();
+    test_ElementAccess();
+    test_IdenticalResults();
+
+    printf("All tests passed.\n");
+    return 0;
+}
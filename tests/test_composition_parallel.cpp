@@ -0,0 +1,250 @@
+/// Test suite for ConvertParallel and WorkStealingThreadPool using plain assert()
+
+#include "composition_parallel.hpp"
+#include "dynamic_composition.hpp"
+#include "test_compositions.hpp"
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+/// Number of compositions used in the tests
+static const size_t N_COMPS = 1001;
+
+/// Thread counts tested
+static const size_t N_THREADS[] = { 1, 2, 4 };
+
+/// Executor running the tasks in reverse order, as a user defined executor
+class ReverseExecutor : public Executor {
+public:
+    size_t NumberOfRuns = 0; ///< Number of calls to Run
+
+    void Run(size_t count, const std::function<void(size_t)>& task) override
+    {
+        NumberOfRuns++;
+        for (size_t i = count; i > 0; i--) {
+            task(i - 1);
+        }
+    }
+};
+
+/// Makes compositions with different fractions
+static std::vector<CompositionSteel> makeCompositions()
+{
+    std::vector<CompositionSteel> comps(N_COMPS);
+    for (size_t i = 0; i < N_COMPS; i++) {
+        comps[i].C.SetW(1e-3 * (1 + i % 7));
+        comps[i].N.SetX(1e-4 * (1 + i % 3));
+        comps[i].Mn.SetW(1e-2 * (1 + i % 5) / 5.0);
+        comps[i].Si.SetX(1e-3 * (i % 4));
+        comps[i].Cr.SetW(1e-2 * (i % 6));
+    }
+    return comps;
+}
+
+/// Checks that two compositions have identical fractions
+static void assertEqual(const Composition& a, const Composition& b)
+{
+    auto elementsB = b.GetElements();
+    auto itB = elementsB.begin();
+    for (const ElementData& el : a.GetElements()) {
+        assert(el.GetX() == itB->GetX());
+        assert(el.GetW() == itB->GetW());
+        assert(el.GetU() == itB->GetU());
+        ++itB;
+    }
+}
+
+/// Test: the pool runs every task exactly once, including nested runs
+static void test_ThreadPool()
+{
+    for (size_t nThreads : N_THREADS) {
+        WorkStealingThreadPool pool(nThreads);
+        assert(pool.GetNumberOfThreads() == nThreads);
+
+        for (size_t count : { 0, 1, 3, 1000 }) {
+            std::vector<std::atomic<int>> calls(count);
+            pool.Run(count, [&](size_t i) {
+                // Uneven workload, so that the threads steal tasks
+                volatile double sum = 0;
+                for (size_t k = 0; k < (i % 10 == 0 ? 10000 : 10); k++)
+                    sum = sum + k;
+                calls[i]++;
+            });
+            for (size_t i = 0; i < count; i++) {
+                assert(calls[i] == 1);
+            }
+        }
+
+        std::atomic<size_t> nestedCalls { 0 };
+        pool.Run(8, [&](size_t) {
+            pool.Run(8, [&](size_t) { nestedCalls++; });
+        });
+        assert(nestedCalls == 64);
+
+        bool hasThrown = false;
+        try {
+            pool.Run(16, [](size_t i) {
+                if (i == 5)
+                    throw std::runtime_error("Task failed");
+            });
+        } catch (const std::runtime_error&) {
+            hasThrown = true;
+        }
+        assert(hasThrown);
+    }
+    printf("PASS: test_ThreadPool\n");
+}
+
+/// Test: identical results to the sequential path (unlocked and locked)
+static void test_RangeIdentical()
+{
+    std::vector<CompositionSteel> sequential = makeCompositions();
+    for (CompositionSteel& comp : sequential) {
+        comp.UpdateFractions();
+    }
+
+    std::vector<CompositionSteel> sequentialLocked = sequential;
+    for (size_t i = 0; i < N_COMPS; i++) {
+        sequentialLocked[i].LockComposition();
+        sequentialLocked[i].C.SetX(1e-2 * (1 + i % 4));
+        sequentialLocked[i].Mn.SetX(1e-2 * (1 + i % 3));
+    }
+    std::vector<CompositionSteel> parallelLocked = sequentialLocked;
+    for (CompositionSteel& comp : sequentialLocked) {
+        comp.UpdateFractions();
+    }
+
+    for (size_t nThreads : N_THREADS) {
+        WorkStealingThreadPool pool(nThreads);
+        ParallelOptions options;
+        options.pExecutor = &pool;
+        options.GrainSize = 10;
+
+        std::vector<CompositionSteel> parallel = makeCompositions();
+        ConvertParallel(parallel, options);
+        for (size_t i = 0; i < N_COMPS; i++) {
+            assertEqual(parallel[i], sequential[i]);
+        }
+
+        std::vector<CompositionSteel> locked = parallelLocked;
+        ConvertParallel(locked, options);
+        for (size_t i = 0; i < N_COMPS; i++) {
+            assert(locked[i].IsCompositionLocked());
+            assertEqual(locked[i], sequentialLocked[i]);
+        }
+    }
+
+    ReverseExecutor executor;
+    ParallelOptions options;
+    options.pExecutor = &executor;
+    std::vector<CompositionSteel> parallel = makeCompositions();
+    ConvertParallel(parallel, options);
+    assert(executor.NumberOfRuns == 1);
+    for (size_t i = 0; i < N_COMPS; i++) {
+        assertEqual(parallel[i], sequential[i]);
+    }
+
+    // Any composition class with UpdateFractions
+    std::vector<DynamicComposition> dyns(N_COMPS, DynamicComposition({ { "Fe", false, false, true }, { "C", true, true } }));
+    for (size_t i = 0; i < N_COMPS; i++) {
+        dyns[i].SetW(1, 1e-3 * (1 + i % 7));
+    }
+    ConvertParallel(dyns);
+    for (size_t i = 0; i < N_COMPS; i++) {
+        assert(dyns[i].GetX(1) > 0);
+    }
+    printf("PASS: test_RangeIdentical\n");
+}
+
+/// Test: identical results to CompositionBatch::UpdateFractions (unlocked and locked)
+static void test_BatchIdentical()
+{
+    std::vector<CompositionSteel> comps = makeCompositions();
+    CompositionSteel prototype;
+    CompositionBatch sequential(prototype, N_COMPS);
+    for (size_t r = 0; r < N_COMPS; r++) {
+        sequential.Load(r, comps[r]);
+    }
+
+    for (size_t nThreads : N_THREADS) {
+        WorkStealingThreadPool pool(nThreads);
+        ParallelOptions options;
+        options.pExecutor = &pool;
+        options.GrainSize = 13; // Rounded up to a multiple of the vector width
+
+        CompositionBatch parallel = sequential;
+        CompositionBatch expected = sequential;
+        expected.UpdateFractions();
+        ConvertParallel(parallel, options);
+        for (size_t e = 0; e < parallel.NumberOfElements(); e++) {
+            for (size_t r = 0; r < N_COMPS; r++) {
+                assert(parallel.GetX(e, r) == expected.GetX(e, r));
+                assert(parallel.GetW(e, r) == expected.GetW(e, r));
+                assert(parallel.GetU(e, r) == expected.GetU(e, r));
+            }
+        }
+
+        parallel.LockComposition();
+        expected.LockComposition();
+        size_t iC = parallel.GetElementIndex("C");
+        for (size_t r = 0; r < N_COMPS; r++) {
+            parallel.SetX(iC, r, 1e-2 * (1 + r % 4));
+            expected.SetX(iC, r, 1e-2 * (1 + r % 4));
+        }
+        expected.UpdateFractions();
+        ConvertParallel(parallel, options);
+        for (size_t e = 0; e < parallel.NumberOfElements(); e++) {
+            for (size_t r = 0; r < N_COMPS; r++) {
+                assert(parallel.GetX(e, r) == expected.GetX(e, r));
+                assert(parallel.GetW(e, r) == expected.GetW(e, r));
+                assert(parallel.GetU(e, r) == expected.GetU(e, r));
+            }
+        }
+    }
+    printf("PASS: test_BatchIdentical\n");
+}
+
+/// Test: identical results to ScalarCompositionBatch<float>::UpdateFractions
+/// with every instruction set, whose blocks are rounded up to their widths
+static void test_FloatBatchIdentical()
+{
+    std::vector<CompositionSteel> comps = makeCompositions();
+    CompositionSteel prototype;
+    ScalarCompositionBatch<float> sequential(prototype, N_COMPS);
+    for (size_t r = 0; r < N_COMPS; r++) {
+        sequential.Load(r, comps[r]);
+    }
+
+    WorkStealingThreadPool pool(4);
+    ParallelOptions options;
+    options.pExecutor = &pool;
+    options.GrainSize = 13;
+    for (InstructionSet instructionSet : { InstructionSet::Scalar, InstructionSet::SSE2, InstructionSet::AVX2, InstructionSet::AVX512 }) {
+        ScalarCompositionBatch<float> parallel = sequential;
+        parallel.SetInstructionSet(instructionSet);
+        ScalarCompositionBatch<float> expected = parallel;
+        expected.UpdateFractions();
+        ConvertParallel(parallel, options);
+        for (size_t e = 0; e < parallel.NumberOfElements(); e++) {
+            for (size_t r = 0; r < N_COMPS; r++) {
+                assert(parallel.GetX(e, r) == expected.GetX(e, r));
+                assert(parallel.GetW(e, r) == expected.GetW(e, r));
+                assert(parallel.GetU(e, r) == expected.GetU(e, r));
+            }
+        }
+    }
+    printf("PASS: test_FloatBatchIdentical\n");
+}
+
+int main()
+{
+    test_ThreadPool();
+    test_RangeIdentical();
+    test_BatchIdentical();
+    test_FloatBatchIdentical();
+
+    printf("All tests passed.\n");
+    return 0;
+}
@@ -0,0 +1,206 @@
+/// Test suite for ScalarCompositionBatch using plain assert()
+
+#include "composition_batch.hpp"
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <type_traits>
+#include <vector>
+
+/// Alloy steel with eight elements, enough for the rounding errors of float
+/// to grow with the number of elements
+#define FOR_ALLOY_STEEL_ELEMENTS(DO) \
+    DO(Fe, false, false, true)       \
+    DO(C, true, true)                \
+    DO(N, false, true)               \
+    DO(Mn, true)                     \
+    DO(Si)                           \
+    DO(Cr)                           \
+    DO(Ni)                           \
+    DO(Mo)
+
+MAKE_COMPOSITION_CLASS(CompositionAlloySteel, FOR_ALLOY_STEEL_ELEMENTS)
+
+/// Number of rows used in the tests (not a multiple of the vector widths)
+static const size_t N_ROWS = 1037;
+
+/// Instruction sets tested
+static const InstructionSet INSTRUCTION_SETS[] = { InstructionSet::Scalar, InstructionSet::SSE2, InstructionSet::AVX2, InstructionSet::AVX512 };
+
+/// Fraction of element e in row r, between 0 and 0.05
+static double fraction(size_t e, size_t r)
+{
+    return 0.05 * std::fmod(0.618034 * (r + 1) * (e + 3), 1.0);
+}
+
+/// Sets the fractions of all rows: mole fractions of the odd elements and
+/// mass fractions of the even ones
+template <typename Batch, typename Scalar>
+static void setRows(Batch& batch)
+{
+    for (size_t e = 1; e < batch.NumberOfElements(); e++) {
+        std::vector<Scalar> values(batch.Size());
+        for (size_t r = 0; r < batch.Size(); r++) {
+            // Same float inputs for all scalar types
+            values[r] = static_cast<float>(fraction(e, r));
+        }
+        CompositionStatus status = e % 2 ? batch.TrySetX(e, values.data()) : batch.TrySetW(e, values.data());
+        assert(status == CompositionStatus::Ok);
+    }
+}
+
+/// Sets the fractions of the variable elements of all rows of a locked batch
+template <typename Batch, typename Scalar>
+static void setVariableRows(Batch& batch)
+{
+    for (const char* symbol : { "C", "Mn" }) {
+        size_t e = batch.GetElementIndex(symbol);
+        std::vector<Scalar> values(batch.Size());
+        for (size_t r = 0; r < batch.Size(); r++) {
+            values[r] = static_cast<float>(fraction(e + 7, r));
+        }
+        assert(batch.TrySetX(e, values.data()) == CompositionStatus::Ok);
+    }
+}
+
+/// Test: CompositionBatch is the double batch, and the rows of a float batch
+/// are stored into compositions converted to double
+static void test_Store()
+{
+    static_assert(std::is_same<CompositionBatch, ScalarCompositionBatch<double>>::value,
+        "CompositionBatch must be ScalarCompositionBatch<double>");
+
+    CompositionAlloySteel prototype;
+    ScalarCompositionBatch<float> batch(prototype, N_ROWS);
+    setRows<ScalarCompositionBatch<float>, float>(batch);
+    batch.UpdateFractions();
+
+    for (size_t r = 0; r < N_ROWS; r += 101) {
+        CompositionAlloySteel comp;
+        batch.Store(r, comp);
+        size_t e = 0;
+        for (const ElementData& el : comp.GetElements()) {
+            assert(el.GetX() == static_cast<double>(batch.GetX(e, r)));
+            assert(el.GetW() == static_cast<double>(batch.GetW(e, r)));
+            assert(el.GetU() == static_cast<double>(batch.GetU(e, r)));
+            e++;
+        }
+    }
+    printf("PASS: test_Store\n");
+}
+
+/// Test: the vectorized float kernels give identical results to the scalar
+/// float path
+static void test_FloatInstructionSetsIdentical()
+{
+    CompositionAlloySteel prototype;
+    ScalarCompositionBatch<float> reference(prototype, N_ROWS);
+    reference.SetInstructionSet(InstructionSet::Scalar);
+    setRows<ScalarCompositionBatch<float>, float>(reference);
+    reference.UpdateFractions();
+    reference.LockComposition();
+    setVariableRows<ScalarCompositionBatch<float>, float>(reference);
+    reference.UpdateFractions();
+
+    for (InstructionSet instructionSet : INSTRUCTION_SETS) {
+        ScalarCompositionBatch<float> batch(prototype, N_ROWS);
+        batch.SetInstructionSet(instructionSet);
+        assert(batch.GetInstructionSet() != InstructionSet::AVX512 || batch.GetVectorWidth() == 16);
+        setRows<ScalarCompositionBatch<float>, float>(batch);
+        batch.UpdateFractions();
+        batch.LockComposition();
+        setVariableRows<ScalarCompositionBatch<float>, float>(batch);
+        batch.UpdateFractions();
+
+        for (size_t r = 0; r < N_ROWS; r++) {
+            assert(batch.GetMolarMassAvg(r) == reference.GetMolarMassAvg(r));
+            for (size_t e = 0; e < batch.NumberOfElements(); e++) {
+                assert(batch.GetX(e, r) == reference.GetX(e, r));
+                assert(batch.GetW(e, r) == reference.GetW(e, r));
+                assert(batch.GetU(e, r) == reference.GetU(e, r));
+            }
+        }
+    }
+    printf("PASS: test_FloatInstructionSetsIdentical\n");
+}
+
+/// Test: the errors of float are within the documented bound (n + 4) u,
+/// taking long double as reference, unlocked and locked
+static void test_FloatErrorBound()
+{
+    CompositionAlloySteel prototype;
+    ScalarCompositionBatch<float> batch(prototype, N_ROWS);
+    ScalarCompositionBatch<long double> reference(prototype, N_ROWS);
+    assert(reference.GetInstructionSet() == InstructionSet::Scalar);
+    assert(reference.GetVectorWidth() == 1);
+
+    size_t n = batch.NumberOfElements();
+    long double bound = (n + 4) * std::ldexp(1.0L, -24);
+    auto relativeError = [](float value, long double exact) {
+        return exact == 0 ? std::fabs(static_cast<long double>(value)) : std::fabs((value - exact) / exact);
+    };
+
+    setRows<ScalarCompositionBatch<float>, float>(batch);
+    setRows<ScalarCompositionBatch<long double>, long double>(reference);
+    for (int locked = 0; locked < 2; locked++) {
+        if (locked) {
+            batch.LockComposition();
+            reference.LockComposition();
+            setVariableRows<ScalarCompositionBatch<float>, float>(batch);
+            setVariableRows<ScalarCompositionBatch<long double>, long double>(reference);
+        }
+        batch.UpdateFractions();
+        reference.UpdateFractions();
+
+        for (size_t r = 0; r < N_ROWS; r++) {
+            assert(reference.GetX(0, r) >= 0.5);
+            assert(relativeError(batch.GetMolarMassAvg(r), reference.GetMolarMassAvg(r)) < bound);
+            for (size_t e = 0; e < n; e++) {
+                assert(relativeError(batch.GetX(e, r), reference.GetX(e, r)) < bound);
+                assert(relativeError(batch.GetW(e, r), reference.GetW(e, r)) < bound);
+                assert(relativeError(batch.GetU(e, r), reference.GetU(e, r)) < bound);
+            }
+        }
+    }
+    printf("PASS: test_FloatErrorBound\n");
+}
+
+/// Test: loaded compositions and setter errors
+static void test_LoadAndSetters()
+{
+    CompositionAlloySteel comp;
+    comp.C.SetW(3e-3);
+    comp.Mn.SetW(1.5e-2);
+    comp.Cr.SetX(1e-2);
+    comp.UpdateFractions();
+
+    ScalarCompositionBatch<long double> batch(comp, 1);
+    batch.Load(0, comp);
+    assert(batch.GetX(batch.GetElementIndex("Cr"), 0) == static_cast<long double>(comp.Cr.GetX()));
+    batch.UpdateFractions();
+    for (size_t e = 0; e < batch.NumberOfElements(); e++) {
+        double x = comp[batch.GetSymbol(e)].GetX();
+        assert(std::fabs(batch.GetX(e, 0) - x) <= 4e-16 * x);
+    }
+
+    size_t iSi = batch.GetElementIndex("Si");
+    assert(batch.TrySetX(0, 0, 0.1L) == CompositionStatus::MajorElement);
+    batch.LockComposition();
+    assert(batch.IsCompositionLocked());
+    assert(batch.TrySetX(iSi, 0, 0.1L) == CompositionStatus::LockedElement);
+    assert(batch.TrySetW(batch.GetElementIndex("C"), 0, 0.1L) == CompositionStatus::LockedMassFraction);
+    batch.UnlockComposition();
+    assert(batch.TrySetX(iSi, 0, 0.1L) == CompositionStatus::Ok);
+    printf("PASS: test_LoadAndSetters\n");
+}
+
+int main()
+{
+    test_Store();
+    test_FloatInstructionSetsIdentical();
+    test_FloatErrorBound();
+    test_LoadAndSetters();
+
+    printf("All tests passed.\n");
+    return 0;
+}
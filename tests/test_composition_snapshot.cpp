@@ -0,0 +1,139 @@
+/// Test suite for CompositionSnapshot and CompositionPublisher using plain assert()
+
+#include "composition_snapshot.hpp"
+#include "test_compositions.hpp"
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// Number of publications in the concurrent test
+static const size_t N_PUBLICATIONS = 2000;
+
+/// Mole fraction of C of the composition published with a sequence number
+static double xCOfSequence(unsigned long long sequence)
+{
+    return 1e-3 * (1 + sequence % 50);
+}
+
+/// Test: a snapshot has the fractions of the composition and does not change
+/// with it
+static void test_Snapshot()
+{
+    CompositionSteel comp;
+    comp.C.SetW(3e-3);
+    comp.N.SetX(1e-4);
+    comp.Mn.SetW(1.5e-2);
+    comp.UpdateFractions();
+
+    CompositionSnapshot snapshot(comp);
+    assert(snapshot.GetNumberOfElements() == comp.GetNumberOfElements());
+    assert(snapshot.GetMajorElementIndex() == 0);
+    assert(snapshot.GetElementIndex("mn") == 3);
+    assert(snapshot.FindElementIndex("Ni") == snapshot.GetNumberOfElements());
+    assert(!snapshot.IsCompositionLocked());
+    assert(snapshot.GetSequence() == 0);
+
+    size_t i = 0;
+    for (const ElementData& el : comp.GetElements()) {
+        assert(el.GetSymbol() == snapshot.GetSymbol(i));
+        assert(el.GetX() == snapshot.GetX(i));
+        assert(el.GetW() == snapshot.GetW(i));
+        assert(el.GetU() == snapshot.GetU(i));
+        i++;
+    }
+
+    double xC = snapshot.GetX(1);
+    comp.C.SetX(2e-2);
+    comp.UpdateFractions();
+    assert(snapshot.GetX(1) == xC);
+
+    // The snapshot has the fractions stored in the composition, as the getters
+    comp.Mn.SetX(1e-2);
+    CompositionSnapshot updated(comp);
+    assert(updated.GetX(3) == comp.Mn.GetX());
+    assert(updated.GetW(1) == comp.C.GetW());
+
+    bool hasThrown = false;
+    try {
+        snapshot.GetElementIndex("Ni");
+    } catch (const std::runtime_error&) {
+        hasThrown = true;
+    }
+    assert(hasThrown);
+    printf("PASS: test_Snapshot\n");
+}
+
+/// Test: readers always load consistent snapshots while the writer keeps
+/// updating and publishing the composition
+static void test_ConcurrentReaders()
+{
+    CompositionSteel comp;
+    comp.C.SetW(3e-3);
+    comp.Mn.SetW(1.5e-2);
+    comp.Si.SetW(2e-3);
+    comp.LockComposition();
+
+    CompositionPublisher publisher;
+    assert(publisher.Load() == nullptr);
+    comp.C.SetX(xCOfSequence(1));
+    comp.UpdateFractions();
+    publisher.Publish(comp);
+
+    std::atomic<bool> isDone { false };
+    std::atomic<size_t> numberOfReads { 0 };
+    auto read = [&]() {
+        unsigned long long lastSequence = 0;
+        while (!isDone.load()) {
+            std::shared_ptr<const CompositionSnapshot> pSnapshot = publisher.Load();
+            unsigned long long sequence = pSnapshot->GetSequence();
+            assert(sequence >= lastSequence);
+            assert(pSnapshot->GetX(1) == xCOfSequence(sequence));
+
+            // Site fractions of the substitutional elements and mass fractions sum to one
+            double uSum = 0.0, wSum = 0.0;
+            for (size_t i = 0; i < pSnapshot->GetNumberOfElements(); i++) {
+                if (i != 1 && i != 2)
+                    uSum += pSnapshot->GetU(i);
+                wSum += pSnapshot->GetW(i);
+            }
+            assert(std::fabs(uSum - 1.0) < 1e-12);
+            assert(std::fabs(wSum - 1.0) < 1e-12);
+            lastSequence = sequence;
+            numberOfReads++;
+        }
+    };
+
+    std::vector<std::thread> readers;
+    for (size_t t = 0; t < 3; t++) {
+        readers.emplace_back(read);
+    }
+
+    for (unsigned long long s = 2; s <= N_PUBLICATIONS; s++) {
+        comp.C.SetX(xCOfSequence(s));
+        comp.UpdateFractions();
+        assert(publisher.Publish(comp)->GetSequence() == s);
+    }
+    isDone = true;
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+
+    assert(publisher.Load()->GetSequence() == N_PUBLICATIONS);
+    assert(publisher.Load()->GetX(1) == comp.C.GetX());
+    assert(publisher.Load()->IsCompositionLocked());
+    printf("PASS: test_ConcurrentReaders (%zu reads)\n", numberOfReads.load());
+}
+
+int main()
+{
+    test_Snapshot();
+    test_ConcurrentReaders();
+
+    printf("All tests passed.\n");
+    return 0;
+}
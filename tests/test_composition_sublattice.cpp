@@ -0,0 +1,223 @@
+/// Test suite for CompositionSublattices using plain assert()
+
+#include "composition_field.hpp"
+#include "composition_sublattice.hpp"
+#include "test_compositions.hpp"
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+/// Number of rows and cells used in the tests
+static const size_t N_ROWS = 1000;
+
+/// Sets the fractions of composition i
+static void setComposition(CompositionSteel& comp, size_t i)
+{
+    comp.C.SetW(1e-3 * (1 + i % 9));
+    comp.N.SetX(1e-4 * (1 + i % 5));
+    comp.Mn.SetW(1e-2 * (1 + i % 7));
+    comp.Si.SetX(2e-3 * (i % 3));
+    comp.Cr.SetW(1e-2 * (i % 11));
+    comp.UpdateFractions();
+}
+
+/// Test: the two sublattice model with one site each gives the site
+/// fractions of the compositions, and other site ratios scale the
+/// interstitial site fractions
+static void test_TwoSublattices()
+{
+    CompositionSteel prototype;
+    CompositionSublattices model = CompositionSublattices::TwoSublattices(prototype);
+    assert(model.NumberOfSublattices() == 2);
+    assert(model.GetReferenceSublattice() == 0);
+    assert(!model.HasVacancies(0) && model.HasVacancies(1));
+
+    // M_1(C,N,Va)_3 (e.g., ferrite)
+    CompositionSublattices ferrite = CompositionSublattices::TwoSublattices(prototype, 1.0, 3.0);
+    assert(ferrite.GetSites(1) == 3.0);
+
+    std::vector<double> y(6), va(2), yFerrite(6), vaFerrite(2);
+    for (size_t i = 0; i < 50; i++) {
+        CompositionSteel comp;
+        setComposition(comp, i);
+        model.GetSiteFractions(comp, y.data(), va.data());
+        ferrite.GetSiteFractions(comp, yFerrite.data(), vaFerrite.data());
+
+        size_t e = 0;
+        double sumInterstitial = 0.0;
+        for (const ElementData& el : comp.GetElements()) {
+            assert(y[e] == el.GetU());
+            if (el.IsInterstitial()) {
+                assert(std::fabs(yFerrite[e] - el.GetU() / 3.0) <= 1e-15 * el.GetU());
+                sumInterstitial += el.GetU();
+            } else {
+                assert(yFerrite[e] == el.GetU());
+            }
+            e++;
+        }
+        assert(va[0] == 0.0);
+        assert(std::fabs(va[1] - (1.0 - sumInterstitial)) <= 1e-15);
+        assert(std::fabs(vaFerrite[1] - (1.0 - sumInterstitial / 3.0)) <= 1e-15);
+    }
+    printf("PASS: test_TwoSublattices\n");
+}
+
+/// Test: a model whose reference sublattice does not have all the
+/// substitutional elements, against the site fractions computed from the
+/// mole fractions, and the batch against the compositions
+static void test_Sublattices()
+{
+    // (Fe,Mn,Cr)_3(Si,C)_1(N,Va)_2
+    CompositionSteel prototype;
+    CompositionSublattices model(prototype,
+        { { 3.0, { "Fe", "Mn", "Cr" } }, { 1.0, { "Si", "C" } }, { 2.0, { "N", "Va" } } });
+    assert(model.NumberOfSublattices() == 3);
+    assert(model.GetSublattice(4) == 1); // Si
+
+    std::vector<CompositionSteel> comps(N_ROWS);
+    CompositionBatch batch(prototype, N_ROWS);
+    for (size_t i = 0; i < N_ROWS; i++) {
+        setComposition(comps[i], i);
+        batch.Load(i, comps[i]);
+    }
+
+    std::vector<double> yBatch(6 * N_ROWS, -1.0), vaBatch(3 * N_ROWS, -1.0);
+    model.GetSiteFractions(batch, 10, N_ROWS, yBatch.data(), vaBatch.data());
+    assert(yBatch[9] == -1.0 && vaBatch[9] == -1.0);
+
+    std::vector<double> y(6), va(3);
+    for (size_t i = 10; i < N_ROWS; i++) {
+        const CompositionSteel& comp = comps[i];
+        model.GetSiteFractions(comp, y.data(), va.data());
+
+        double xReference = comp.Fe.GetX() + comp.Mn.GetX() + comp.Cr.GetX();
+        const double sites[] = { 3.0, 1.0, 2.0, 3.0, 1.0, 3.0 }; // Fe, C, N, Mn, Si, Cr
+        double sums[3] = { 0.0, 0.0, 0.0 };
+        size_t e = 0;
+        for (const ElementData& el : comp.GetElements()) {
+            double expected = el.GetX() * 3.0 / (sites[e] * xReference);
+            assert(std::fabs(y[e] - expected) <= 1e-14 * expected);
+            assert(yBatch[e * N_ROWS + i] == y[e]);
+            sums[model.GetSublattice(e)] += y[e];
+            e++;
+        }
+        assert(std::fabs(sums[0] - 1.0) <= 1e-15);
+        for (size_t s = 0; s < 3; s++) {
+            assert(vaBatch[s * N_ROWS + i] == va[s]);
+        }
+        assert(va[0] == 0.0 && va[1] == 0.0);
+        assert(std::fabs(va[2] - (1.0 - sums[2])) <= 1e-15);
+    }
+    printf("PASS: test_Sublattices\n");
+}
+
+/// Test: the U outputs of a field with a sublattice model, and its vacancy
+/// outputs
+static void test_Field()
+{
+    CompositionSteel prototype;
+    setComposition(prototype, 3);
+    prototype.LockComposition();
+    CompositionSublattices model(prototype, { { 1.0, { "Fe", "Mn", "Si", "Cr" } }, { 3.0, { "C", "N", "Va" } } });
+
+    std::vector<double> xC(N_ROWS), yC(N_ROWS), yMn(N_ROWS), va(2 * N_ROWS);
+    for (size_t i = 0; i < N_ROWS; i++) {
+        xC[i] = 1e-3 * (1 + i % 13);
+    }
+    CompositionField field(prototype, 64);
+    size_t iC = field.GetElementIndex("C"), iMn = field.GetElementIndex("Mn");
+    assert(field.SetVacancyOutput(1, va.data()) == CompositionStatus::InvalidArgument);
+    assert(field.SetSublattices(&model) == CompositionStatus::Ok);
+    assert(field.SetInput(iC, FieldFraction::X, xC.data()) == CompositionStatus::Ok);
+    field.SetOutput(iC, FieldFraction::U, yC.data());
+    field.SetOutput(iMn, FieldFraction::U, yMn.data());
+    assert(field.SetVacancyOutput(1, va.data() + 1, 2) == CompositionStatus::Ok);
+    assert(field.SetVacancyOutput(2, va.data()) == CompositionStatus::InvalidArgument);
+    field.Convert(0, N_ROWS);
+
+    std::vector<double> y(6), vacancies(2);
+    for (size_t i = 0; i < N_ROWS; i++) {
+        CompositionSteel comp = prototype;
+        comp.C.SetX(xC[i]);
+        comp.UpdateFractions();
+        model.GetSiteFractions(comp, y.data(), vacancies.data());
+        assert(yC[i] == y[iC]);
+        assert(yMn[i] == y[iMn]);
+        assert(va[2 * i + 1] == vacancies[1]);
+    }
+
+    // Without the model, the site fractions of the compositions
+    CompositionFeC feC;
+    CompositionSublattices other = CompositionSublattices::TwoSublattices(feC);
+    assert(field.SetSublattices(&other) == CompositionStatus::InvalidArgument);
+    assert(field.SetSublattices(nullptr) == CompositionStatus::Ok);
+    field.Convert(0, N_ROWS);
+    for (size_t i = 0; i < N_ROWS; i++) {
+        CompositionSteel comp = prototype;
+        comp.C.SetX(xC[i]);
+        comp.UpdateFractions();
+        assert(yC[i] == comp.C.GetU());
+    }
+    printf("PASS: test_Field\n");
+}
+
+/// Test: invalid models and compositions with other elements
+static void test_Errors()
+{
+    CompositionSteel prototype;
+    const std::vector<std::vector<CompositionSublattices::Sublattice>> invalid = {
+        {},
+        { { 0.0, { "Fe", "Mn", "Si", "Cr", "C", "N" } } },
+        { { 1.0, { "Fe", "Mn", "Si", "Cr" } }, { 1.0, {} }, { 1.0, { "C", "N" } } },
+        { { 1.0, { "Fe", "Mn", "Si", "Cr" } }, { 1.0, { "C", "N", "Nb" } } },
+        { { 1.0, { "Fe", "Mn", "Si", "Cr" } }, { 1.0, { "C", "N", "Va", "Va" } } },
+        { { 1.0, { "Fe", "Mn", "Si", "Cr", "C" } }, { 1.0, { "C", "N" } } },
+        { { 1.0, { "Fe", "Mn", "Si", "Cr" } }, { 1.0, { "C" } } },
+        { { 1.0, { "Fe", "Mn", "Si", "Cr", "Va" } }, { 1.0, { "C", "N" } } },
+    };
+    for (const std::vector<CompositionSublattices::Sublattice>& sublattices : invalid) {
+        bool thrown = false;
+        try {
+            CompositionSublattices model(prototype, sublattices);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+
+    CompositionSublattices model = CompositionSublattices::TwoSublattices(prototype);
+    CompositionFeC feC;
+    feC.UpdateFractions();
+    std::vector<double> y(6);
+    bool thrown = false;
+    try {
+        model.GetSiteFractions(feC, y.data());
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    CompositionBatch batch(feC, 4);
+    assert(!model.HasSameElements(batch));
+    thrown = false;
+    try {
+        model.GetSiteFractions(batch, 0, 4, y.data());
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    printf("PASS: test_Errors\n");
+}
+
+int main()
+{
+    test_TwoSublattices();
+    test_Sublattices();
+    test_Field();
+    test_Errors();
+
+    printf("All tests passed.\n");
+    return 0;
+}
@@ -0,0 +1,27 @@
+/// @file test_compositions.hpp
+/// Composition classes shared by the test suites
+
+#ifndef TEST_COMPOSITIONS_H
+#define TEST_COMPOSITIONS_H
+
+#include "composition.hpp"
+
+/// Steel with variable and fixed, interstitial and substitutional elements
+#define FOR_STEEL_ELEMENTS(DO) \
+    DO(Fe, false, false, true) \
+    DO(C, true, true)          \
+    DO(N, false, true)         \
+    DO(Mn, true)               \
+    DO(Si)                     \
+    DO(Cr)
+
+MAKE_COMPOSITION_CLASS(CompositionSteel, FOR_STEEL_ELEMENTS)
+
+/// Binary Fe-C, with other elements than CompositionSteel
+#define FOR_FE_C_ELEMENTS(DO)  \
+    DO(Fe, false, false, true) \
+    DO(C, true, true)
+
+MAKE_COMPOSITION_CLASS(CompositionFeC, FOR_FE_C_ELEMENTS)
+
+#endif
@@ -0,0 +1,139 @@
+/// Test suite for DynamicComposition using plain assert()
+
+#include "dynamic_composition.hpp"
+#include "test_compositions.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+/// Same elements as FOR_STEEL_ELEMENTS
+static const std::vector<ElementDefinition> STEEL_ELEMENTS = {
+    { "Fe", false, false, true },
+    { "C", true, true },
+    { "N", false, true },
+    { "Mn", true },
+    { "Si" },
+    { "Cr" },
+};
+
+/// Checks that a DynamicComposition has identical fractions to a Composition
+static void assertEqual(const Composition& comp, const DynamicComposition& dyn)
+{
+    assert(comp.GetNumberOfElements() == dyn.GetNumberOfElements());
+    size_t i = 0;
+    for (const ElementData& el : comp.GetElements()) {
+        assert(el.GetSymbol() == dyn.GetSymbol(i));
+        assert(el.GetX() == dyn.GetX(i));
+        assert(el.GetW() == dyn.GetW(i));
+        assert(el.GetU() == dyn.GetU(i));
+        i++;
+    }
+}
+
+/// Returns true if constructing a DynamicComposition with the elements throws
+static bool throws(const std::vector<ElementDefinition>& elements)
+{
+    try {
+        DynamicComposition comp(elements);
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+/// Test: elements are defined at runtime and partitioned as in Composition
+static void test_Definitions()
+{
+    DynamicComposition dyn(STEEL_ELEMENTS);
+
+    assert(dyn.GetNumberOfElements() == 6);
+    assert(std::string(dyn.GetMajorElementSymbol()) == "Fe");
+    assert(dyn.GetElementIndex("mn") == 3);
+    assert(dyn.FindElementIndex("Ni") == dyn.GetNumberOfElements());
+    assert(dyn.GetMolarMass(1) == PeriodicTable::C.MolarMass);
+    assert(dyn.IsInterstitial(2) && !dyn.IsVariable(2));
+
+    const ElementPartition& p = dyn.GetPartition();
+    typedef StaticPartition<CompositionSteel> P;
+    assert(p.Major == P::Major);
+    assert(std::equal(p.Alloying.begin(), p.Alloying.end(), P::Alloying.begin(), P::Alloying.end()));
+    assert(std::equal(p.Variable.begin(), p.Variable.end(), P::Variable.begin(), P::Variable.end()));
+    assert(std::equal(p.Fixed.begin(), p.Fixed.end(), P::Fixed.begin(), P::Fixed.end()));
+
+    assert(throws({ { "Fe" }, { "C", true, true } }));
+    assert(throws({ { "Fe", false, false, true }, { "Ni", false, false, true } }));
+    assert(throws({ { "Fe", false, false, true }, { "Xx" } }));
+    assert(throws({ { "Fe", false, false, true }, { "C" }, { "c" } }));
+    printf("PASS: test_Definitions\n");
+}
+
+/// Test: identical results to a Composition (unlocked and locked)
+static void test_IdenticalResults()
+{
+    CompositionSteel comp;
+    DynamicComposition dyn(STEEL_ELEMENTS);
+
+    comp.C.SetW(3e-3);
+    comp.N.SetX(1e-4);
+    comp.Mn.SetW(1.5e-2);
+    comp.Si.SetX(4e-3);
+    comp.Cr.SetW(1e-2);
+    dyn.SetW(1, 3e-3);
+    dyn.SetX(2, 1e-4);
+    dyn.SetW(3, 1.5e-2);
+    dyn.SetX(4, 4e-3);
+    dyn.SetW(5, 1e-2);
+
+    comp.UpdateFractions();
+    dyn.UpdateFractions();
+    assertEqual(comp, dyn);
+
+    comp.LockComposition();
+    dyn.LockComposition();
+    assert(dyn.IsCompositionLocked());
+    for (double xC : { 1e-2, 2e-2, 5e-3 }) {
+        comp.C.SetX(xC);
+        comp.Mn.SetX(xC);
+        dyn.SetX(1, xC);
+        dyn.SetX(3, xC);
+        comp.UpdateFractions();
+        dyn.UpdateFractions();
+        assertEqual(comp, dyn);
+    }
+    printf("PASS: test_IdenticalResults\n");
+}
+
+/// Test: fixed elements cannot be changed when the composition is locked
+static void test_LockedFixedElement()
+{
+    DynamicComposition dyn(STEEL_ELEMENTS);
+    size_t iSi = dyn.GetElementIndex("Si");
+    dyn.SetX(iSi, 1e-3);
+    dyn.LockComposition();
+    dyn.SetX(iSi, 2e-3);
+    dyn.SetX(dyn.GetMajorElementIndex(), 0.5);
+    dyn.UpdateFractions();
+    dyn.UnlockComposition();
+    dyn.UpdateFractions();
+
+    assert(dyn.GetX(iSi) == 1e-3);
+
+    dyn.LockComposition();
+    assert(dyn.TrySetX(iSi, 2e-3) == CompositionStatus::LockedElement);
+    assert(dyn.TrySetW(1, 1e-3) == CompositionStatus::LockedMassFraction);
+    assert(dyn.TrySetX(dyn.GetMajorElementIndex(), 0.5) == CompositionStatus::MajorElement);
+    assert(dyn.TrySetX(1, 1e-3) == CompositionStatus::Ok);
+    printf("PASS: test_LockedFixedElement\n");
+}
+
+int main()
+{
+    test_Definitions();
+    test_IdenticalResults();
+    test_LockedFixedElement();
+
+    printf("All tests passed.\n");
+    return 0;
+}